@@ -36,6 +36,8 @@
 	#include <iostream>
 	#include <unistd.h>
 	#include <pthread.h>
+	#include <sched.h>
+	#include <sys/resource.h>
 	#include <stdlib.h>
 	#include "tekThreads.h"
 	#include <assert.h>
@@ -90,6 +92,10 @@
 // 	tekThreadsLinux.cpp static variables
 //
 //
+	// Scheduling setup by thread role, all SCHED_OTHER until configured
+	static threadSchedSpec roleSched[THREAD_ROLE_MAX];
+	// Set after the first refusal so the fallback is reported once
+	static volatile int schedRefusedReported = 0;
 
 //																			  *
 //*****************************************************************************
@@ -119,6 +125,8 @@ CThread::CThread()
 	m_context = NULL;
 	m_hThread = pthread_t(NULL);
 	m_running = false;
+	m_role = THREAD_ROLE_NONE;
+	m_priority = 0;
 }
 
 CThread::~CThread( )
@@ -173,6 +181,8 @@ void *CThread::ThreadEntry( void * arg )
 	// Setup random number generator
 	srand(1);				// reset random # gen
 	srand(t->m_seed);		// set the seed
+	// Real-time setup for our role
+	t->applySched();
 #if TRACE_THREAD0
 	_RPT1(RPT_OUT, "CThread::ThreadEntry, id=%d\n",
 			t->UIthreadID());
@@ -213,34 +223,21 @@ HANDLE CThread::LaunchThread( void *context, int priority )
 	// available.
 	int theErr;
 	m_context = context;
+	m_priority = priority;
 	m_exitSection.Lock();
 #if TRACE_THREAD0
 	_RPT0(RPT_OUT, "CThread::LaunchThread\n");
 #endif
 
     pthread_attr_t threadAttr;
-    struct sched_param  param;             // for setting priority
-    int32_t policy;
 
-    assert((theErr = pthread_getschedparam( pthread_self(), &policy, &param))==EOK);
  	assert((theErr = pthread_attr_init(&threadAttr))==EOK);
  	// Assign lighter weight stack
  	const int STACK_SIZE = 250000;
  	assert((theErr = pthread_attr_setstacksize(&threadAttr, STACK_SIZE))==EOK);
-#if 0
-    // TODO: Work out priority adjuster
-	assert((theErr = pthread_attr_setschedpolicy (&threadAttr, SCHED_RR))==EOK);
-    if (priority!=0) {
-    	_RPT1(RPT_OUT, "CThread::LaunchThread, prio adj=%d\n", priority);
-    	// TODO: changing this leads to dead-lock in netStateInfo construction
-		//theErr = pthread_attr_setinheritsched (&threadAttr, PTHREAD_EXPLICIT_SCHED);
-		assert((theErr = pthread_attr_setinheritsched (&threadAttr, PTHREAD_INHERIT_SCHED))==EOK);
-		// Adjust thread base priority
-		param.sched_priority += priority;
-		assert((theErr = pthread_attr_setschedparam (&threadAttr, &param))==EOK);
-		//theErr = pthread_attr_setschedpolicy (&threadAttr, SCHED_OTHER);
-    }
-#endif
+	// The scheduling is inherited here and adjusted by the new thread in
+	// applySched. Setting it via the attributes fails the create outright
+	// when we lack the privilege.
     theErr= pthread_create(&m_hThread, &threadAttr,
                                 ThreadEntry, this);
  //   theErr= pthread_create(&m_hThread, NULL,
@@ -260,6 +257,110 @@ HANDLE CThread::LaunchThread( void *context, int priority )
 //*****************************************************************************
 
 
+//*****************************************************************************
+//	NAME																	  *
+//		CThread::SetRoleSched
+//
+//	DESCRIPTION:
+/**
+	Set the scheduling setup for threads of \e role. It is applied as each
+	thread of the role starts, so it should be set before the ports open.
+
+ 	\param[in] role Thread role index [0..THREAD_ROLE_MAX-1].
+ 	\param[in] spec Policy, real-time priority and CPU mask to use.
+	\return TRUE if the role and policy are valid.
+
+**/
+//	SYNOPSIS:
+nodebool CThread::SetRoleSched(int role, const threadSchedSpec &spec)
+{
+	if (role < 0 || role >= THREAD_ROLE_MAX) {
+		return(FALSE);
+	}
+	switch (spec.policy) {
+		case SCHED_OTHER:
+			break;
+		case SCHED_FIFO:
+		case SCHED_RR:
+			if (spec.priority < sched_get_priority_min(spec.policy)
+			 || spec.priority > sched_get_priority_max(spec.policy)) {
+				return(FALSE);
+			}
+			break;
+		default:
+			return(FALSE);
+	}
+	roleSched[role] = spec;
+	return(TRUE);
+}
+//																			  *
+//*****************************************************************************
+
+
+
+//*****************************************************************************
+//	NAME																	  *
+//		CThread::applySched
+//
+//	DESCRIPTION:
+/**
+	Apply our role's scheduling setup to the calling thread. A real-time
+	policy uses the role's priority plus the LaunchThread adjustment,
+	otherwise the adjustment raises the thread's nice level when allowed.
+	Without the needed privilege the thread stays at its inherited
+	scheduling, a refused real-time setup is reported once.
+
+**/
+//	SYNOPSIS:
+void CThread::applySched()
+{
+	threadSchedSpec spec = {SCHED_OTHER, 0, 0};
+	int theErr = EOK;
+
+	if (m_role >= 0 && m_role < THREAD_ROLE_MAX) {
+		spec = roleSched[m_role];
+	}
+	if (spec.policy == SCHED_FIFO || spec.policy == SCHED_RR) {
+		struct sched_param param;
+		int prioMin = sched_get_priority_min(spec.policy);
+		int prioMax = sched_get_priority_max(spec.policy);
+
+		param.sched_priority = spec.priority + m_priority;
+		if (param.sched_priority < prioMin)
+			param.sched_priority = prioMin;
+		if (param.sched_priority > prioMax)
+			param.sched_priority = prioMax;
+		theErr = pthread_setschedparam(pthread_self(), spec.policy, &param);
+	}
+	else if (m_role != THREAD_ROLE_NONE && m_priority != 0) {
+		// Best effort boost within SCHED_OTHER, unprivileged processes
+		// cannot lower nice values so a refusal is expected.
+		setpriority(PRIO_PROCESS, id_t(syscall(SYS_gettid)), -m_priority);
+	}
+	if (theErr != EOK && !__sync_lock_test_and_set(&schedRefusedReported, 1)) {
+		_RPT2(_CRT_WARN, "CThread::applySched role %d not applied, err=%d; "
+			  "continuing with inherited scheduling\n", m_role, theErr);
+	}
+
+	if (spec.cpuMask != 0) {
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		for (unsigned cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; cpu++) {
+			if (spec.cpuMask & (1ULL << cpu))
+				CPU_SET(cpu, &cpus);
+		}
+		theErr = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+		if (theErr != EOK) {
+			_RPT2(_CRT_WARN, "CThread::applySched role %d affinity err=%d\n",
+				  m_role, theErr);
+		}
+	}
+}
+//																			  *
+//*****************************************************************************
+
+
+
 //*****************************************************************************
 //	NAME																	  *
 //		CThread::Sleep
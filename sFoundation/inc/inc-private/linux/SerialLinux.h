@@ -282,9 +282,9 @@ public:
 	bool WaitForCommEvent(unsigned int timeOutMS) {
 		return m_commEvent.WaitFor(timeOutMS);
 	}
-	void ForceCommEvent() {
-		m_commEvent.SetEvent();
-	}
+	// Post a communications event and release the CommEventWaitInitiate
+	// waiter.
+	void ForceCommEvent();
 
 	// Determine what caused the event to trigger
 	EEvent GetEventType (void);
@@ -311,6 +311,9 @@ public:
 					   DWORD* pdwRead = 0,
 					   DWORD dwTimeout = INFINITE);
 
+	// Release a thread blocked in Read, which returns API_ERROR_TIMEOUT.
+	void WakeReader (void);
+
 	// Check if com-port is opened
 	bool IsOpen (void) const		{ return (m_hFile != INVALID_HANDLE); }
 
@@ -347,6 +350,9 @@ protected:
 	int		m_hFile;			// File handle
 	EEvent	m_eEvent;			// Event type
 	DWORD	m_dwEventMask;		// Event mask
+	int		m_epollFd;			// Read readiness set (port + m_wakeFd)
+	int		m_wakeFd;			// eventfd to release a blocked Read
+	int		m_commEvtFd;		// eventfd posted by ForceCommEvent
 	unsigned char readBuf [256];
 
 protected:
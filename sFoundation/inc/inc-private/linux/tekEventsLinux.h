@@ -33,6 +33,10 @@
 	#include <stdio.h>
 	#include <string>
     #include <sys/time.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+	#include <limits.h>
+	#include <linux/futex.h>
 
 	#include <assert.h>
 	#include "tekTypes.h"
@@ -72,19 +76,20 @@ typedef void * HANDLE;
 
           \param[in] incrMilliseconds time increment
           \param[out] abs_time resulting time from now
+          \param[in] clockID clock the waiter measures \a abs_time on
  **/
 //   SYNOPSIS:
-inline void CCaddAbsTime(timespec &abs_time, double incrMilliseconds)
+inline void CCaddAbsTime(timespec &abs_time, double incrMilliseconds,
+						 clockid_t clockID = CLOCK_REALTIME)
 {
-	// Try better clock, if not fallback on common
-	//if(clock_gettime( CLOCK_MONOTONIC, &abs_time )) {
-		assert(clock_gettime( CLOCK_REALTIME, &abs_time ) == 0);
-	//}
+	int theErr = clock_gettime( clockID, &abs_time );
+	assert(theErr == 0);
+	(void)theErr;
 	nodeulong secs = CAST_NODEULONG(incrMilliseconds/1000);
 	abs_time.tv_sec += secs;
 	// Prevent overflow on longer time-outs
 	abs_time.tv_nsec += (incrMilliseconds-secs*1000) * 1000000L;
-	if ( abs_time.tv_nsec > 1000000000L) {
+	if ( abs_time.tv_nsec >= 1000000000L) {
 		abs_time.tv_nsec -= 1000000000L;
 		abs_time.tv_sec += 1;
 	}
@@ -189,8 +194,14 @@ public:
 			m_set( bInitiallyOwn ) {
 		int theErr = pthread_mutex_init(&mutex, NULL);
 		assert(theErr == EOK);
-		theErr = pthread_cond_init(&cond, NULL);
+		// Time-outs run on the monotonic clock so wall clock steps
+		// do not stretch or cut short a wait
+		pthread_condattr_t attr;
+		pthread_condattr_init(&attr);
+		pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+		theErr = pthread_cond_init(&cond, &attr);
 		assert(theErr == EOK);
+		pthread_condattr_destroy(&attr);
  	}
 	~CCEvent() {
 		int theErr = pthread_mutex_destroy(&mutex);
@@ -246,7 +257,7 @@ public:
 			else {
 				// Create our time-out
 				struct timespec abs_time;
-				CCaddAbsTime(abs_time, timeoutMsec);
+				CCaddAbsTime(abs_time, timeoutMsec, CLOCK_MONOTONIC);
 				do {
 					r = pthread_cond_timedwait( &cond, &mutex, &abs_time );
 				} while (r!=EOK && r!=ETIMEDOUT && !m_set);
@@ -428,6 +439,161 @@ public:
 
 
 
+//*****************************************************************************
+//	NAME																	  *
+//		class CCOneShot
+//
+//	DESCRIPTION:
+/**
+	Futex based one-shot completion for an object that is reused.
+
+	Each use is started with Arm, which returns a tag for that use. Fire
+	completes the current use and wakes its waiters. A waiter holding an
+	older tag is never blocked, since the object moved on only after that
+	use completed. Fire only enters the kernel when a thread is waiting.
+**/
+//	SYNOPSIS:
+class CCOneShot
+{
+private:
+	// Generation in the upper bits, fired flag in bit 0. Unsigned so the
+	// generation wraps instead of overflowing.
+	volatile Uint32 m_word;
+	volatile int m_waiters;
+public:
+	CCOneShot() : m_word(0), m_waiters(0) {
+	}
+
+	// Start a new use, returning its tag
+	Uint32 Arm() {
+		Uint32 tag = (m_word | 1) + 1;
+		m_word = tag;
+		__sync_synchronize();
+		return tag;
+	}
+
+	// Complete the current use and release its waiters
+	void Fire() {
+		__sync_fetch_and_or(&m_word, 1U);
+		if (m_waiters) {
+			syscall(SYS_futex, &m_word, FUTEX_WAKE_PRIVATE, INT_MAX,
+					NULL, NULL, 0);
+		}
+	}
+
+	// Returns TRUE if the use for <tag> has not completed
+	bool Pending(Uint32 tag) {
+		return m_word == tag;
+	}
+
+	// Wait for the use for <tag> to complete. Returns TRUE if it did.
+	bool WaitFor(Uint32 tag, unsigned timeoutMsec=SYNC_INFINITE) {
+		struct timespec now, end, left;
+		if (m_word != tag) {
+			return true;
+		}
+		if (timeoutMsec != SYNC_INFINITE) {
+			clock_gettime(CLOCK_MONOTONIC, &end);
+			end.tv_sec += timeoutMsec / 1000;
+			end.tv_nsec += (timeoutMsec % 1000) * 1000000L;
+			if (end.tv_nsec >= 1000000000L) {
+				end.tv_nsec -= 1000000000L;
+				end.tv_sec += 1;
+			}
+		}
+		__sync_add_and_fetch(&m_waiters, 1);
+		while (m_word == tag) {
+			struct timespec *pLeft = NULL;
+			if (timeoutMsec != SYNC_INFINITE) {
+				clock_gettime(CLOCK_MONOTONIC, &now);
+				left.tv_sec = end.tv_sec - now.tv_sec;
+				left.tv_nsec = end.tv_nsec - now.tv_nsec;
+				if (left.tv_nsec < 0) {
+					left.tv_nsec += 1000000000L;
+					left.tv_sec -= 1;
+				}
+				if (left.tv_sec < 0) {
+					break;
+				}
+				pLeft = &left;
+			}
+			// The kernel rechecks the word, so a Fire before we sleep
+			// is not lost.
+			syscall(SYS_futex, &m_word, FUTEX_WAIT_PRIVATE, int(tag),
+					pLeft, NULL, 0);
+		}
+		__sync_sub_and_fetch(&m_waiters, 1);
+		return m_word != tag;
+	}
+};
+//																			  *
+//*****************************************************************************
+
+
+
+//*****************************************************************************
+//	NAME																	  *
+//		Atomic operations
+//
+//	DESCRIPTION:
+/**
+	Lock free operations on shared words and counters, for the GCC builtins
+	on Linux. Each is a full barrier. The Add and Sub forms return the new
+	value, the Fetch forms the value before the operation.
+**/
+//	SYNOPSIS:
+// Order all earlier memory accesses before all later ones
+inline void CCmemoryBarrier() {
+	__sync_synchronize();
+}
+
+template<class T, class V>
+inline T CCatomicAdd(volatile T *pDest, V incr) {
+	return __sync_add_and_fetch(pDest, T(incr));
+}
+
+template<class T, class V>
+inline T CCatomicSub(volatile T *pDest, V decr) {
+	return __sync_sub_and_fetch(pDest, T(decr));
+}
+
+template<class T, class V>
+inline T CCatomicFetchAdd(volatile T *pDest, V incr) {
+	return __sync_fetch_and_add(pDest, T(incr));
+}
+
+template<class T, class V>
+inline T CCatomicFetchOr(volatile T *pDest, V bits) {
+	return __sync_fetch_and_or(pDest, T(bits));
+}
+
+// Store <newVal> if <pDest> holds <oldVal>, returning true if stored
+template<class T, class V>
+inline bool CCatomicCAS(volatile T *pDest, V oldVal, V newVal) {
+	return __sync_bool_compare_and_swap(pDest, T(oldVal), T(newVal));
+}
+
+// As CCatomicCAS, returning the value found at <pDest>
+template<class T, class V>
+inline T CCatomicCASval(volatile T *pDest, V oldVal, V newVal) {
+	return __sync_val_compare_and_swap(pDest, T(oldVal), T(newVal));
+}
+
+// Read and clear <pDest>
+template<class T>
+inline T CCatomicTake(volatile T *pDest) {
+	return __sync_fetch_and_and(pDest, T(0));
+}
+
+// Index of the lowest set bit of a non-zero <bits>
+inline unsigned CClowestBit(Uint64 bits) {
+	return unsigned(__builtin_ctzll(bits));
+}
+//																			  *
+//*****************************************************************************
+
+
+
 //*****************************************************************************
 //	NAME																	  *
 //		class CCatomicUpdate
@@ -39,15 +39,21 @@
 #include "pubMnNetDef.h"
 #include "tekThreads.h"
 #include "tekEvents.h"
-// StdLib inclusions
-#include <deque>
-
 // Maximum polling delay for break detector
 #define COMM_EVT_BRK_DLY_MS		100
 
+// Silence on the line that ends a wait for stray characters to arrive
+#define SERIAL_QUIET_MS			20
+
 // Maximum number of characters to read from port at a time
 #define READ_BUF_LEN			4096
 
+// Received packets held for the application (power of 2)
+#define RX_PKT_RING_DEPTH		256
+
+// Most packets encoded into one write by SendPkts
+#define SEND_PKTS_MAX			16
+
 // Set to 1 to record highest packet depth
 #define RECORD_PKT_DEPTH		1
 
@@ -115,6 +121,7 @@ typedef struct  _CSerialExErrReportInfo {
 		Uint32 RXCHARcnt;
 		Uint32 RXFLAGcnt;
 		Uint32 RX80FUllcnt;
+		Uint32 RXPKT_OVERFLOWcnt;		// Packets dropped, ring full
 	// Reset value to zero
 	void clear() {
 		BREAKcnt=0;
@@ -128,6 +135,7 @@ typedef struct  _CSerialExErrReportInfo {
 		RXCHARcnt=0;
 		RXFLAGcnt=0;
 		RX80FUllcnt=0;
+		RXPKT_OVERFLOWcnt=0;
 	};
 } CSerialExErrReportInfo;
 //																			   *
@@ -232,6 +240,17 @@ public:
 		return(false);
 	};
 
+	// Take all the unread characters as one span
+	size_t getSpan(const char *&pSpan) {
+		size_t nChars;
+		m_lock.Lock();
+		pSpan = &m_buffer[m_head];
+		nChars = m_size-m_head;
+		m_head = m_size;
+		m_lock.Unlock();
+		return(nChars);
+	};
+
 	void lock() {
 		m_lock.Lock();
 	}
@@ -263,6 +282,88 @@ public:
 //******************************************************************************
 
 
+//******************************************************************************
+// NAME																		   *
+// 	rxPktRing class
+//
+// DESCRIPTION
+//	Fixed depth single producer/single consumer ring of received packets.
+//	The serial read thread fills slots in place and the packet reader thread
+//	copies them out, so neither side allocates or locks. The producer owns
+//	m_head and the consumer owns m_tail. A discard from any thread moves
+//	m_discardTo and the consumer skips the abandoned slots on its next pop.
+//	Abandoned slots are free to the producer at once, so a discard makes
+//	room even while the consumer is idle.
+//
+class rxPktRing {
+private:
+	packetbuf m_slots[RX_PKT_RING_DEPTH];
+	volatile Uint32 m_head;			// Next slot to fill
+	volatile Uint32 m_tail;			// Next slot to drain
+	volatile Uint32 m_discardTo;	// Slots before this are abandoned
+
+	// Consumer view of the oldest live slot
+	Uint32 liveTail() {
+		Uint32 tail = m_tail;
+		Uint32 discardTo = m_discardTo;
+		return((int32(discardTo - tail) > 0) ? discardTo : tail);
+	}
+public:
+	rxPktRing() {
+		m_head = m_tail = m_discardTo = 0;
+	};
+
+	// Producer: return the slot to fill, NULL if the ring is full
+	packetbuf *claim() {
+		if (m_head - liveTail() >= RX_PKT_RING_DEPTH)
+			return(NULL);
+		return(&m_slots[m_head & (RX_PKT_RING_DEPTH-1)]);
+	};
+
+	// Producer: make the claimed slot visible to the consumer
+	void publish() {
+		CCmemoryBarrier();
+		m_head = m_head + 1;
+	};
+
+	// Consumer: copy out the oldest packet, false if empty
+	bool pop(packetbuf &thePacket) {
+		for (;;) {
+			Uint32 tail = liveTail();
+			if (tail == m_head) {
+				m_tail = tail;
+				return(false);
+			}
+			CCmemoryBarrier();
+			thePacket = m_slots[tail & (RX_PKT_RING_DEPTH-1)];
+			CCmemoryBarrier();
+			// A discard during the copy let the producer reuse the slot
+			if (int32(m_discardTo - tail) > 0)
+				continue;
+			m_tail = tail + 1;
+			return(true);
+		}
+	};
+
+	// Number of packets waiting
+	size_t depth() {
+		return(size_t(m_head - liveTail()));
+	};
+
+	bool empty() {
+		return(depth() == 0);
+	};
+
+	// Abandon everything currently queued
+	void discard() {
+		m_discardTo = m_head;
+		CCmemoryBarrier();
+	};
+};
+//																			   *
+//******************************************************************************
+
+
 //******************************************************************************
 // NAME																		   *
 // 	CSerialEvt class
@@ -293,6 +394,8 @@ public:
 		m_parkAck.WaitFor();
 	}
 protected:
+	// Release the blocked event wait before joining
+	HANDLE Terminate();
 	// Thread function
 	int Run(void *context);					// Thread Control function
 };
@@ -327,6 +430,15 @@ public:
 		READ_STATE_HP_PAYLOAD,
 	} ReadStates;
 
+	// Called on our thread with each converted packet, returns true if it
+	// consumed the packet so it is not queued to the application.
+	typedef bool (*PktHook)(void *context, packetbuf &thePacket);
+	// A hook and its context, published together
+	struct pktHookReg {
+		PktHook pHook;
+		void *context;
+	};
+
 // Operations
 public:
 	// Open the numerically specified port for use
@@ -342,6 +454,12 @@ public:
 
 	// Connect the user's comm event to signal when packet is detected
 	void RegisterUserPktCommEvent(CCEvent *pUsersEvent);
+	// Let <pHook> see packets before they are queued, NULL to remove
+	void RegisterPktHook(PktHook pHook, void *context);
+	// Returns true when called from our packet framing thread
+	bool IsReaderThread() {
+		return(ThreadID() == CThread::CurrentThreadID());
+	}
 
 	// Operational mode: packets vs plain old serial
 	void SetMode(CSerialMode theNewMode);
@@ -350,6 +468,7 @@ public:
 	// Packet Interface
 	bool GetPkt(packetbuf &buffer);
 	bool SendPkt(packetbuf &bufferLen);
+	bool SendPkts(packetbuf *pBuffers, size_t nPkts);
 	bool IsPacketAvailable();
 
 	// Serial Port Interface
@@ -412,12 +531,16 @@ protected:
 
 	// Internal attributes
 	CCEvent *m_pUserCommInterrupt;
+	// Packet hook and its context, swapped as one
+	pktHookReg * volatile m_pPktHookReg;
+	// Set while our thread may be using a hook registration
+	volatile Uint32 m_pktHookInUse;
 	// Signalled when there is a packet received by the host.
 	// This application layer waits on this.
 	CCEvent m_responsePacketWaiting;
 
 	// Packets to send up to application layer
-	std::deque<packetbuf *> m_finishedPackets;
+	rxPktRing m_finishedPackets;
 
 	// Overlap structures for writing
 	CCEvent  m_evtWrOverlap;
@@ -470,7 +593,6 @@ private:
 	packetbuf m_hiInProcPacket;
 
 	unsigned m_strayCount;
-	bool m_AppPacketAvailable;
 
 	ReadStates m_state;
 	ReadStates m_pushedState;
@@ -487,9 +609,25 @@ private:
 	// m_rdBuffer and signal the upper packet loop we have something.
 	bool TestAndPushHiPacket(char nextChar);
 	void ProcessNextChar(char nextChar);
+	// Frame a block of received characters
+	void ProcessChunk(const char *pChunk, size_t nChars);
+	// Complete the in-process packets
+	void FinishLowPacket();
+	void FinishHiPacket();
+	// The framer tests and benchmarks drive the parsers directly
+	friend class CSerialExTest;
 public:
 	// Reset port items and work in progress
 	void Flush();
+	// Wait until nothing is received for <quietMs>, at most <maxMs>
+	bool WaitForQuiet(Uint32 quietMs, Uint32 maxMs);
+	// Wait for characters past <seenFrom>, then for <quietMs> of quiet,
+	// at most <maxMs>
+	bool WaitForReply(Uint32 seenFrom, Uint32 quietMs, Uint32 maxMs);
+	// Count of every character read, to mark the start of a reply
+	Uint32 CharsSeen() {
+		return(m_nCharsSeen);
+	}
 
 	// - - - - - - - - - - - - - - - - - - - - - -
 	// Internal Packet based API and states
@@ -513,6 +651,8 @@ private:
 	rdBuf m_rdBuffer;
 	// Set to have the thread ignore all data
 	bool m_rdAutoFlush;
+	// Every character read, kept or flushed, for quiet line detection
+	volatile Uint32 m_nCharsSeen;
 	// Things discovered during operations
 	CSerialExErrReportInfo m_ErrorReport;
 	// We are running in packet mode, else plain old serial mode
@@ -520,6 +660,7 @@ private:
 	CSerialEvt *m_pSerialEvts;
 
 	// Thread Termination and cleanup
+	HANDLE Terminate();
 	void TerminateAndWait();
 public:
 	// Tell read thread to ignore data when mode == true.
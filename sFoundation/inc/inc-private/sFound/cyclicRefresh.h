@@ -0,0 +1,171 @@
+//*****************************************************************************
+// NAME
+//		cyclicRefresh.h
+//
+// DESCRIPTION:
+//		Background cyclic refresh of subscribed parameters. A thread per
+//		port reads every subscribed value in one batch each period and
+//		publishes it to a slot that readers copy without a lock.
+//
+// CREATION DATE:
+//		10/16/2026
+//
+// COPYRIGHT NOTICE:
+//		(C)Copyright 2026  Teknic, Inc.  All rights reserved.
+//
+//		This copyright notice must be reproduced in any copy, modification,
+//		or portion thereof merged into another program. A copy of the
+//		copyright notice must be included in the object library of a user
+//		program.
+//
+//																			  *
+//*****************************************************************************
+#ifndef __CYCLICREFRESH_H__
+#define __CYCLICREFRESH_H__
+
+
+//*****************************************************************************
+// NAME																          *
+// 	cyclicRefresh.h headers
+//
+	#include "lnkAccessCommon.h"
+	#include "netCmdAPI.h"
+	#include "tekThreads.h"
+	#include <vector>
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	cyclicRefresh.h constants
+//
+// Shortest period accepted
+#define CYCLIC_PERIOD_MIN_MS		1
+// Periods a value may age before readers go back to the node
+#define CYCLIC_STALE_PERIODS		2
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	cyclicSlot
+//
+// DESCRIPTION
+//	The latest value of one subscribed parameter. The value is published
+//	under a sequence count that is odd while it is being written. Readers
+//	copy it and retry if the count was odd or changed. Only the refresh
+//	thread writes a slot while it runs, only the port's stop when not.
+//
+//	The remaining fields belong to the engine and are changed under its
+//	lock. A slot is freed when it is neither subscribed nor in a cycle.
+//
+struct _cyclicSlot {
+	multiaddr addr;						// Node address
+	nodeparam param;					// Parameter number
+	unsigned refs;						// Subscriber and cycle in flight
+	bool listed;						// Subscribed
+	volatile Uint32 seq;				// Publish count, odd while writing
+	bool valid;							// Value present
+	Uint64 updatedNs;					// Sample time, coreTimeNs base
+	Uint64 periodNs;					// Period it was sampled at
+	paramValue value;					// Latest value
+};
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	cyclicRefresh class
+//
+// DESCRIPTION
+//	The subscriptions and statistics of a port. The refresh thread only
+//	exists while the port's refresh is started, so the subscriptions
+//	outlive stops and restarts.
+//
+class cyclicThread;
+class cyclicRefresh
+{
+	friend class cyclicThread;
+private:
+	netaddr m_cNum;							// Port we refresh
+	CCCriticalSection m_lock;				// Slot list, refs and statistics
+	std::vector<cyclicSlot *> m_slots;		// Subscribed slots
+	cyclicThread *m_pThread;				// Refresh thread or NULL
+	volatile Uint64 m_periodNs;				// Cycle period
+	mnCyclicStats m_stats;					// Statistics, PeriodMs unused
+	Uint64 m_lastSampleNs;					// Last cycle sample time
+
+	// Work areas of the refresh thread
+	std::vector<cyclicSlot *> m_work;
+	std::vector<multiaddr> m_addrs;
+	std::vector<nodeparam> m_params;
+	std::vector<paramValue> m_vals;
+	std::vector<cnErrCode> m_errs;
+
+	// Publish a value to a slot
+	static void publish(cyclicSlot *pSlot, bool valid,
+						const paramValue &val, Uint64 sampleNs,
+						Uint64 periodNs);
+	// Drop a reference, freeing an unlisted slot, must hold m_lock
+	static void release(cyclicSlot *pSlot);
+	// Read all subscribed values once and publish them
+	void cycle();
+
+public:
+	// Construction/Destruction
+	cyclicRefresh(netaddr cNum);
+	~cyclicRefresh();
+
+	// Add a slot for <param> of node <addr>
+	cyclicSlot *Subscribe(multiaddr addr, nodeparam param);
+	// Remove a slot and free it once no cycle uses it
+	void Unsubscribe(cyclicSlot *pSlot);
+	// Start the thread or change its period
+	cnErrCode Start(Uint32 periodMs);
+	// Stop the thread and invalidate the slots
+	cnErrCode Stop();
+	// Copy the statistics, optionally clearing the counts
+	void Stats(mnCyclicStats *pStats, bool reset);
+	// Copy the latest value of a slot
+	static bool Read(cyclicSlot *pSlot, paramValue *pVal, Uint64 *pUpdatedNs,
+					 Uint64 *pPeriodNs);
+};
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	cyclicThread class
+//
+// DESCRIPTION
+//	Runs the cycles of a cyclicRefresh every period until terminated.
+//
+class cyclicThread : public CThread
+{
+private:
+	cyclicRefresh &m_owner;					// Engine we run
+	CCEvent m_wake;							// Early wake for termination
+
+public:
+	// Construction/Destruction
+	cyclicThread(cyclicRefresh &owner);
+	~cyclicThread();
+
+	// CThread overrides for terminate
+	void *Terminate();
+
+protected:
+	int Run(void *context);					// Control function
+};
+//																			  *
+//*****************************************************************************
+
+#endif	// __CYCLICREFRESH_H__
+
+//=============================================================================
+//	END OF FILE cyclicRefresh.h
+//=============================================================================
@@ -31,6 +31,8 @@
 	#ifndef DOXYGEN_SHOULD_SKIP_THIS
 		// StdLib inclusions
 		#include <queue>
+		#include <time.h>
+		#include <string.h>
 		// Our inclusions
 		#include "tekTypes.h"
 		#include "tekThreads.h"
@@ -72,6 +74,10 @@ class CSerialEx;
 #define DATAACQ_OVERFLOW_LVL	2000
 // Number of simultaneous command in ring default
 #define N_CMDS_IN_RING			3
+// Most response trackers per port, one bit each in the free mask
+#define TRK_POOL_MAX			64
+// Response lists per port: one per node plus the control list
+#define RESP_LIST_CNT			(MN_API_MAX_NODES+1)
 
 // XML based error text
 #define LNK_ACCESS_XML_ERR_TXT "/MNuserDriver20.xml"
@@ -86,6 +92,38 @@ void DUMP_PKT(netaddr cNum, const char *msg, packetbuf *buf, bool backArrow=fals
 //*****************************************************************************
 
 
+//*****************************************************************************
+// NAME																          *
+// 	Core time source
+//
+// DESCRIPTION
+//	Integer nanoseconds on the monotonic clock since the library loaded. It
+//	does not step with wall clock adjustments, and the vDSO keeps it out of
+//	the kernel. infcCoreTime is the same time in milliseconds.
+//
+// Monotonic clock reading when the library loaded
+extern Uint64 CoreTimeBaseNs;
+
+inline Uint64 coreTimeNs() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return Uint64(now.tv_sec) * 1000000000ULL + Uint64(now.tv_nsec)
+		   - CoreTimeBaseNs;
+}
+
+// Convert core time or a core time interval to milliseconds
+inline double coreNsToMs(Uint64 ns) {
+	return double(ns) * 1e-6;
+}
+
+// Convert milliseconds to a core time interval
+inline Uint64 coreMsToNs(double ms) {
+	return Uint64(ms * 1e6);
+}
+//																			  *
+//*****************************************************************************
+
+
 //*****************************************************************************
 // NAME																          *
 // 	mnClassInfo structure
@@ -214,6 +252,78 @@ typedef struct _rxTraceBuf200 {
 	}
 #endif
 } rxTraceBuf200;
+
+// In-memory trace ring records. Writers claim a serial number with an
+// atomic increment and stamp the slot so readers never need a lock: <seq>
+// is 2*serial+1 while the slot is written and 2*serial+2 once complete.
+// Only the used bytes of the packet are copied in. Dumps expand these to
+// the txTraceBuf/rxTraceBuf file records.
+typedef struct _txTraceSlot {
+	volatile Uint64 seq;		// Slot sequence stamp
+	Uint64 timeNs;				// Core time command sent to NC
+	Uint32 depth;				// Queue depth
+	Uint16 failed;				// Failed send error code
+	Uint8 len;					// Used bytes in <bytes>
+	Uint8 bytes[MN_NET_PACKET_MAX];	// Command sent
+} txTraceSlot;
+
+typedef struct _rxTraceSlot {
+	volatile Uint64 seq;		// Slot sequence stamp
+	Uint64 timeNs;				// Core time response received
+	Uint32 sendCnt;				// By node count
+	Uint32 sendSer;				// Assumed sender serial number
+	cnErrCode error;			// Error code of result
+	Uint8 len;					// Used bytes in <bytes>
+	Uint8 bytes[MN_NET_PACKET_MAX];	// Response received
+} rxTraceSlot;
+
+// Receive trace marker records. These carry TRACE_MARK_SER as <sendSer>
+// and the kind of mark as <sendCnt>.
+#define TRACE_MARK_SER			0xFFFFFFFEU
+// Net state change, packet byte 0 holds the NetworkChanges state
+#define TRACE_MARK_NET_EVENT	1
+// Error callback fired, error in <error>, packet byte 0 holds the node
+#define TRACE_MARK_ERR_CALLBACK	2
+// Startup phase ended at the record time, packet holds a traceStartupMark
+#define TRACE_MARK_STARTUP		3
+
+#if defined(_MSC_VER)||defined(__GNUC__)
+#pragma pack(push, 1)
+#endif
+typedef struct _traceStartupMark {
+	Uint8 phase;				// startupPhases
+	Uint8 node;					// Node of a class setup or TRACE_MARK_PORT
+	Uint32 durationUs;			// Time in the phase
+	Uint32 commands;			// Commands sent in the phase
+} traceStartupMark;
+#if defined(_MSC_VER)||defined(__GNUC__)
+#pragma pack(pop)
+#endif
+// Node number of marks for the whole port
+#define TRACE_MARK_PORT			0xFF
+
+#ifdef __cplusplus
+// Take an untorn copy of a ring slot without locking out writers. Returns
+// false if no complete record could be read.
+template<class slotT>
+inline bool traceSlotRead(const slotT &slot, slotT &copy) {
+	for (int tries = 0; tries < 8; tries++) {
+		Uint64 before = slot.seq;
+		CCmemoryBarrier();
+		memcpy((void *)&copy, (const void *)&slot, sizeof(slotT));
+		CCmemoryBarrier();
+		if (before != 0 && !(before & 1) && slot.seq == before) {
+			return (true);
+		}
+	}
+	return (false);
+}
+
+// Serial number of the record held in a complete slot
+inline Uint32 traceSlotSerial(const volatile Uint64 &seq) {
+	return Uint32((seq - 2) / 2);
+}
+#endif
 //
 //	This structure defines the header of the trace dump file.
 //
@@ -257,6 +367,56 @@ typedef struct _traceHeader {
 //*****************************************************************************
 
 
+//*****************************************************************************
+// NAME																          *
+// 	latencyTables structure
+//
+// DESCRIPTION
+//	Command latency histograms of a port. They are updated with atomic adds
+//	by the thread completing each command and copied out without locking,
+//	so a copy taken during traffic may be off by the commands in flight.
+//
+typedef struct _latencyTables {
+	mnLatencyHist port;						// All commands
+	mnLatencyHist node[MN_API_MAX_NODES];	// By node address
+	mnLatencyHist cmd[MN_LAT_CMD_CNT];		// By command code
+	mnLatencyHist queue[CMD_CLASS_CNT];		// Ring slot waits by class
+} latencyTables;
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	paramFlight structure
+//
+// DESCRIPTION
+//	A parameter read on the wire. Threads asking for the same parameter of
+//	the same node while it is outstanding wait for it and share its result
+//	instead of sending their own read. Any other command sent to the node
+//	unlinks its reads, so a read that follows a write is never answered by
+//	one sent before it. The last reference deletes it.
+//
+typedef struct _paramFlight {
+	struct _paramFlight *next;			// Next read in flight on the port
+	multiaddr addr;						// Node read
+	nodeparam param;					// Parameter read
+	Uint32 refs;						// Reader and joined threads
+	cnErrCode result;					// Outcome once done
+	packetbuf value;					// Value read once done
+	CCEvent done;						// Set when the read completes
+	_paramFlight(multiaddr theAddr, nodeparam theParam) :
+		next(NULL),
+		addr(theAddr),
+		param(theParam),
+		refs(1),
+		result(MN_OK) {
+	}
+} paramFlight;
+//																			  *
+//*****************************************************************************
+
+
 //*****************************************************************************
 // NAME																          *
 // 	mnNetInvRecords structure
@@ -267,6 +427,8 @@ typedef struct _traceHeader {
 //	port.
 //
 class netStateInfo;			// Forward reference
+class traceStream;			// Forward reference
+class cyclicRefresh;		// Forward reference
 class mnNetInvRecords {
 public:
 	// This structure holds this network's locations and types of nodes
@@ -302,25 +464,53 @@ public:
 	nodebool TraceActive;				// Tracing enabled
 	nodebool TraceActiveReq;			// Tracing enable request
 	Uint32 TraceCount;					// Count of automatic dumps attempted this session
-	Uint32 sendSerNum;					// Sending serial number
-	Uint32 respSerNum;					// Receive serial number
-	txTraceBuf *txTraces;				// Trace buffer SEND_DEPTH deep
-	size_t txTraceIndx;
-	rxTraceBuf *rxTraces;				// Trace buffer RECV_DEPTH deep
-	size_t rxTraceIndx;
-	CCCriticalSection TXlogLock;		// Transmit log critical section
-	CCCriticalSection RXlogLock;		// Receive log critical section
+	volatile Uint32 sendSerNum;			// Sending serial number
+	volatile Uint32 respSerNum;			// Receive serial number
+	txTraceSlot *txTraces;				// Trace ring SEND_DEPTH deep
+	rxTraceSlot *rxTraces;				// Trace ring RECV_DEPTH deep
+	traceStream *pTraceStream;			// Streaming trace sink or NULL
+	latencyTables *pLatency;			// Latency histograms or NULL
+	cyclicRefresh *pCyclic;				// Cyclic parameter refresh or NULL
+	mnStartupProfile StartupProfile;	// Last startup, see startupTimer
+	Uint32 StartupCmds0;				// Send count at the startup's start
 	// Record in the log file what we sent and when
 	unsigned logSend(
 				packetbuf *cmd,
 				cnErrCode theErr,
-				double timeStamp);
+				Uint64 timeNs);
 	// Record in the log file what we received and when
 	double logReceive(
 				packetbuf *readBuf,
 			    cnErrCode theErr,
 			    respTrackInfo *fillInfo,
-			    double timeStamp);
+			    Uint64 timeNs);
+	// Record a port event in the receive log
+	void logMark(
+				Uint32 kind,
+				cnErrCode theErr,
+				Uint8 info);
+	void logMark(
+				Uint32 kind,
+				cnErrCode theErr,
+				const void *pData,
+				Uint8 len);
+	// Add a command outcome to the latency histograms
+	void logLatency(
+				const packetbuf &cmd,
+				Uint64 execNs,
+				bool timedOut);
+	// Add a wait for a ring slot to the queue histograms
+	void logQueueWait(
+				cmdClasses cls,
+				Uint64 waitNs);
+private:
+	void logRxRecord(
+				packetbuf *readBuf,
+				cnErrCode theErr,
+				Uint32 sendCnt,
+				Uint32 sendSer,
+				Uint64 timeNs);
+public:
 
 	// - - - - - - - - - - - - - - - -//
 	// == Net Specific Information == //
@@ -346,6 +536,14 @@ public:
 	CCCriticalSection onlineOfflineLock;        // Initialization critical section
 	// Number of simultaneous commands allowed in ring
 	nodeulong NumCmdsInRing;
+	// Responses are matched and completed on the serial reader thread
+	nodebool SingleHopRx;
+	// Parameter reads in flight, see paramFlight
+	CCCriticalSection paramFlightLock;
+	paramFlight *pParamFlights;
+	// Keep later reads from sharing those in flight before <pCmd>
+	void paramFlightsSent(
+				const packetbuf *pCmd);
 
 	// Initializing "stack"	counter. Maintained by infcSetInitializeMode.
 	// When this counter decrements back to zero, we signal we are "online",
@@ -445,6 +643,40 @@ public:
 
 
 
+//*****************************************************************************
+// NAME																          *
+// 	startupTimer class
+//
+// DESCRIPTION
+//	Times one phase of a port's startup into its StartupProfile, from
+//	construction until End or destruction. A node of -1 times the port,
+//	otherwise the phase is also added to the node's class setup entry.
+//	Ended phases are written to the trace as marks when enabled by
+//	infcStartupProfileTrace.
+//
+class startupTimer {
+private:
+	netaddr m_cNum;
+	startupPhases m_phase;
+	int m_node;
+	Uint64 m_startNs;
+	Uint32 m_startCmds;
+	bool m_running;
+public:
+	startupTimer(netaddr cNum, startupPhases phase, int node = -1);
+	~startupTimer();
+	// Stop timing and add the phase to the profile
+	void End();
+	// Clear the port's profile as its startup begins
+	static void Begin(netaddr cNum);
+	// Close the port's profile with the startup outcome
+	static void Finish(netaddr cNum, cnErrCode result);
+};
+//																			  *
+//*****************************************************************************
+
+
+
 //*****************************************************************************
 // NAME																          *
 // 	profileStats structure
@@ -518,6 +750,39 @@ typedef struct _dataAcqInfo {
 
 
 
+//*****************************************************************************
+// NAME																          *
+// 	asyncCmdInfo structure
+//
+// DESCRIPTION
+//	State behind an infcCmdHandle. The submitter and the response tracking
+//	each hold a reference; the record is deleted when both have let go.
+//
+typedef struct _asyncCmdInfo {
+	infcCmdDoneCallback doneFunc;		// Completion callback or NULL
+	void *context;						// Submitter's callback context
+	packetbuf *pResp;					// User's response location
+	volatile cnErrCode result;			// Outcome, valid when done
+	volatile nodebool done;				// Set when the command completes
+	CCEvent evtDone;					// Signalled when the command completes
+	volatile long refs;					// Outstanding references
+	struct _asyncCmdInfo *nextCanceled;	// Next flushed record to complete
+	// Construct a pending record
+	_asyncCmdInfo() :
+		doneFunc(),
+		context(),
+		pResp(),
+		result(MN_OK),
+		done(FALSE),
+		refs(0),
+		nextCanceled() {
+	}
+} asyncCmdInfo;
+//																			  *
+//*****************************************************************************
+
+
+
 //*****************************************************************************
 // NAME																          *
 // 	respTrackInfo & respNodeList structure
@@ -532,35 +797,116 @@ typedef struct _respTrackInfo {
 	struct _respTrackInfo *next;		// Ptr to next response waiting thread
 	nodebool bufOK;						// TRUE if the buf has data
 	packetbuf *buf;						// User's response location
-	// This event blocks the commanding thread from running until
-	// the response is detected.
-	CCEvent evtRespWait;
+	// This one-shot blocks the commanding thread from running until
+	// the response is detected. It is re-armed each time the tracker
+	// is assigned, the tag identifies this use.
+	CCOneShot respDone;
+	Uint32 respTag;
+	unsigned slot;						// Index in the tracker pool
 	Uint32 sendSerNum;					// Sending serial number
 	Uint32 nSentAtAddr;					// sendCnt for this node
-	double cmdStartAt;					// Time-stamp at start of infcSendCommand
-	double funcStartAt;					// Time-stamp at start of infcRunCommand
+	Uint64 cmdStartNs;					// Core time at start of infcSendCommand
+	Uint64 funcStartNs;					// Core time at start of infcRunCommand
+	Uint64 respTimeoutNs;				// Response time-out from cmdStartNs
 	mnCompletionInfo stats;				// Command completion statistics
+	// Set when started by infcSubmitCommand, NULL for waiting threads
+	asyncCmdInfo *pAsync;
+	// Set when the command timed out before the fixed time-out, the entry
+	// stays in place to absorb a late response
+	nodebool orphaned;
 	// Construct an empty tracking info record
 	_respTrackInfo() :
 		next(),
 		bufOK(),
 		buf(),
+		respTag(),
+		slot(),
 		sendSerNum(),
 		nSentAtAddr(),
-		cmdStartAt(),
-		funcStartAt() {
+		cmdStartNs(),
+		funcStartNs(),
+		respTimeoutNs(),
+		pAsync(),
+		orphaned() {
 	}
 } respTrackInfo;
 
+// Classes of commands given adaptive response time-outs. Anything that
+// may run long, such as resets, parameter writes that reach non-volatile
+// storage or node specific commands, waits the fixed time-out. A command
+// that times out early keeps its place in its node's response order until
+// the fixed time-out, see netStateInfo::timeoutDBitem.
+typedef enum _rtoClasses {
+	RTO_CLASS_GET,						// Parameter reads
+	RTO_CLASS_CTL,						// Short control commands
+	RTO_CLASS_CNT,
+	RTO_CLASS_FIXED = RTO_CLASS_CNT		// Uses InfcRespTimeOut
+} rtoClasses;
+// Round trips measured before a class's time-out adapts
+#define RTO_SAMPLES_MIN		16
+
+// Round trip estimate for one class of command to a node. The time-out is
+// the smoothed round trip plus four deviations as in TCP (RFC 6298),
+// doubled for each time-out in a row and held between the floor and the
+// ceiling.
+typedef struct _rtoEstimate {
+	Uint64 srttNs;						// Smoothed round trip
+	Uint64 rttvarNs;					// Round trip deviation
+	Uint32 samples;						// Round trips measured
+	Uint32 backoff;						// Time-outs in a row
+	// Forget the history
+	void Clear() {
+		srttNs = rttvarNs = 0;
+		samples = backoff = 0;
+	}
+	// Add a measured round trip
+	void Sample(Uint64 rttNs) {
+		if (samples == 0) {
+			srttNs = rttNs;
+			rttvarNs = rttNs / 2;
+		}
+		else {
+			Uint64 err = rttNs > srttNs ? rttNs - srttNs : srttNs - rttNs;
+			rttvarNs = rttvarNs - rttvarNs / 4 + err / 4;
+			srttNs = srttNs - srttNs / 8 + rttNs / 8;
+		}
+		if (samples < RTO_SAMPLES_MIN) {
+			samples++;
+		}
+		backoff = 0;
+	}
+	// Time-out for the next command
+	Uint64 TimeoutNs(Uint64 floorNs, Uint64 ceilNs) const {
+		Uint64 rto;
+		if (samples < RTO_SAMPLES_MIN || floorNs == 0) {
+			return ceilNs;
+		}
+		rto = srttNs + 4 * rttvarNs;
+		if (rto < floorNs) {
+			rto = floorNs;
+		}
+		for (Uint32 i = 0; i < backoff && rto < ceilNs; i++) {
+			rto *= 2;
+		}
+		return rto < ceilNs ? rto : ceilNs;
+	}
+	_rtoEstimate() {
+		Clear();
+	}
+} rtoEstimate;
+
 // This is the main by-node tracking database element. It holds the list of
 // expected responses for a particular node as well as error information and
-// some by-node statistics.
+// some by-node statistics. Each list has its own lock so traffic for
+// different nodes does not serialize.
 typedef struct _respNodeList {
+	CCCriticalSection listLock;			// Protects this list
 	respTrackInfo *head;				// Head (oldest) waiter on the net
 	respTrackInfo *tail;				// Tail (newest) waiter on the net
 	packetbuf errPkt;					// Error packet
 	Uint32 sendCnt;						// Sending count
 	Uint32 respCnt;						// Receive count
+	rtoEstimate rto[RTO_CLASS_CNT];		// Round trips by command class
 	// Construct an empty by node tracker
 	_respNodeList() {
 		head = tail = NULL;
@@ -572,6 +918,63 @@ typedef struct _respNodeList {
 //*****************************************************************************
 
 
+//*****************************************************************************
+// NAME																          *
+// 	cmdPacer class
+//
+// DESCRIPTION
+//	Counts the commands the ring has room for, like a semaphore, but a slot
+//	freed while threads are waiting goes to the most urgent class waiting,
+//	the oldest first within a class. TryLock only takes a slot no thread is
+//	waiting for, so a window never jumps the queue. Free slots only exist
+//	while no thread waits, so they are taken without the lock. Returning
+//	more slots than the pacer was built with fails, as releasing a
+//	semaphore past its maximum does.
+//
+// Motion initiators, the same in the ISC and ClearPath-SC command sets
+#define CMD_CLASS_MOVE_FIRST	64
+#define CMD_CLASS_MOVE_LAST		71
+
+class cmdPacer {
+public:
+	cmdPacer(long slots);
+	// Wait for a slot for a command of class <cls>
+	bool Lock(
+				cmdClasses cls,
+				Uint64 *pWaitNs = NULL);
+	// Take a slot if one is free now
+	bool TryLock();
+	// Return one slot
+	int Unlock();
+	// Return <count> slots, <pFreeCount> gets the slots left free
+	bool Unlock(
+				long count,
+				long *pFreeCount = NULL);
+private:
+	// A thread waiting for a slot, lives on the waiting thread's stack
+	typedef struct _waiter {
+		struct _waiter *next;
+		bool granted;					// Slot handed over, under lock
+		CCEvent wake;					// Set once granted
+		_waiter() : next(NULL), granted(false) {
+		}
+	} waiter;
+	CCCriticalSection lock;				// Protects the waiters
+	volatile long freeSlots;			// Slots no thread holds
+	long maxSlots;						// Slots the ring has room for
+	waiter *head[CMD_CLASS_CNT];		// Oldest waiter by class
+	waiter *tail[CMD_CLASS_CNT];		// Newest waiter by class
+	// Take a free slot if there is one
+	bool TakeFree();
+	// Queue as a waiter and block until granted a slot
+	void WaitForSlot(
+				cmdClasses cls,
+				Uint64 *pWaitNs);
+};
+//																			  *
+//*****************************************************************************
+
+
 
 //*****************************************************************************
 // NAME																          *
@@ -689,6 +1092,8 @@ public:
 	void Start();
 	void Stop();
 	void ForceStop();
+	// Terminate, releasing a halted thread so it can be joined
+	HANDLE Terminate();
 
 	// Change read thread state
 	void NextState(readThreadStates nextState);
@@ -806,9 +1211,14 @@ public:
 	// Set this to cause all threads to terminate
 	nodebool SelfDestruct;				// Net wide self-destruct flag
 
-	nodeulong nRespOutstanding;			// Number of responses waiting
+	volatile nodeulong nRespOutstanding;	// Number of responses waiting
+	volatile long nAsyncOutstanding;	// Submitted cmds not yet completed
+	volatile long nOrphans;				// Timed out entries left in place
+	asyncCmdInfo *pCanceledAsync;		// Flushed cmds awaiting completion
+	CCCriticalSection canceledLock;		// Protects pCanceledAsync
 	nodeulong nPktsSent;				// Number of packets sent
 	nodeulong nPktsRcvd;				// Number of packets received
+	volatile nodebool readThreadRx;		// Read thread is handling a packet
 
 	size_t ErrListHeadPtr;				// Error head ptr
 	size_t ErrListTailPtr;				// Error tail ptr
@@ -829,11 +1239,12 @@ public:
 	nodebool paramsHaveChanged[MN_API_MAX_NODES];
 
 	nodeulong RingCmdsMax;				// Max # of simultaneous cmds in ring
-	CCSemaphore CmdPaceSemaphore;		// Command pacing semaphore
+	cmdPacer CmdPaceSemaphore;			// Command pacing by class
 #ifdef _DEBUG
 	long	SemaCount;
 #endif
-	CCCriticalSection cmdLock;			// Command/Response data Lock
+	CCCriticalSection cmdLock;			// Whole response database lock
+	CCCriticalSection sendLock;			// Keeps packet writes whole
 
 	// Interrupt events
 	CCEvent IrqEvent;					// IRQ event signaller
@@ -857,11 +1268,10 @@ public:
 	// ---------------------------------
 	// These are the command tracking information records
 	// They contain house keepers, events and tracking info. They are assigned 
-	// via the pTrkTail pointer.  When the tracking is complete it is
-	// put back at the tail.
+	// via trkAlloc, which claims a set bit of trkFreeMask.  When the tracking
+	// is complete trkFree sets its bit again.
 	respTrackInfo **pTrkFixedList;		// Ptr to pTrkInfo ptrs
-	respTrackInfo **pTrkList;			// Ptr to pTrkInfo ptrs
-	respTrackInfo **pTrkTail;			// Ptr to available tracker
+	volatile Uint64 trkFreeMask;		// Bit set for each free tracker
 	respNodeList respNodeState[MN_API_MAX_NODES];
 	respNodeList controlNodeState;
 
@@ -903,14 +1313,44 @@ public:
 	// PUBLIC API
 	// ---------------------------------
 
-	// Command/Response Data Structure lock
+	// Command/Response Data Structure lock, locks every response list
 	void enterCmdLock();
 	void exitCmdLock();
 
+	// Response list access by index and lock sets, bit n is list n
+	respNodeList *respList(unsigned listIndex) {
+		return (listIndex < MN_API_MAX_NODES) ? &respNodeState[listIndex]
+											  : &controlNodeState;
+	}
+	static unsigned respListIndex(packetbuf *pCmd) {
+		return MN_PKT_IS_HIGH_PRIO(pCmd->Fld.PktType) ? MN_API_MAX_NODES
+													  : pCmd->Fld.Addr;
+	}
+	void lockLists(Uint32 listMask);
+	void unlockLists(Uint32 listMask);
+
+	// Adaptive response time-outs by node and command class
+	static rtoClasses rtoClassOf(
+				const packetbuf *pCmd);
+	Uint64 respTimeoutNs(
+				packetbuf *pCmd);
+
+	// Scheduling class of a command from the calling thread
+	static cmdClasses cmdClassOf(
+				const packetbuf *pCmd);
+
+	// Lock-free tracker pool
+	respTrackInfo *trkAlloc();
+	void trkFree(respTrackInfo *pTrk);
+
+	// Retire one outstanding response, returns the number left
+	nodeulong respRelease();
+
 	// Inquire if current thread is a recovery or finding nodes thread.
 	nodebool isRecoveryThread();
 
-	// Inquire if current thread is the read thread.
+	// Inquire if current thread is the read thread, or the serial reader
+	// when it completes responses.
 	nodebool isReadThread();
 
 	// Tracking data base maintainence
@@ -918,9 +1358,49 @@ public:
 				respTrackInfo *pRespInfo,
 				respNodeList *pRespArea);
 
+	// Retire a timed out entry, leaving it to absorb a late response if it
+	// timed out before the fixed time-out
+	void timeoutDBitem(
+				respTrackInfo *pRespInfo,
+				respNodeList *pRespArea);
+
 	void removeHeadDBitem(
 				respNodeList *pRespArea);
 
+	// Complete the head waiter of <pNodeList> with <readBuf>, the list
+	// lock is held on entry and released on return.
+	void completeHeadResp(
+				respNodeList *pNodeList,
+				packetbuf &readBuf,
+				Uint64 rxNs,
+				Uint64 readNs);
+
+	// Serial reader packet hook for single-hop receive
+	static bool singleHopRx(
+				void *context,
+				packetbuf &thePacket);
+
+	// Complete a submitted command and drop the tracking reference
+	void completeAsync(
+				asyncCmdInfo *pAsync,
+				cnErrCode theErr);
+
+	// Time-out submitted commands whose responses are overdue
+	void expireAsyncItems();
+
+	// Time-out a submitted command its submitter stopped waiting for
+	void abandonAsync(
+				asyncCmdInfo *pAsync);
+
+	// Queue a submitted command detached by a flush for completion once
+	// the list locks are released
+	void cancelAsync(
+				asyncCmdInfo *pAsync);
+
+	// Complete the commands queued by cancelAsync with MN_ERR_CANCELED,
+	// called without any list locks held
+	void completeCanceled();
+
 	// Waits for network traffic to complete without sending any data
 	void waitForIdle();
 };
@@ -946,6 +1426,12 @@ extern "C" {
 			nodeushort cNum,						// Port Index
 			packetbuf *theCommand);			    // Ptr to buffered command
 
+	// Low Level transmission of several commands with one write
+	cnErrCode MN_DECL infcSendCommands(
+			netaddr cNum,						// Port Index
+			packetbuf *theCommands,				// Array of buffered commands
+			size_t nCmds);						// Number of commands
+
 	// ---------------------------------
 	// CALLBACK INTERFACES
 	// ---------------------------------
@@ -1047,6 +1533,20 @@ extern "C" {
 	cnErrCode infcTraceDumpNext(
 			netaddr cNum);
 
+	// Fill in the trace file header fields common to dumps and streams,
+	// leaving the record counts and indices to the caller
+	void infcTraceHeaderFill(
+			netaddr cNum,
+			traceHeader &theHeader);
+
+	// Expand trace ring slots into the trace file records
+	void infcTraceRxExpand(
+			const rxTraceSlot &slot,
+			rxTraceBuf &rec);
+	void infcTraceTxExpand(
+			const txTraceSlot &slot,
+			txTraceBuf &rec);
+
 	// Returns a string terminated with directory delimiter for
 	// automatically generated dump files. For Windows
 	// this directory is "%TEMP%\Teknic\".
@@ -92,6 +92,14 @@ MN_EXPORT cnErrCode MN_DECL netRunCommand(
 		netaddr cNum,				// Controller number
 		packetbuf *theCommand,		// pointer to filled in command
 		packetbuf *theResponse);	// pointer to response area
+
+// Run a set of commands on <cNum> and wait for all of the responses
+MN_EXPORT cnErrCode MN_DECL netRunCommandBatch(
+		netaddr cNum,				// Controller number
+		packetbuf theCommands[],	// filled in commands
+		packetbuf theResponses[],	// response areas
+		nodeulong nCmds,			// number of commands
+		cnErrCode theErrs[]);		// per command outcome or NULL
 					
 //----------------------------------
 // PARAMETER ACCESS AND MANIPULATION
@@ -138,6 +146,64 @@ MN_EXPORT cnErrCode MN_DECL netGetParameterInfo(
 		nodeparam theParam,			// Parameter number
 		paramInfo *pRetValInfo,		// Ptr to returning value info or NULL
 		paramValue *pRetVal);		// Ptr to returning value or NULL
+
+// Get info enhanced values of several parameters read back to back
+MN_EXPORT cnErrCode MN_DECL netGetParameterSet(
+		multiaddr multiAddr,		// Node address
+		nodeulong nParams,			// Number of parameters
+		const nodeparam theParams[],// Parameter numbers
+		paramValue theRetVals[]);	// Returned values
+
+// Get info enhanced values of parameters of any nodes on a port
+MN_EXPORT cnErrCode MN_DECL netGetParameterList(
+		netaddr cNum,				// Port
+		nodeulong nParams,			// Number of parameters
+		const multiaddr theAddrs[],	// Node addresses
+		const nodeparam theParams[],// Parameter numbers
+		paramValue theRetVals[],	// Returned values
+		cnErrCode theErrs[]);		// Per parameter outcome
+
+//----------------------------------
+// CYCLIC REFRESH
+//----------------------------------
+// Latest value of a subscribed parameter
+typedef struct _cyclicSlot cyclicSlot;
+typedef struct _mnCyclicStats mnCyclicStats;
+
+// Add a parameter to the port's cyclic refresh
+MN_EXPORT cnErrCode MN_DECL netCyclicSubscribe(
+		multiaddr theMultiAddr,		// Node address
+		nodeparam theParam,			// Parameter number
+		cyclicSlot **ppSlot);		// Ptr to returned slot
+
+// Remove a parameter from the cyclic refresh and free its slot
+MN_EXPORT void MN_DECL netCyclicUnsubscribe(
+		cyclicSlot *pSlot);
+
+// Copy the latest value of a slot
+MN_EXPORT cnErrCode MN_DECL netCyclicRead(
+		cyclicSlot *pSlot,
+		paramValue *pRetVal,		// Ptr to returned value or NULL
+		double *pAgeMs);			// Ptr to age of the value or NULL
+
+// Start, or change the period of, the cyclic refresh of a port
+MN_EXPORT cnErrCode MN_DECL netCyclicStart(
+		netaddr cNum,
+		nodeulong periodMs);
+
+// Stop the cyclic refresh of a port
+MN_EXPORT cnErrCode MN_DECL netCyclicStop(
+		netaddr cNum);
+
+// Get the cyclic refresh statistics of a port
+MN_EXPORT cnErrCode MN_DECL netCyclicStats(
+		netaddr cNum,
+		mnCyclicStats *pStats,		// Ptr to returned statistics
+		nodebool reset);			// Clear the counts after copying
+
+// Set the parameter cache file used for warm starts, NULL to stop caching
+MN_EXPORT cnErrCode MN_DECL netParamCacheFile(
+		const char *pPath);
 	
 //----------------------------------
 // ALERT INTERFACE
@@ -116,6 +116,30 @@ cnErrCode coreBaseSetParameterInt(netaddr cNum, nodeaddr theNode,
 cnErrCode coreUpdateParamInfo(
 		multiaddr multiAddr);		// Node to update		
 
+// Fill a value database entry from a value read earlier
+cnErrCode coreParamPrefill(
+		multiaddr multiAddr,		// Node address
+		nodeparam theParam,			// Parameter number
+		const packetbuf *pRaw);		// Raw value
+
+// Test for, and copy, a value the database holds without a read
+bool coreParamCached(
+		multiaddr multiAddr,		// Node address
+		nodeparam theParam,			// Parameter number
+		packetbuf *pRaw);			// Raw value or NULL
+
+// Prefill the value databases of nodes from the parameter cache file
+void coreParamCacheApply(
+		netaddr cNum,				// Port
+		nodeulong nNodes,			// Number of nodes
+		const nodeaddr theNodes[],	// Node addresses
+		bool theHits[]);			// Set for the nodes prefilled
+// Keep the read only values of a node before its database is freed
+void coreParamCacheCapture(
+		multiaddr multiAddr);		// Node address
+// Write the parameter cache file if it changed
+void coreParamCacheFlush();
+
 
 // Set info using enhanced value information
 cnErrCode netSetParameterInfo(
@@ -144,6 +168,14 @@ cnErrCode MN_DECL netGetParameterFmt(
 cnErrCode MN_DECL netGetParameterExtract(
 		packetbuf *frameBuf,		// ptr to the frame buffer to format
 		packetbuf *paramInfo);		// ptr to return buffer
+// Get raw parameters of any nodes on a port with the reads back to back
+cnErrCode MN_DECL netGetParameterRawList(
+		netaddr cNum,				// Port
+		nodeulong nParams,			// Number of parameters
+		const multiaddr theAddrs[],	// Node addresses
+		const nodeparam theParams[],// Parameter numbers
+		packetbuf theBufs[],		// Returned contents
+		cnErrCode theErrs[]);		// Per parameter outcome
 // Set parameter command
 cnErrCode MN_DECL netSetParameterFmt(
 		packetbuf *frameBuf,		// ptr to the frame buffer to format
@@ -36,6 +36,10 @@
 #if !(defined(_WIN32)||defined(_WIN64))
         #define THREAD_PRIORITY_BELOW_NORMAL (-1)
 #endif
+// Number of thread roles with their own scheduling setup
+#define THREAD_ROLE_MAX		8
+// Thread is not assigned a role, it inherits the creator's scheduling
+#define THREAD_ROLE_NONE	(-1)
 
 //***************************************************************************
 // NAME																	    *
@@ -58,6 +62,23 @@
 
 
 
+//*****************************************************************************
+// NAME																		  *
+// 	threadSchedSpec
+//
+// DESCRIPTION:
+///	Scheduling setup applied to the threads of a role as they start.
+//
+typedef struct _threadSchedSpec {
+	int policy;								// OS scheduling policy
+	int priority;							// Real-time priority
+	unsigned long long cpuMask;				// Allowed CPUs, 0 for any
+} threadSchedSpec;
+//																			  *
+//*****************************************************************************
+
+
+
 //*****************************************************************************
 // NAME																		  *
 // 	CThread Class
@@ -121,6 +142,11 @@ protected:
 	void *m_status;
 	// Last error code
 	nodeulong m_lastErr;
+	// Scheduling role and priority adjustment from LaunchThread
+	int m_role;
+	int m_priority;
+	// Apply the role's scheduling to the calling thread
+	void applySched();
 
 public:
 	CCEvent m_TermEvent;					// Termination ACK event
@@ -133,6 +159,12 @@ public:
 	static void Sleep(Uint32 milliseconds);
 	// Create the thread
 	HANDLE LaunchThread(void *context = NULL, int priority = 0);
+	// Select the scheduling role used when the thread is launched
+	void SetRole(int role) {
+		m_role = role;
+	}
+	// Set the scheduling for threads of <role> launched after this
+	static nodebool SetRoleSched(int role, const threadSchedSpec &spec);
 #ifdef THREAD_SLOTS
 	signal0<> ShuttingDown;					// Signal at termination time
 	signal0<> Shutdown;						// Signal as terminating
@@ -0,0 +1,135 @@
+//*****************************************************************************
+// NAME
+//		traceStream.h
+//
+// DESCRIPTION:
+//		Streaming command trace sink. A background thread drains a port's
+//		trace rings into a rotating set of memory mapped trace files that
+//		use the same layout as the trace dump.
+//
+// CREATION DATE:
+//		10/16/2026
+//
+// COPYRIGHT NOTICE:
+//		(C)Copyright 2026  Teknic, Inc.  All rights reserved.
+//
+//		This copyright notice must be reproduced in any copy, modification,
+//		or portion thereof merged into another program. A copy of the
+//		copyright notice must be included in the object library of a user
+//		program.
+//
+//																			  *
+//*****************************************************************************
+#ifndef __TRACESTREAM_H__
+#define __TRACESTREAM_H__
+
+
+//*****************************************************************************
+// NAME																          *
+// 	traceStream.h headers
+//
+	#include "lnkAccessCommon.h"
+	#include "tekThreads.h"
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	traceStream.h constants
+//
+// Period between drains of the trace rings. The rings must not lap the
+// flusher in this time, 4096 records per ring is ~400ms at 10k packets/s.
+#define TRACE_STREAM_FLUSH_MS		20
+// Period between asking the OS to write back the mapped file
+#define TRACE_STREAM_SYNC_MS		1000
+// Drain passes to wait on a claimed slot before it is skipped
+#define TRACE_STREAM_STALL_MAX		4
+// Default records per direction in each file and default file count
+#define TRACE_STREAM_RECS_DEF		65536
+#define TRACE_STREAM_FILES_DEF		8
+// Smallest file accepted
+#define TRACE_STREAM_RECS_MIN		256
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	traceStream class
+//
+// DESCRIPTION
+//	Drains a port's trace rings into files named
+//	"<dir>MNtrace<cNum>-<n>.dat", <n> cycling through the file count. Each
+//	file is a trace dump: a traceHeader followed by the RX then the TX
+//	records. While a file is open its RX area is sized for the full file
+//	and unused records are zero. The file is compacted to the records
+//	written when it is rotated or closed.
+//
+//	The command path is untouched, the records are copied out of the
+//	rings by this thread only.
+//
+class traceStream : public CThread
+{
+private:
+	netaddr m_cNum;							// Port we stream
+	char m_dir[MAX_PATH];					// File directory with delimiter
+	Uint32 m_fileRecs;						// Records per direction per file
+	Uint32 m_fileCount;						// Files in the rotation
+	Uint32 m_fileNum;						// Current file number
+	int m_fd;								// Current file descriptor
+	Uint8 *m_map;							// Current file mapping
+	size_t m_mapLen;						// Bytes mapped
+	Uint32 m_nRX, m_nTX;					// Records in the current file
+	Uint32 m_rxNext, m_txNext;				// Next ring serial numbers
+	unsigned m_rxStall, m_txStall;			// Passes waiting on a slot
+	double m_lastSync;						// Time of last write back
+	CCEvent m_wake;							// Early wake for termination
+
+	// File area accessors
+	traceHeader *header() {
+		return (traceHeader *)m_map;
+	}
+	rxTraceBuf *rxRecs() {
+		return (rxTraceBuf *)(m_map + sizeof(traceHeader));
+	}
+	txTraceBuf *txRecs() {
+		return (txTraceBuf *)(m_map + sizeof(traceHeader)
+							  + size_t(m_fileRecs) * sizeof(rxTraceBuf));
+	}
+	// Create and map the next file in the rotation
+	cnErrCode openFile();
+	// Compact, write back and close the current file
+	void closeFile();
+	// Update the header counts for the records written so far
+	void updateHeader();
+	// Move newly completed ring records into the current file
+	void drain();
+	template<class slotT, class recT>
+	void drainRing(const slotT *ring, Uint32 depth, Uint32 serNum,
+				   Uint32 &next, unsigned &stall, Uint32 &nRecs, recT *recs);
+
+public:
+	volatile Uint32 Dropped;				// Records lost to ring laps
+
+	// Construction/Destruction
+	traceStream(netaddr cNum);
+	~traceStream();
+
+	// Open the first file and start streaming
+	cnErrCode Start(const char *dirPath, Uint32 fileRecs, Uint32 fileCount);
+
+	// CThread overrides for terminate
+	void *Terminate();
+
+protected:
+	int Run(void *context);					// Control function
+};
+//																			  *
+//*****************************************************************************
+
+#endif	// __TRACESTREAM_H__
+
+//=============================================================================
+//	END OF FILE traceStream.h
+//=============================================================================
@@ -155,10 +155,55 @@ MN_EXPORT cnErrCode MN_DECL infcRunCommand(
 		netaddr cNum,						// Port index
 		packetbuf *theCommand,				// Ptr to buffered command
 		packetbuf *theResponse);			// Ptr to response area
+
+// Completion handle for a command started by infcSubmitCommand.
+typedef struct _asyncCmdInfo *infcCmdHandle;
+
+// Asynchronous command completion callback. This runs on the port's read
+// thread and must not run or submit commands itself.
+typedef void (nodeCallback *infcCmdDoneCallback)(
+		infcCmdHandle hCmd,					// Completing command
+		cnErrCode theErr,					// Command outcome
+		packetbuf *theResponse,				// Ptr to response area
+		void *context);						// Submitter's context
+
+// Start a command without waiting for its response.
+MN_EXPORT cnErrCode MN_DECL infcSubmitCommand(
+		netaddr cNum,						// Port index
+		packetbuf *theCommand,				// Ptr to buffered command
+		packetbuf *theResponse,				// Ptr to response area
+		infcCmdDoneCallback doneFunc,		// Optional completion callback
+		void *context,						// Context for doneFunc
+		infcCmdHandle *pHandle);			// Optional ptr to handle result
+
+// Poll an asynchronous command, returns TRUE once complete.
+MN_EXPORT nodebool MN_DECL infcCommandDone(
+		infcCmdHandle hCmd,					// Submitted command
+		cnErrCode *pResult);				// Optional outcome result
+
+// Wait for an asynchronous command to complete.
+MN_EXPORT cnErrCode MN_DECL infcCommandWait(
+		infcCmdHandle hCmd,					// Submitted command
+		nodeulong timeoutMs);				// Wait limit (INFINITE ok)
+
+// Return a handle obtained from infcSubmitCommand.
+MN_EXPORT void MN_DECL infcCommandRelease(
+		infcCmdHandle hCmd);
+
+// Run several commands, sending each window with one write.
+MN_EXPORT cnErrCode MN_DECL infcRunCommandBatch(
+		netaddr cNum,						// Port index
+		packetbuf theCommands[],			// Buffered commands
+		packetbuf theResponses[],			// Response areas
+		cnErrCode theErrs[],				// Per command outcome
+		nodeulong nCmds);					// Number of commands
 		
 // Microsecond level time stamp
 MN_EXPORT double MN_DECL infcCoreTime(void);
 
+// Nanosecond time stamp on the infcCoreTime time base
+MN_EXPORT Uint64 MN_DECL infcCoreTimeNs(void);
+
 // Millisecond level thread sleep function
 MN_EXPORT void MN_DECL infcSleep(Uint32 milliseconds);
 
@@ -243,6 +288,11 @@ MN_EXPORT cnErrCode MN_DECL infcBackgroundPollControl(
 MN_EXPORT cnErrCode MN_DECL infcSetCmdQueueLimit(
 		netaddr cNum,				// Network 
 		nodeulong nCmds);			// Number of commands allowed at once
+
+// Complete responses on the serial reader thread
+MN_EXPORT cnErrCode MN_DECL infcSetSingleHopRx(
+		netaddr cNum,				// Network
+		nodebool enable);			// TRUE to skip the read thread hop
 		
 MN_EXPORT cnErrCode MN_DECL infcGetOnlineState(
 		netaddr cNum,
@@ -307,6 +357,18 @@ MN_EXPORT cnErrCode MN_DECL infcTraceDumpA(
 		netaddr cNum, 
 		const char *filePath);
 
+// Stream the trace to rotating trace files in <dirPath>
+MN_EXPORT cnErrCode MN_DECL infcTraceStreamStart(
+		netaddr cNum,
+		const char *dirPath,				// NULL for the dump directory
+		nodeulong fileRecords,				// Records per file, 0 = default
+		nodeulong fileCount);				// Files in rotation, 0 = default
+
+// Stop streaming the trace and close the current file
+MN_EXPORT cnErrCode MN_DECL infcTraceStreamStop(
+		netaddr cNum,
+		nodeulong *pDropped);				// Records lost or NULL
+
 // Get errors self-reported from nodes
 MN_EXPORT cnErrCode MN_DECL infcGetBackgroundErrs(
 	multiaddr theMultiAddr,
@@ -397,6 +459,36 @@ typedef void (nodeCallback *infcCmdCompleteCallback)(
 MN_EXPORT infcCmdCompleteCallback MN_DECL infcSetCmdCompleteFunc(
 	  		infcCmdCompleteCallback newFunc);	// Ptr to callback function
 
+// Copy a command latency histogram, optionally clearing it
+MN_EXPORT cnErrCode MN_DECL infcLatencyStatsGet(
+			netaddr cNum,
+			latencyScopes scope,				// Grouping
+			nodeulong key,						// Node address, command code or class
+			mnLatencyHist *pHist,				// Ptr to result
+			nodebool reset);					// Clear after copying
+
+// Clear all the latency histograms of the port
+MN_EXPORT cnErrCode MN_DECL infcLatencyStatsReset(
+			netaddr cNum);
+
+// Set the adaptive response time-out floor and the fixed time-out
+MN_EXPORT cnErrCode MN_DECL infcSetRespTimeouts(
+			nodeulong floorMs,					// 0 to disable adapting
+			nodeulong ceilingMs);				// Fixed time-out
+
+// Copy the profile of the port's last startup
+MN_EXPORT cnErrCode MN_DECL infcStartupProfileGet(
+			netaddr cNum,
+			mnStartupProfile *pProfile);		// Ptr to result
+
+// Write startup phases to the command trace as marks
+MN_EXPORT void MN_DECL infcStartupProfileTrace(
+			nodebool enable);
+
+// Set the scheduling class of the calling thread's commands
+MN_EXPORT cmdClasses MN_DECL infcCmdClassSet(
+			cmdClasses newClass);				// Returns the previous class
+
 // ---------------------
 // Change of parameter; need to invalidate cache
 
@@ -909,6 +909,13 @@ private:
     void TriggerMovesInGroup(size_t groupNumber);
     bool GetNextNetChange(NetworkChanges& pNetChange);
     void SetBackgroundPolling(bool enable);
+    void LatencyStats(latencyScopes scope, size_t key, mnLatencyHist &hist,
+                      bool reset = false);
+    void LatencyStatsReset();
+    void CyclicStart(size_t periodMs);
+    void CyclicStop();
+    void CyclicStats(mnCyclicStats &stats, bool reset = false);
+    void StartupProfile(mnStartupProfile &profile);
 protected:
     SysCPMportAdv(IPort &ourPort);
 };
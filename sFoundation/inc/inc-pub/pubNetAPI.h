@@ -331,6 +331,313 @@ typedef enum _BrakeControls BrakeControls;
 //******************************************************************************
 
 
+//*****************************************************************************
+// NAME
+//      threadRoles enum
+/**
+    \brief Library threads that may be given their own real-time setup.
+
+    \see sFnd::SysManager::ThreadRealtime
+**/
+enum _threadRoles
+{
+    /**
+        Serial port reader and event threads, they frame received packets.
+    **/
+    THREAD_ROLE_SERIAL_READER,
+    /**
+        Per port read thread, dispatches received packets to waiters.
+    **/
+    THREAD_ROLE_READ_PKT,
+    /**
+        Per port keep-alive poller.
+    **/
+    THREAD_ROLE_POLLER,
+    /**
+        Per port node auto-discovery.
+    **/
+    THREAD_ROLE_AUTO_DISCOVER,
+    /** \cond INTERNAL_DOC **/
+    THREAD_ROLE_CNT
+    /** \endcond **/
+};
+/// \copybrief _threadRoles
+typedef enum _threadRoles threadRoles;
+
+/**
+    \brief Scheduling setup for a thread role.
+
+    Policy is SCHED_OTHER, SCHED_FIFO or SCHED_RR. Priority is the real-time
+    priority used with SCHED_FIFO and SCHED_RR. CpuMask selects the CPUs
+    the threads may run on, bit n for CPU n, zero for no restriction.
+**/
+typedef struct _threadRtSpec {
+    int Policy;                 ///< Scheduling policy
+    int Priority;               ///< Real-time priority
+    Uint64 CpuMask;             ///< Allowed CPUs, 0 for any
+#ifdef __cplusplus
+    /** \cond INTERNAL_DOC **/
+    _threadRtSpec(int policy = 0, int priority = 0, Uint64 cpuMask = 0) :
+        Policy(policy),
+        Priority(priority),
+        CpuMask(cpuMask) {
+    }
+    /** \endcond **/
+#endif
+} threadRtSpec;
+//                                                                             *
+//******************************************************************************
+
+
+//*****************************************************************************
+// NAME
+//      Command latency histograms
+//
+// Histogram resolution: MN_LAT_SUB buckets per power of two, ~6% wide.
+// Latencies are kept in microseconds up to 2^32 us.
+#define MN_LAT_SUB_BITS     4
+#define MN_LAT_SUB          (1 << MN_LAT_SUB_BITS)
+#define MN_LAT_BUCKETS      ((33 - MN_LAT_SUB_BITS) * MN_LAT_SUB)
+// Command codes tracked by LATENCY_CMD
+#define MN_LAT_CMD_CNT      256
+/**
+    \brief Grouping of a latency histogram.
+
+    \see sFnd::IPortAdv::LatencyStats
+**/
+enum _latencyScopes
+{
+    /**
+        All commands on the port.
+    **/
+    LATENCY_PORT,
+    /**
+        Commands to one node address.
+    **/
+    LATENCY_NODE,
+    /**
+        Commands with one command code.
+    **/
+    LATENCY_CMD,
+    /**
+        Time commands of one \ref _cmdClasses "class" waited for room on
+        the ring before being sent.
+    **/
+    LATENCY_QUEUE
+};
+/// \copybrief _latencyScopes
+typedef enum _latencyScopes latencyScopes;
+
+/**
+    \brief Command latency histogram.
+
+    Latency is the time from a command reaching the serial port until its
+    response is read, or for LATENCY_QUEUE the time it waited to be sent.
+    Values below 2 * MN_LAT_SUB us are kept exactly,
+    larger values fall in one of MN_LAT_SUB log spaced buckets per power of
+    two. Timed out commands are only counted in \a Timeouts.
+**/
+typedef struct _mnLatencyHist {
+    Uint64 Count;               ///< Responses recorded
+    Uint64 SumUs;               ///< Sum of the latencies in us
+    Uint64 MaxUs;               ///< Largest latency in us
+    Uint64 Timeouts;            ///< Commands with no response in time
+    Uint64 Buckets[MN_LAT_BUCKETS]; ///< Responses by latency bucket
+#ifdef __cplusplus
+    /** \cond INTERNAL_DOC **/
+    // Bucket of a latency in us
+    static unsigned BucketOf(Uint64 us) {
+        unsigned msb = 0, idx;
+        if (us < 2 * MN_LAT_SUB) {
+            return unsigned(us);
+        }
+        while (us >> (msb + 1)) {
+            msb++;
+        }
+        idx = (msb - MN_LAT_SUB_BITS) * MN_LAT_SUB
+              + unsigned(us >> (msb - MN_LAT_SUB_BITS));
+        return idx < MN_LAT_BUCKETS ? idx : MN_LAT_BUCKETS - 1;
+    }
+    // Middle of a bucket in us
+    static double BucketUs(unsigned idx) {
+        if (idx < 2 * MN_LAT_SUB) {
+            return idx;
+        }
+        unsigned shift = idx / MN_LAT_SUB - 1;
+        Uint64 low = Uint64(idx - shift * MN_LAT_SUB) << shift;
+        return low + ((Uint64(1) << shift) - 1) / 2.0;
+    }
+    /** \endcond **/
+    /**
+        \brief Mean latency in milliseconds.
+    **/
+    double MeanMs() const {
+        return Count ? double(SumUs) / Count / 1000 : 0;
+    }
+    /**
+        \brief Latency in milliseconds at or below which \a pct percent of
+        the responses fall, within the bucket resolution.
+    **/
+    double PercentileMs(double pct) const {
+        Uint64 rank, seen = 0;
+        if (!Count) {
+            return 0;
+        }
+        rank = Uint64(pct / 100 * Count + 0.999999);
+        if (rank == 0) {
+            rank = 1;
+        }
+        for (unsigned idx = 0; idx < MN_LAT_BUCKETS; idx++) {
+            seen += Buckets[idx];
+            if (seen >= rank) {
+                double us = BucketUs(idx);
+                return (us < MaxUs ? us : double(MaxUs)) / 1000;
+            }
+        }
+        return MaxUs / 1000.0;
+    }
+#endif
+} mnLatencyHist;
+//                                                                             *
+//******************************************************************************
+
+
+//*****************************************************************************
+// NAME
+//      Command scheduling classes
+//
+/**
+    \brief Scheduling class of a command.
+
+    When the ring is full, the next free place goes to the waiting command
+    of the most urgent class, the oldest first within a class. Node stops
+    and triggers are always CMD_CLASS_URGENT and motion commands at least
+    CMD_CLASS_MOTION, other commands take the class of the sending thread.
+
+    \see sFnd::SysManager::CommandClass
+**/
+enum _cmdClasses
+{
+    /**
+        Node stops and triggers.
+    **/
+    CMD_CLASS_URGENT,
+    /**
+        Motion commands.
+    **/
+    CMD_CLASS_MOTION,
+    /**
+        Application commands, the default.
+    **/
+    CMD_CLASS_NORMAL,
+    /**
+        Configuration loads and data collection.
+    **/
+    CMD_CLASS_BULK,
+    /**
+        Background polling and keep-alive.
+    **/
+    CMD_CLASS_POLL,
+    /** \cond INTERNAL_DOC **/
+    CMD_CLASS_CNT
+    /** \endcond **/
+};
+/// \copybrief _cmdClasses
+typedef enum _cmdClasses cmdClasses;
+//                                                                             *
+//******************************************************************************
+
+
+//*****************************************************************************
+// NAME
+//      Cyclic refresh statistics
+//
+/**
+    \brief Statistics of a port's cyclic refresh.
+
+    A cycle reads every subscribed value of the port. When a cycle runs past
+    the start of the next one, the cycles it overran are skipped and counted
+    in \a Missed.
+
+    \see sFnd::IPortAdv::CyclicStats
+**/
+typedef struct _mnCyclicStats {
+    Uint64 Cycles;              ///< Cycles run
+    Uint64 Missed;              ///< Cycles skipped after an overrun
+    Uint64 Failed;              ///< Value reads that failed
+    Uint32 Subscribed;          ///< Values subscribed
+    double PeriodMs;            ///< Cycle period, 0 when stopped
+    double LastCycleMs;         ///< Duration of the last cycle
+    double MaxCycleMs;          ///< Longest cycle
+    double AgeMs;               ///< Age of the last cycle's samples, -1 if none
+} mnCyclicStats;
+//                                                                             *
+//******************************************************************************
+
+
+//*****************************************************************************
+// NAME
+//      Startup profile
+//
+/**
+    \brief Phases of a port's startup.
+
+    STARTUP_IDENTIFY, STARTUP_CLASS_SETUP and STARTUP_PRELOAD run inside
+    STARTUP_ENUMERATE and are included in its time.
+
+    \see sFnd::IPortAdv::StartupProfile
+**/
+enum _startupPhases
+{
+    STARTUP_START_PORT,         ///< Open the serial port, infcStartController
+    STARTUP_RESET,              ///< Reset the nodes, netReset
+    STARTUP_RESET_RATE,         ///< Restore the rate after reset, infcResetNetRate
+    STARTUP_SETTLE,             ///< Let the ring settle and flush it
+    STARTUP_SET_ADDRESS,        ///< Address the nodes, netSetAddress
+    STARTUP_SET_RATE,           ///< Go to the port's rate, infcSetNetRate
+    STARTUP_RING_DIAG,          ///< Broken ring diagnostics, infcBrokenRingDiag
+    STARTUP_ENUMERATE,          ///< Enumerate the nodes, netEnumerate
+    STARTUP_IDENTIFY,           ///< Read node IDs and access levels
+    STARTUP_CLASS_SETUP,        ///< Node class setup and refresh, all nodes
+    STARTUP_PRELOAD,            ///< Parameter cache and preload reads
+    /** \cond INTERNAL_DOC **/
+    STARTUP_PHASE_CNT
+    /** \endcond **/
+};
+/// \copybrief _startupPhases
+typedef enum _startupPhases startupPhases;
+
+/**
+    \brief Time and commands of one startup phase.
+**/
+typedef struct _mnStartupPhase {
+    Uint32 Runs;                ///< Times the phase ran, 0 if skipped
+    Uint32 Commands;            ///< Commands sent during the phase
+    double DurationMs;          ///< Total time in the phase
+} mnStartupPhase;
+
+/**
+    \brief Profile of a port's last startup.
+
+    Kept from the start of the last port initialization, by PortsOpen,
+    RestartWarm, RestartCold or automatic recovery, until the next one.
+    Commands are counted on the port, so commands sent by other threads
+    during a phase are included.
+
+    \see sFnd::IPortAdv::StartupProfile
+**/
+typedef struct _mnStartupProfile {
+    double StartMs;             ///< Time stamp of the start, 0 if never run
+    double TotalMs;             ///< Duration of the whole startup
+    Uint32 Commands;            ///< Commands sent during the startup
+    cnErrCode Result;           ///< Outcome of the startup
+    mnStartupPhase Phase[STARTUP_PHASE_CNT];    ///< By startupPhases
+    mnStartupPhase Node[MN_API_MAX_NODES];      ///< Class setup by node
+} mnStartupProfile;
+//                                                                             *
+//******************************************************************************
+
+
 #ifndef __TI_COMPILER_VERSION__
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 // Standard Error Object
@@ -52,6 +52,8 @@
 // NAME                                                                       *
 //      pubSysCls.h forward references
                                                       /** \cond INTERNAL_DOC **/
+// Latest value slot of the cyclic refresh
+struct _cyclicSlot;
 namespace sFnd
 {
     class INode;
@@ -233,6 +235,7 @@ namespace sFnd
         friend class CPMstatusAdv;
         friend class CPMouts;
         friend class CPMmotion;
+        friend class INode;
     private:
         double m_scaleToUser;
         nodeparam m_paramNum;
@@ -240,6 +243,7 @@ namespace sFnd
         bool m_exists;
         bool m_isVolatile;
         bool m_refreshOnAccess;
+        _cyclicSlot *m_pCyclic;
         /** \endcond **/
     public:
         /**
@@ -323,6 +327,41 @@ namespace sFnd
             \return True if the value of this parameter can change after refresh.
         **/
         bool IsVolatile() { return m_isVolatile; }
+
+        /**
+            \brief Keep this value fresh in the background.
+
+            Subscribing adds the value to the cyclic refresh of its node's
+            port, see IPortAdv::CyclicStart. While the port's refresh runs,
+            \a Refresh, and the accesses that refresh, take the latest value
+            read by the refresh thread instead of querying the node. They
+            still query the node when the latest read failed or the value is
+            more than two periods old.
+
+            Values are read in one batch per port each cycle, which suits
+            polling many values of many nodes at a steady rate. Clear on
+            read values and strings cannot be subscribed.
+
+            \param[in] subscribe Set true to subscribe, false to unsubscribe.
+        **/
+        void CyclicRefresh(bool subscribe);
+
+        /**
+            \brief Return the cyclic refresh subscription state.
+
+            \return True if the value is subscribed to its port's cyclic
+            refresh.
+        **/
+        bool CyclicRefresh() { return m_pCyclic != NULL; }
+
+        /**
+            \brief Age of the latest background value.
+
+            \return Milliseconds since the refresh thread sampled the value,
+            or a negative number if it is not subscribed or no value has been
+            read since the port's refresh started.
+        **/
+        double CyclicAgeMs();
         /** \cond INTERNAL_DOC **/
     protected:
         /// Set Valid state
@@ -338,8 +377,17 @@ namespace sFnd
         void Exists(bool newState);
         /// Set the volatile state
         void IsVolatile(bool newState) { m_isVolatile = newState; }
+        /// True if INode::Snapshot can read this value with others
+        virtual bool IsParam() { return false; }
+        /// Update from a value read by INode::Snapshot
+        virtual void RefreshFrom(const paramValue &val) {}
+        /// Update from the cyclic refresh, true if it had a value
+        bool CyclicLatest();
+        /// Copies are not subscribed
+        ValueBase(const ValueBase &other);
+        ValueBase &operator=(const ValueBase &other);
     public:
-        virtual ~ValueBase() {};
+        virtual ~ValueBase();
         /** \endcond **/
     };
     //                                                                            *
@@ -460,6 +508,12 @@ namespace sFnd
 
         **/
         void Refresh();
+        /** \cond INTERNAL_DOC **/
+    protected:
+        bool IsParam() { return true; }
+        void RefreshFrom(const paramValue &val);
+    public:
+        /** \endcond **/
 
         /**
             \brief Set new double value using the assignment operator.
@@ -907,6 +961,12 @@ namespace sFnd
 
         **/
         void Refresh();
+        /** \cond INTERNAL_DOC **/
+    protected:
+        bool IsParam() { return true; }
+        void RefreshFrom(const paramValue &val);
+    public:
+        /** \endcond **/
 
         /**
             \brief Set new signed value using the assignment operator.
@@ -1311,6 +1371,12 @@ namespace sFnd
 
         **/
         void Refresh();
+        /** \cond INTERNAL_DOC **/
+    protected:
+        bool IsParam() { return true; }
+        void RefreshFrom(const paramValue &val);
+    public:
+        /** \endcond **/
 
         /**
             \brief Set a new unsigned value using the assignment operator.
@@ -1925,6 +1991,12 @@ namespace sFnd
 
         **/
         void Refresh();
+        /** \cond INTERNAL_DOC **/
+    protected:
+        bool IsParam() { return true; }
+        void RefreshFrom(const paramValue &val);
+    public:
+        /** \endcond **/
 
         /**
             \brief Read, Test and Clear Accumulated <i>Status Register</i> state.
@@ -2330,6 +2402,12 @@ namespace sFnd
         **/
         void Refresh();
         /** \cond INTERNAL_DOC **/
+    protected:
+        bool IsParam() { return true; }
+        void RefreshFrom(const paramValue &val);
+    public:
+        /** \endcond **/
+        /** \cond INTERNAL_DOC **/
 /**
     \brief Read, Accumulate and Test and Clear Accumulated Alert Type
     Register state.
@@ -2555,6 +2633,12 @@ namespace sFnd
         **/
         void Refresh();
         /** \cond INTERNAL_DOC **/
+    protected:
+        bool IsParam() { return true; }
+        void RefreshFrom(const paramValue &val);
+    public:
+        /** \endcond **/
+        /** \cond INTERNAL_DOC **/
         /**
         \brief Read, Accumulate and Test and Clear Accumulated Power Type
         Register state.
@@ -2639,6 +2723,12 @@ namespace sFnd
             threads.
         **/
         void Refresh();
+        /** \cond INTERNAL_DOC **/
+    protected:
+        bool IsParam() { return true; }
+        void RefreshFrom(const paramValue &val);
+    public:
+        /** \endcond **/
         /**
             \brief Clear fields from the output register state
 
@@ -2798,6 +2888,12 @@ namespace sFnd
             Configuration</i> register.
         **/
         void Refresh();
+        /** \cond INTERNAL_DOC **/
+    protected:
+        bool IsParam() { return true; }
+        void RefreshFrom(const paramValue &val);
+    public:
+        /** \endcond **/
         /**
             \brief Clear fields in this register in a thread safe manner.
 
@@ -2922,6 +3018,12 @@ namespace sFnd
             Configuration</i> register.
         **/
         void Refresh();
+        /** \cond INTERNAL_DOC **/
+    protected:
+        bool IsParam() { return true; }
+        void RefreshFrom(const paramValue &val);
+    public:
+        /** \endcond **/
 
         /**
             \brief Clear fields in this register in a thread safe manner.
@@ -3402,6 +3504,115 @@ namespace sFnd
 
         virtual void SetBackgroundPolling(bool enable) = 0;
 
+        /**
+            \brief Copy a command latency histogram of this port.
+
+            \param[in] scope Group the histogram covers.
+            \param[in] key Node address for LATENCY_NODE, command code for
+            LATENCY_CMD, command class for LATENCY_QUEUE, ignored for
+            LATENCY_PORT.
+            \param[out] hist The histogram copy.
+            \param[in] reset Clear the histogram as it is copied.
+
+            The library records the latency of every command response, from
+            the command reaching the serial port until its response is read,
+            without any callback. The LATENCY_QUEUE histograms hold the time
+            commands of each class waited for room on the ring before that.
+            The copy is taken without stopping the traffic.
+
+            \remark A \ref _mnErr object is thrown if the scope or key is
+            invalid or the port was never opened.
+
+            \if CPP
+            \CODE_SAMPLE_HDR
+            mnLatencyHist hist;
+            myPort.Adv.LatencyStats(LATENCY_NODE, 0, hist);
+            printf("node 0: p50 %.3f p99 %.3f p99.9 %.3f ms, %llu timeouts\n",
+                   hist.PercentileMs(50), hist.PercentileMs(99),
+                   hist.PercentileMs(99.9), hist.Timeouts);
+            \endcode
+            \endif
+        **/
+        virtual void LatencyStats(latencyScopes scope, size_t key,
+                                  mnLatencyHist &hist, bool reset = false) = 0;
+
+        /**
+            \brief Clear all the command latency histograms of this port.
+        **/
+        virtual void LatencyStatsReset() = 0;
+
+        /**
+            \brief Start the cyclic refresh of this port.
+
+            \param[in] periodMs Cycle period in milliseconds. Calling this
+            on a running refresh changes its period.
+
+            A library thread reads every value subscribed with
+            ValueBase::CyclicRefresh, from all the nodes of the port, once
+            per period. The reads of a cycle are sent back to back in windows
+            of the ring's command limit, so a cycle takes about one round
+            trip per window. Subscribed values then refresh from the latest
+            cycle without any network traffic.
+
+            \remark A \ref _mnErr object is thrown if the period is zero.
+
+            \if CPP
+            \CODE_SAMPLE_HDR
+            myNode.Motion.PosnMeasured.CyclicRefresh(true);
+            myPort.Adv.CyclicStart(10);
+            // No network traffic, the value is at most ~10ms old
+            double posn = myNode.Motion.PosnMeasured;
+            \endcode
+            \endif
+        **/
+        virtual void CyclicStart(size_t periodMs) = 0;
+
+        /**
+            \brief Stop the cyclic refresh of this port.
+
+            Subscribed values go back to querying the node on refresh. The
+            subscriptions remain for the next CyclicStart.
+        **/
+        virtual void CyclicStop() = 0;
+
+        /**
+            \brief Copy the cyclic refresh statistics of this port.
+
+            \param[out] stats The statistics copy.
+            \param[in] reset Clear the counts as they are copied.
+
+            \a Missed counts the cycles skipped because a cycle ran past
+            the start of the next one, a sign the period is too short for
+            the values subscribed.
+        **/
+        virtual void CyclicStats(mnCyclicStats &stats, bool reset = false) = 0;
+
+        /**
+            \brief Copy the profile of this port's last startup.
+
+            \param[out] profile The profile copy.
+
+            Each phase of opening the port, finding and addressing the
+            nodes and setting them up records the time it took and the
+            commands sent during it. \a Node holds the class setup of
+            each node address. A copy taken while the port is starting
+            holds the phases done so far.
+
+            \see SysManager::StartupProfileTrace to also write the phases
+            to the command trace.
+
+            \if CPP
+            \CODE_SAMPLE_HDR
+            mnStartupProfile prof;
+            myPort.Adv.StartupProfile(prof);
+            printf("startup %.1f ms, %u commands, enumerate %.1f ms\n",
+                   prof.TotalMs, prof.Commands,
+                   prof.Phase[STARTUP_ENUMERATE].DurationMs);
+            \endcode
+            \endif
+        **/
+        virtual void StartupProfile(mnStartupProfile &profile) = 0;
+
         bool Supported();
         /** \cond INTERNAL_DOC **/
 // Construction
@@ -7762,6 +7973,59 @@ Current unit storage.
         bool EnableReq() {
             return Outs.EnableReq();
         }
+
+        /**
+            \brief Refresh several values of this node from one sample.
+
+            \param[in] values The values to refresh, all of this node.
+            \param[in] count Number of entries in \a values.
+            \return Time stamp of the sample in milliseconds, on the
+            SysManager::TimeStampMsec time base.
+
+            Refreshing values one at a time waits a full round trip for
+            each, so the values come from different sample times. This
+            sends all of the reads back to back and waits for their
+            responses together, so the node answers them in one pass of the
+            ring. Every value is updated only if all of the reads succeed.
+
+            The values of strings are not read with the others and are
+            refreshed one at a time after the sample.
+
+            \if CPP
+            \CODE_SAMPLE_HDR
+            ValueBase *loopSet[] = { &myNode.Motion.PosnMeasured,
+                                     &myNode.Motion.VelMeasured,
+                                     &myNode.Motion.TrqMeasured,
+                                     &myNode.Status.RT };
+            double sampleMs = myNode.Snapshot(loopSet, 4);
+            \endcode
+            \endif
+
+            \remark A \ref _mnErr object is thrown if a value is not of this
+            node or a read fails. When a read fails none of the parameter
+            values are updated.
+        **/
+        double Snapshot(ValueBase *const values[], size_t count);
+
+        /**
+            \brief Refresh several values of this node from one sample.
+
+            \param[in] values The values to refresh, all of this node.
+            \return Time stamp of the sample in milliseconds.
+
+            \if CPP
+            \CODE_SAMPLE_HDR
+            double sampleMs = myNode.Snapshot({ &myNode.Motion.PosnMeasured,
+                                                &myNode.Motion.VelMeasured,
+                                                &myNode.Status.RT });
+            \endcode
+            \endif
+
+            \see Snapshot(ValueBase *const [], size_t)
+        **/
+        double Snapshot(const std::vector<ValueBase *> &values) {
+            return Snapshot(values.empty() ? NULL : &values[0], values.size());
+        }
     protected:
         /** \cond INTERNAL_DOC **/
 // Construction
@@ -7892,6 +8156,8 @@ Current unit storage.
         portSpec m_ports[NET_CONTROLLER_MAX];
         // Count specified from last PortsOpen call
         size_t m_portOpenCount;
+        // Lock process memory when the ports open
+        bool m_memLockAtOpen;
 
         // Constructor
         SysManager();
@@ -8017,6 +8283,113 @@ Current unit storage.
         */
         void PortsOpen(int portCount);
 
+        /**
+            \brief Set the real-time scheduling for a class of library threads.
+
+            \param[in] role The library threads to configure.
+            \param[in] spec Scheduling policy, real-time priority and CPU mask.
+
+            The setup is applied as each thread of the \a role starts, so
+            call this before PortsOpen. Threads run at the creator's
+            scheduling by default. If the process lacks the privilege for a
+            real-time policy, such as CAP_SYS_NICE or an RLIMIT_RTPRIO
+            allowance, the threads keep running at their inherited
+            scheduling.
+
+            \remark A \ref _mnErr object is thrown if the role, policy or
+            priority is invalid.
+
+            \if CPP
+            \CODE_SAMPLE_HDR
+            // Run the serial reader at FIFO priority 80 on CPU 2
+            myMgr->ThreadRealtime(THREAD_ROLE_SERIAL_READER,
+                                  threadRtSpec(SCHED_FIFO, 80, 1 << 2));
+            myMgr->PortsOpen(1);
+            \endcode
+            \endif
+        **/
+        void ThreadRealtime(threadRoles role, const threadRtSpec &spec);
+
+        /**
+            \brief Lock the process memory when the ports open.
+
+            \param[in] lockAtOpen Set true to lock all current and future
+            pages of the process in memory at PortsOpen.
+
+            This prevents page faults from adding latency to the library
+            threads. If the lock is refused the ports still open normally.
+        **/
+        void MemoryLockAtOpen(bool lockAtOpen);
+
+        /**
+            \brief Set the bounds of the command response time-outs.
+
+            \param[in] floorMs Shortest time-out a node may earn, 0 to
+            always wait \a ceilingMs.
+            \param[in] ceilingMs Longest time-out, used for every command
+            that may run long.
+
+            Parameter reads and short control commands wait for a time-out
+            learned from the round trips recently measured to their node,
+            so a node that stops answering is found without waiting the full
+            \a ceilingMs. Resets, parameter writes and node specific
+            commands always wait \a ceilingMs. The defaults are 100 and
+            1125 ms.
+
+            \remark A \ref _mnErr object is thrown if \a ceilingMs is zero
+            or less than \a floorMs.
+        **/
+        void ResponseTimeouts(size_t floorMs, size_t ceilingMs);
+
+        /**
+            \brief Set the scheduling class of the calling thread's
+            commands.
+
+            \param[in] newClass Class for the commands this thread sends.
+            \return The thread's previous class.
+
+            When more commands are waiting than the ring has room for, the
+            commands of the more urgent classes are sent first. Node stops
+            and triggers always go first, and motion commands are never
+            less urgent than CMD_CLASS_MOTION. A thread sending bulk work,
+            such as periodic status logging, can use CMD_CLASS_BULK to stay
+            out of the way of the rest of the application.
+
+            The time commands of each class waited is kept in the
+            LATENCY_QUEUE histograms, see IPortAdv::LatencyStats.
+        **/
+        cmdClasses CommandClass(cmdClasses newClass);
+
+        /**
+            \brief Keep node parameters in a file between starts.
+
+            \param[in] path Cache file path, NULL or empty to stop caching.
+
+            The read only identity and capability values of each node are
+            saved, keyed by the node's serial number, firmware version and
+            device ID. When PortsOpen, RestartWarm or RestartCold finds a node
+            already in the file, a few reads confirm its identity and those
+            values come from the file instead of the node. Settings are always
+            read from the node, as another program may have changed them.
+            The file is updated as nodes are found and when the ports close.
+
+            Call this before PortsOpen. A missing or unreadable file starts
+            an empty cache.
+        **/
+        void ParameterCacheFile(const char *path);
+
+        /**
+            \brief Write the startup phases to the command trace.
+
+            \param[in] enable Set to write a marker record to the trace of
+            each port as each of its startup phases ends.
+
+            The marks carry the phase, node, duration and command count of
+            IPortAdv::StartupProfile, so the phases can be lined up with the
+            commands they sent.
+        **/
+        void StartupProfileTrace(bool enable);
+
         /**
             \brief Close all operations down and close the ports.
 
@@ -29,6 +29,7 @@
 #include "SerialEx.h"
 #include "SerialLinux.h"
 
+#include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
@@ -36,7 +37,8 @@
 #include <string.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <termios.h>
 #include <signal.h>
 
@@ -103,8 +105,8 @@ void sigHandler(int signo, siginfo_t *info, void *context) {
 //  SYNOPSIS:
 CSerial::SERAPI_ERR CSerial::CancelCommIo(void) {
     SERAPI_ERR retErr;
-    // Cancel pending I/O
-    // ... TODO?
+    // Cancel pending I/O by releasing any blocked reader
+    WakeReader();
     // Kill buffers
     retErr = Purge();
     return (retErr);
@@ -154,6 +156,17 @@ CSerial::CSerial()
       m_hFile(INVALID_HANDLE),
       m_eEvent(EEventNone),
       m_dwEventMask(0) {
+    struct epoll_event evt;
+    // The wake and event descriptors outlive the port so the reader and
+    // event threads can block on them before the port is opened.
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    m_commEvtFd = eventfd(0, EFD_CLOEXEC);
+    assert(m_epollFd != INVALID_HANDLE && m_wakeFd != INVALID_HANDLE
+           && m_commEvtFd != INVALID_HANDLE);
+    evt.events = EPOLLIN;
+    evt.data.fd = m_wakeFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &evt);
 #if TRACE_THREAD
     _RPTF0(_CRT_WARN, "CSerial::CSerial (created)\n");
 #endif
@@ -164,6 +177,9 @@ CSerial::~CSerial() {
     if (m_hFile != INVALID_HANDLE) {
         Close();
     }
+    close(m_commEvtFd);
+    close(m_wakeFd);
+    close(m_epollFd);
 #if TRACE_THREAD
     _RPTF0(_CRT_WARN, "CSerial::~CSerial (destroyed)\n");
 #endif
@@ -212,6 +228,14 @@ CSerial::SERAPI_ERR CSerial::Open(
         fputs(m_lastErrMsg, stderr);
         return (API_ERROR_INVALID_HANDLE);
     }
+    // Add the port to the read readiness set
+    struct epoll_event evt;
+    evt.events = EPOLLIN;
+    evt.data.fd = m_hFile;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_hFile, &evt);
+    // Discard any wake left over from a previous session
+    eventfd_t stale;
+    eventfd_read(m_wakeFd, &stale);
     // set new port settings for non-canonical input processing  //must be NOCTTY
     tcgetattr(m_hFile, &tio);
     cfmakeraw(&tio);
@@ -272,10 +296,9 @@ CSerial::SERAPI_ERR CSerial::Close(void) {
     }
     // Insure all open work has stopped
     CancelCommIo();
-    // Yield quanta now to let it happen
-    usleep(10000);
 
     // Close COM port
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, m_hFile, NULL);
     close(m_hFile);
     m_hFile = INVALID_HANDLE;
 
@@ -477,8 +500,8 @@ CSerial::SERAPI_ERR CSerial::SetEventMask(DWORD dwEventMask) {
 /**
     Initiate the wait for the specified serial communications event(s).
 
-    This could be implemented via polling or other operating system
-    event support for responsive reactions.
+    The caller blocks until an event is posted via ForceCommEvent. There
+    is no periodic poll, so a posted break is seen immediately.
 
     Note: For POSIX style platforms, only the break is detected (TODO)
 
@@ -486,13 +509,50 @@ CSerial::SERAPI_ERR CSerial::SetEventMask(DWORD dwEventMask) {
 **/
 //  SYNOPSIS:
 CSerial::SERAPI_ERR CSerial::CommEventWaitInitiate() {
-    // TODO: Find and post events in m_eEvent
-    usleep(100000);
+    eventfd_t nPosted;
+    while (eventfd_read(m_commEvtFd, &nPosted) < 0) {
+        if (errno != EINTR) {
+            return (CSerial::SERAPI_ERR)errno;
+        }
+    }
     return API_ERROR_SUCCESS;
 }
 //
 //*****************************************************************************
 
+//*****************************************************************************
+//  NAME
+//      CSerial::ForceCommEvent
+//
+//  DESCRIPTION:
+/**
+    Post a communications event, releasing the thread waiting in
+    CommEventWaitInitiate.
+**/
+//  SYNOPSIS:
+void CSerial::ForceCommEvent() {
+    m_commEvent.SetEvent();
+    eventfd_write(m_commEvtFd, 1);
+}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//  NAME
+//      CSerial::WakeReader
+//
+//  DESCRIPTION:
+/**
+    Release a thread blocked in Read. The read returns API_ERROR_TIMEOUT
+    so the caller can test for termination without polling.
+**/
+//  SYNOPSIS:
+void CSerial::WakeReader() {
+    eventfd_write(m_wakeFd, 1);
+}
+//
+//*****************************************************************************
+
 //*****************************************************************************
 //  NAME                                                                      *
 //      CSerial::GetEventType
@@ -581,7 +641,7 @@ CSerial::SERAPI_ERR CSerial::Write(const void *pData, size_t iLen,
     \param pdwRead[out] The number of characters actually read into
     \a pData.
     \param dwTimeoutMS[in] Maximum time to wait for characters to
-    arrive.
+    arrive. A WakeReader call ends the wait early.
 
     \return API_ERROR_SUCCESS(0) if read was successful and \a pData was
     filled with \a pdwRead characters.
@@ -607,36 +667,19 @@ CSerial::SERAPI_ERR CSerial::Read(
         return API_ERROR_INVALID_HANDLE;
     }
 
-//  printf("about to read serial port\n");
-    fd_set r_fds;
-    FD_ZERO(&r_fds);
-    FD_SET(m_hFile, &r_fds);
-    ssize_t ret = -1;
-    if (dwTimeoutMS == INFINITE) {
-        ret = select(m_hFile + 1, &r_fds, NULL, NULL, NULL);
-    }
-    else {
-        struct timeval tv;
-        tv.tv_sec = 0;
-        tv.tv_usec = dwTimeoutMS * 1000;
-        ret = select(m_hFile + 1, &r_fds, NULL, NULL, &tv);
-    }
+    // Wait for the port or a wake request to become readable
+    struct epoll_event evts[2];
+    int timeoutMS = (dwTimeoutMS == INFINITE) ? -1 : int(dwTimeoutMS);
+    int nEvts;
+    do {
+        nEvts = epoll_wait(m_epollFd, evts, 2, timeoutMS);
+    } while (nEvts < 0 && errno == EINTR);
 
-    if (ret && FD_ISSET(m_hFile, &r_fds)) {
-        ret = read(m_hFile, pData, iLen);
-        if (ret == -1) {
-            m_lLastError = (CSerial::SERAPI_ERR)errno;      // Set the internal error code
-            return (CSerial::SERAPI_ERR)errno;
-        }
-        else if (ret >= 0) {
-            *pdwRead = ret;
-        }
-    }
-    else if (ret == 0) {
+    if (nEvts == 0) {
         m_lLastError = API_ERROR_TIMEOUT;
         return API_ERROR_TIMEOUT;
     }
-    else {
+    if (nEvts < 0) {
         m_lLastError = (CSerial::SERAPI_ERR)errno;      // Set the internal error code
         snprintf(m_lastErrMsg, sizeof(m_lastErrMsg),
                  "CSerial::Read - Unable to read the data err=%d\n",
@@ -644,6 +687,27 @@ CSerial::SERAPI_ERR CSerial::Read(
         fputs(m_lastErrMsg, stderr);
         return (CSerial::SERAPI_ERR)errno;
     }
+
+    bool portReady = false;
+    for (int i = 0; i < nEvts; i++) {
+        if (evts[i].data.fd == m_hFile) {
+            portReady = true;
+        }
+    }
+    // Woken without data, consume the wake and report it as a time-out
+    if (!portReady) {
+        eventfd_t nWakes;
+        eventfd_read(m_wakeFd, &nWakes);
+        m_lLastError = API_ERROR_TIMEOUT;
+        return API_ERROR_TIMEOUT;
+    }
+
+    ssize_t ret = read(m_hFile, pData, iLen);
+    if (ret == -1) {
+        m_lLastError = (CSerial::SERAPI_ERR)errno;      // Set the internal error code
+        return (CSerial::SERAPI_ERR)errno;
+    }
+    *pdwRead = ret;
     return API_ERROR_SUCCESS;
 }
 //
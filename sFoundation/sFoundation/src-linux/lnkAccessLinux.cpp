@@ -108,23 +108,28 @@ UserDefaults userSettings;
 ///     resolution. This is used to time stamp the log files and provide
 ///     time-out facilities.
 ///
+///     The time runs on the monotonic clock from when the library loaded so
+///     wall clock adjustments cannot make intervals negative.
+///
 ///     \return double count in milliseconds
 //
 //  SYNOPSIS:
+static Uint64 coreTimeBase() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return Uint64(now.tv_sec) * 1000000000ULL + Uint64(now.tv_nsec);
+}
+
+Uint64 CoreTimeBaseNs = coreTimeBase();
+
 MN_EXPORT double MN_DECL infcCoreTime(void) {
+    return (coreNsToMs(coreTimeNs()));
+}
 
-    static double initial = 0;
-    struct timespec now;
-    if (clock_gettime(CLOCK_REALTIME, &now) == -1) {
-        return (0);
-    }
-    double tNow = double(now.tv_sec) * 1000 + double(now.tv_nsec) * 1e-6
-                  - initial;
-    if (!initial) {
-        initial = tNow;
-    }
 
-    return (tNow);
+// Same time base as infcCoreTime in integer nanoseconds
+MN_EXPORT Uint64 MN_DECL infcCoreTimeNs(void) {
+    return (coreTimeNs());
 }
 //                                                                             *
 //******************************************************************************
@@ -299,14 +304,14 @@ MN_EXPORT cnErrCode MN_DECL infcGetHubPorts(std::vector<std::string> &comHubPort
     comHubPorts.clear();
     FILE *pfd = popen("ls /dev/ttyXRUSB*", "r");
 
-    if (pfd <= 0) {
+    if (pfd == NULL) {
         throw std::runtime_error("Command or process could not be executed.");
     }
 
     while (!feof(pfd)) {
         char buf[ 1024 ] = {0};
 
-        if (fgets(buf, sizeof(buf), pfd) > 0) {
+        if (fgets(buf, sizeof(buf), pfd) != NULL) {
             std::string str(buf);
             // TODO: check the VID/PID of the device using udevadm/libudev to
             // verify that this is a Teknic SC4-Hub (vid=2890, pid=0213)
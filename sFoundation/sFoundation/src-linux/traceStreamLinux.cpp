@@ -0,0 +1,551 @@
+//******************************************************************************
+// $Workfile: traceStreamLinux.cpp $
+//
+// DESCRIPTION:
+/**
+    \file
+    \brief Streaming command trace for Linux
+
+    Drains the command trace rings of a port into a rotating set of memory
+    mapped files laid out as trace dumps.
+**/
+// CREATION DATE:
+//  10/16/2026
+//
+// COPYRIGHT NOTICE:
+//  (C)Copyright 2026  Teknic, Inc.  All rights reserved.
+//
+//  This copyright notice must be reproduced in any copy, modification,
+//  or portion thereof merged into another program. A copy of the
+//  copyright notice must be included in the object library of a user
+//  program.
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  traceStreamLinux.cpp headers
+//
+// Our driver headers
+#include "traceStream.h"
+#include "mnErrors.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  traceStreamLinux.cpp constants
+//
+// Set to 1 to trace stream file activity
+#define TRACE_STREAM_DBG    0
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  traceStreamLinux.cpp function prototypes
+//
+// Serializes starting and stopping streams
+static CCCriticalSection streamLock;
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  traceStreamLinux.cpp imported references
+//
+extern mnNetInvRecords SysInventory[NET_CONTROLLER_MAX];
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      traceExpand
+//
+//  DESCRIPTION:
+//      Select the slot expansion for the ring type.
+//
+//  SYNOPSIS:
+static inline void traceExpand(const rxTraceSlot &slot, rxTraceBuf &rec) {
+    infcTraceRxExpand(slot, rec);
+}
+
+static inline void traceExpand(const txTraceSlot &slot, txTraceBuf &rec) {
+    infcTraceTxExpand(slot, rec);
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      traceStream::traceStream construction and destruction
+//
+//  DESCRIPTION:
+/**
+    Construct an idle stream for port \a cNum. The destructor stops the
+    thread and closes the current file.
+**/
+//  SYNOPSIS:
+traceStream::traceStream(netaddr cNum) :
+    m_cNum(cNum),
+    m_fileRecs(TRACE_STREAM_RECS_DEF),
+    m_fileCount(TRACE_STREAM_FILES_DEF),
+    m_fileNum(0),
+    m_fd(-1),
+    m_map(NULL),
+    m_mapLen(0),
+    m_nRX(0), m_nTX(0),
+    m_rxNext(0), m_txNext(0),
+    m_rxStall(0), m_txStall(0),
+    m_lastSync(0),
+    Dropped(0) {
+    m_dir[0] = 0;
+    m_wake.ResetEvent();
+}
+
+traceStream::~traceStream() {
+    // Insure we exit
+    Terminate();
+    WaitForTerm();
+    closeFile();
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      traceStream::Start
+//
+//  DESCRIPTION:
+/**
+    Open the first file in \a dirPath, or the dump directory if NULL or
+    empty, and start the flusher. The records still held in the trace rings
+    are the first ones streamed.
+
+    \param[in] dirPath Directory for the files.
+    \param[in] fileRecs Records per direction in each file.
+    \param[in] fileCount Files in the rotation.
+    \return MN_OK if the first file was created
+**/
+//  SYNOPSIS:
+cnErrCode traceStream::Start(const char *dirPath, Uint32 fileRecs,
+                             Uint32 fileCount) {
+    mnNetInvRecords &theNet = SysInventory[m_cNum];
+    cnErrCode theErr;
+    size_t len;
+    Uint32 serNum;
+
+    if (dirPath && dirPath[0]) {
+        strncpy(m_dir, dirPath, sizeof(m_dir) - 2);
+        m_dir[sizeof(m_dir) - 2] = 0;
+        len = strlen(m_dir);
+        if (m_dir[len - 1] != '/') {
+            m_dir[len] = '/';
+            m_dir[len + 1] = 0;
+        }
+        if (mkdir(m_dir, 0755) != 0 && errno != EEXIST) {
+            return (MN_ERR_OS);
+        }
+    }
+    else {
+        infcGetDumpDir(m_dir, sizeof(m_dir));
+    }
+    m_fileRecs = fileRecs;
+    m_fileCount = fileCount;
+    m_fileNum = 0;
+
+    // Start with what the rings still hold
+    serNum = theNet.respSerNum;
+    m_rxNext = serNum - (serNum < RECV_DEPTH ? serNum : RECV_DEPTH);
+    serNum = theNet.sendSerNum;
+    m_txNext = serNum - (serNum < SEND_DEPTH ? serNum : SEND_DEPTH);
+
+    theErr = openFile();
+    if (theErr != MN_OK) {
+        return (theErr);
+    }
+    m_lastSync = infcCoreTime();
+    LaunchThread(this);
+    return (MN_OK);
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      traceStream::openFile
+//
+//  DESCRIPTION:
+/**
+    Create the next file in the rotation at full size and map it. The
+    header is written now and kept current as records arrive.
+
+    \return MN_OK if the file is ready
+**/
+//  SYNOPSIS:
+cnErrCode traceStream::openFile() {
+    char fPath[MAX_PATH];
+    void *pMap;
+
+    snprintf(fPath, sizeof(fPath), "%sMNtrace%d-%u.dat", m_dir, m_cNum,
+             m_fileNum);
+    m_fd = open(fPath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) {
+        return (MN_ERR_OS);
+    }
+    m_mapLen = sizeof(traceHeader)
+               + size_t(m_fileRecs) * (sizeof(rxTraceBuf) + sizeof(txTraceBuf));
+    // Extending the file leaves the record areas zero
+    pMap = MAP_FAILED;
+    if (ftruncate(m_fd, m_mapLen) == 0) {
+        pMap = mmap(NULL, m_mapLen, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    m_fd, 0);
+    }
+    if (pMap == MAP_FAILED) {
+        close(m_fd);
+        m_fd = -1;
+        return (MN_ERR_OS);
+    }
+#if TRACE_STREAM_DBG
+    _RPT2(_CRT_WARN, "%.1f traceStream: opened %s\n", infcCoreTime(), fPath);
+#endif
+    m_map = (Uint8 *)pMap;
+    m_nRX = m_nTX = 0;
+    infcTraceHeaderFill(m_cNum, *header());
+    header()->traceLen = m_fileRecs;
+    updateHeader();
+    return (MN_OK);
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      traceStream::updateHeader
+//
+//  DESCRIPTION:
+/**
+    Keep the header describing a valid dump while the file is open. The
+    RX area is reported at full size so the TX records are found where
+    they are written.
+**/
+//  SYNOPSIS:
+void traceStream::updateHeader() {
+    traceHeader *pHdr = header();
+
+    pHdr->nRXrecords = m_fileRecs;
+    pHdr->nextRXrecord = m_nRX ? m_nRX - 1 : 0;
+    pHdr->nTXrecords = m_nTX;
+    pHdr->nextTXrecord = m_nTX ? m_nTX - 1 : 0;
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      traceStream::closeFile
+//
+//  DESCRIPTION:
+/**
+    Move the TX records down to the last RX record, trim the file to the
+    records written and advance to the next file number.
+**/
+//  SYNOPSIS:
+void traceStream::closeFile() {
+    traceHeader *pHdr;
+    size_t usedLen;
+
+    if (!m_map) {
+        return;
+    }
+    pHdr = header();
+    if (m_nRX < m_fileRecs) {
+        memmove(rxRecs() + m_nRX, txRecs(), m_nTX * sizeof(txTraceBuf));
+    }
+    pHdr->nRXrecords = m_nRX;
+    usedLen = sizeof(traceHeader) + m_nRX * sizeof(rxTraceBuf)
+              + m_nTX * sizeof(txTraceBuf);
+    munmap(m_map, m_mapLen);
+    m_map = NULL;
+    if (ftruncate(m_fd, usedLen) != 0) {
+        _RPT1(_CRT_WARN, "traceStream: trim failed, errno=%d\n", errno);
+    }
+    close(m_fd);
+    m_fd = -1;
+    m_fileNum = (m_fileNum + 1) % m_fileCount;
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      traceStream::drainRing
+//
+//  DESCRIPTION:
+/**
+    Expand the completed records of one ring from serial number \a next up
+    to \a serNum into \a recs until the file area fills.
+
+    A slot that is claimed but not yet complete stops the drain for a few
+    passes so records stay in order. Slots the ring has lapped, or that
+    were claimed while tracing was off, are counted in #Dropped.
+**/
+//  SYNOPSIS:
+template<class slotT, class recT>
+void traceStream::drainRing(const slotT *ring, Uint32 depth, Uint32 serNum,
+                            Uint32 &next, unsigned &stall, Uint32 &nRecs,
+                            recT *recs) {
+    nodebool traceOn = SysInventory[m_cNum].TraceActive;
+
+    // Records overwritten before we reached them are lost
+    if (serNum - next > depth) {
+        Dropped += serNum - next - depth;
+        next = serNum - depth;
+    }
+    while (next != serNum && nRecs < m_fileRecs) {
+        slotT slot;
+        int32 lap = -1;                 // <0 not yet written, >0 lapped
+
+        if (traceSlotRead(ring[next % depth], slot)) {
+            lap = int32(traceSlotSerial(slot.seq) - next);
+        }
+        if (lap == 0) {
+            traceExpand(slot, recs[nRecs++]);
+        }
+        else if (lap < 0 && traceOn && ++stall < TRACE_STREAM_STALL_MAX) {
+            // Writer still filling this one, try next pass
+            return;
+        }
+        else {
+            Dropped++;
+        }
+        stall = 0;
+        next++;
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      traceStream::drain
+//
+//  DESCRIPTION:
+/**
+    Move the newly completed ring records into the current file, rotating
+    files as they fill, and periodically schedule the write back.
+**/
+//  SYNOPSIS:
+void traceStream::drain() {
+    mnNetInvRecords &theNet = SysInventory[m_cNum];
+
+    for (;;) {
+        if (!m_map && openFile() != MN_OK) {
+            return;
+        }
+        drainRing(theNet.rxTraces, RECV_DEPTH, theNet.respSerNum,
+                  m_rxNext, m_rxStall, m_nRX, rxRecs());
+        drainRing(theNet.txTraces, SEND_DEPTH, theNet.sendSerNum,
+                  m_txNext, m_txStall, m_nTX, txRecs());
+        updateHeader();
+        if (m_nRX < m_fileRecs && m_nTX < m_fileRecs) {
+            break;
+        }
+        closeFile();
+    }
+    if (infcCoreTime() - m_lastSync >= TRACE_STREAM_SYNC_MS) {
+        msync(m_map, m_mapLen, MS_ASYNC);
+        m_lastSync = infcCoreTime();
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      traceStream::Run
+//
+//  DESCRIPTION:
+/**
+    Flusher thread. Drain the rings every #TRACE_STREAM_FLUSH_MS until
+    terminated, then pick up the tail and close the file.
+
+    \return 0
+**/
+//  SYNOPSIS:
+int traceStream::Run(void *context) {
+    while (!*m_pTermFlag) {
+        m_wake.WaitFor(TRACE_STREAM_FLUSH_MS);
+        drain();
+    }
+    drain();
+    closeFile();
+    return (0);
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      traceStream::Terminate
+//
+//  DESCRIPTION:
+/**
+    Insure the thread exits in a timely manner.
+
+    \return handle/ptr to thread
+**/
+//  SYNOPSIS:
+void *traceStream::Terminate() {
+    *m_pTermFlag = true;
+    m_wake.SetEvent();
+    return (CThread::Terminate());
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      infcTraceStreamStart
+//
+//  DESCRIPTION:
+/**
+    Stream the command trace of port \a cNum to a rotating set of trace
+    files in \a dirPath. Each file uses the trace dump layout. Any stream
+    already running on the port is stopped first.
+
+    \param[in] cNum Channel number. The first channel is zero.
+    \param[in] dirPath Directory for the files, NULL for the dump directory.
+    \param[in] fileRecords Records per direction in each file, 0 for the
+    default.
+    \param[in] fileCount Files in the rotation, 0 for the default.
+    \return #cnErrCode; MN_OK if streaming started
+**/
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL infcTraceStreamStart(
+    netaddr cNum,
+    const char *dirPath,
+    nodeulong fileRecords,
+    nodeulong fileCount) {
+    cnErrCode theErr;
+
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return (MN_ERR_DEV_ADDR);
+    }
+    if (fileRecords == 0) {
+        fileRecords = TRACE_STREAM_RECS_DEF;
+    }
+    if (fileCount == 0) {
+        fileCount = TRACE_STREAM_FILES_DEF;
+    }
+    if (fileRecords < TRACE_STREAM_RECS_MIN) {
+        return (MN_ERR_BADARG);
+    }
+    mnNetInvRecords &theNet = SysInventory[cNum];
+    streamLock.Lock();
+    // The rings are created on the first open of the port
+    if (!theNet.txTraces || !theNet.rxTraces) {
+        streamLock.Unlock();
+        return (MN_ERR_CLOSED);
+    }
+    delete theNet.pTraceStream;
+    theNet.pTraceStream = new traceStream(cNum);
+    theErr = theNet.pTraceStream->Start(dirPath, fileRecords, fileCount);
+    if (theErr != MN_OK) {
+        delete theNet.pTraceStream;
+        theNet.pTraceStream = NULL;
+    }
+    streamLock.Unlock();
+    return (theErr);
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      infcTraceStreamStop
+//
+//  DESCRIPTION:
+/**
+    Stop streaming the command trace of port \a cNum, writing out the
+    records still in the rings and closing the current file.
+
+    \param[in] cNum Channel number. The first channel is zero.
+    \param[out] pDropped Records lost since the stream started, or NULL.
+    \return #cnErrCode; MN_OK if a stream was stopped
+**/
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL infcTraceStreamStop(
+    netaddr cNum,
+    nodeulong *pDropped) {
+    cnErrCode theErr = MN_OK;
+
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return (MN_ERR_DEV_ADDR);
+    }
+    mnNetInvRecords &theNet = SysInventory[cNum];
+    streamLock.Lock();
+    if (theNet.pTraceStream) {
+        traceStream *pStream = theNet.pTraceStream;
+        theNet.pTraceStream = NULL;
+        // Terminate drains the tail before we read the count
+        pStream->Terminate();
+        if (pDropped) {
+            *pDropped = pStream->Dropped;
+        }
+        delete pStream;
+    }
+    else {
+        theErr = MN_ERR_CLOSED;
+    }
+    streamLock.Unlock();
+    return (theErr);
+}
+//                                                                             *
+//******************************************************************************
+
+
+//==============================================================================
+//  END OF FILE traceStreamLinux.cpp
+//==============================================================================
@@ -71,7 +71,13 @@
 // The time-out is a balance of timing between excessive read thread processing
 // and the ability to close down the port at the end of port use. This time
 // will most likely be added to the destruction time of this object.
-#define READ_TIME_OUT_MS  200
+// POSIX reads are released by WakeReader on termination, so they block until
+// characters arrive.
+#if (defined(_WIN32)||defined(_WIN64))
+    #define READ_TIME_OUT_MS  200
+#else
+    #define READ_TIME_OUT_MS  INFINITE
+#endif
 
 // Print ID in platform normal way
 #ifdef __unix
@@ -120,8 +126,8 @@ CSerialEx::CSerialEx() {
 #if TRACE_THREAD || TRACE_DESTRUCT
     _RPT0(_CRT_WARN, "CSerialEx constructing\n");
 #endif
-    m_AppPacketAvailable = false;
     m_nCharsRX = m_nCharsTX = 0;
+    m_nCharsSeen = 0;
 
     // Insure all buffers look empty
     m_lowInProcPacket.Byte.BufferSize = 0;
@@ -140,6 +146,8 @@ CSerialEx::CSerialEx() {
 
     PacketParseReset();
     m_pUserCommInterrupt = NULL;
+    m_pPktHookReg = NULL;
+    m_pktHookInUse = 0;
 
     // Create our event engine
     m_pSerialEvts = new CSerialEvt(this);
@@ -164,7 +172,7 @@ CSerialEx::~CSerialEx() {
         m_pSerialEvts = NULL;
     }
     // Kill the character read thread
-    CThread::Terminate();
+    Terminate();
     m_responsePacketWaiting.SetEvent();
     // Cancel pending OS I/O
     CancelCommIo();
@@ -178,13 +186,8 @@ CSerialEx::~CSerialEx() {
 #endif
     Close();
     // Kill any packets we have outstanding
-    m_SendPacketToAppLock.Lock();
-    for (size_t i = 0; m_finishedPackets.size(); i++) {
-        packetbuf *buf = m_finishedPackets.front();
-        m_finishedPackets.pop_front();
-        delete buf;
-    }
-    m_SendPacketToAppLock.Unlock();
+    m_finishedPackets.discard();
+    delete m_pPktHookReg;
 #if TRACE_THREAD || TRACE_DESTRUCT
     _RPT1(_CRT_WARN, "%.1f CSerialEx (destroyed)\n", infcCoreTime());
 #endif
@@ -249,6 +252,30 @@ CSerial::SERAPI_ERR CSerialEx::Close(void) {
 //*****************************************************************************
 
 
+//*****************************************************************************
+//  NAME                                                                      *
+//      CSerialEx::Terminate
+//
+//  DESCRIPTION:
+///     Override CThread termination logic. The read thread blocks in Read
+///     without a time-out, so post the flag and wake it before joining.
+///
+///     \return handle/ptr to thread
+//
+//  SYNOPSIS:
+HANDLE CSerialEx::Terminate() {
+    if (m_pTermFlag) {
+        *m_pTermFlag = true;
+    }
+#if !(defined(_WIN32)||defined(_WIN64))
+    WakeReader();
+#endif
+    return CThread::Terminate();
+}
+//                                                                            *
+//*****************************************************************************
+
+
 //*****************************************************************************
 //  NAME                                                                      *
 //      CSerialEx::TerminateAndWait
@@ -264,7 +291,7 @@ CSerial::SERAPI_ERR CSerialEx::Close(void) {
 //  SYNOPSIS:
 void CSerialEx::TerminateAndWait() {
     // Set terminate flag and release all waiting objects
-    CThread::Terminate();
+    Terminate();
     // Cancel any pending I/O
     CancelCommIo();
     // Setup for our specific cleanup, allow any external waiters to go
@@ -304,6 +331,7 @@ CSerial::EPort CSerialEx::StartListener(void) {
           infcCoreTime());
 #endif
     // Launch with elevated priority to insure responsiveness
+    SetRole(THREAD_ROLE_SERIAL_READER);
     LaunchThread(this, 1);
 #if TRACE_THREAD
     _RPT1(_CRT_WARN, "%.1f CSerialEx::StartListener launched...\n",
@@ -340,7 +368,7 @@ LONG CSerialEx::StopListener(
 #if TRACE_THREAD
     _RPT1(_CRT_WARN, "%.1f CSerial::StopListener...\n", infcCoreTime());
 #endif
-    CThread::Terminate();
+    Terminate();
     // Insure we release external waiters
     m_responsePacketWaiting.SetEvent();
     m_commEvent.SetEvent();
@@ -422,6 +450,176 @@ bool CSerialEx::TestAndPushHiPacket(char nextChar) {
 //*****************************************************************************
 
 
+// Header and checksum octets surrounding the payload
+#define PKT_OVERHEAD_LEN (MN_API_PACKET_HDR_LEN+MN_API_PACKET_TAIL_LEN)
+
+//*****************************************************************************
+//  NAME                                                                      *
+//      FindStartOfPacket
+//
+//  DESCRIPTION:
+///     Locate the first octet with the start of packet bit set, testing
+///     eight octets per step on little-endian hosts.
+///
+///     \param pChars[in] Octets to scan.
+///     \param nChars[in] Number of octets at \a pChars.
+///     \return Index of the first start of packet octet, else \a nChars.
+//
+//  SYNOPSIS:
+static inline size_t FindStartOfPacket(const char *pChars, size_t nChars) {
+    size_t i = 0;
+#if defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    for (; i + sizeof(Uint64) <= nChars; i += sizeof(Uint64)) {
+        Uint64 word;
+        memcpy(&word, pChars + i, sizeof(word));
+        word &= 0x8080808080808080ULL;
+        if (word) {
+            return i + (CClowestBit(word) >> 3);
+        }
+    }
+#endif
+    for (; i < nChars; i++) {
+        if (MN_API_IS_START_PKT(pChars[i])) {
+            return i;
+        }
+    }
+    return nChars;
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//*****************************************************************************
+//  NAME                                                                      *
+//      CSerialEx::FinishLowPacket / FinishHiPacket
+//
+//  DESCRIPTION:
+///     Complete the in-process packet once its checksum octet has been
+///     accumulated. Good packets are sent to the application and bad ones
+///     generate a checksum error. The high priority version returns the
+///     parser to the interrupted state.
+//
+//  SYNOPSIS:
+void CSerialEx::FinishLowPacket() {
+    // Non-zero means corruption
+    if (m_lowChecksum & 0x7F) {
+        // Checksum Error!
+        SendErrToApp(ND_ERRNET_CHKSUM, m_lowInProcPacket.Fld.Addr, 0);
+    }
+    else {
+        // Setup the character length
+        m_lowInProcPacket.Byte.BufferSize = m_lowPrioPktIndx;
+#if TRACE_LOW_LEVEL
+        DUMP_PKT("LO pkt", &m_lowInProcPacket);
+#endif
+        // Send the packet to app and wait until it reads it
+        SendPacketToApp(m_lowInProcPacket, true);
+    }
+    // We are done, go idle
+    m_state = READ_STATE_IDLE;
+}
+
+void CSerialEx::FinishHiPacket() {
+    // Non-zero means corruption
+    if (m_hiChecksum & 0x7F) {
+        // Checksum Error!
+        SendErrToApp(ND_ERRNET_CHKSUM, m_hiInProcPacket.Fld.Addr, 0);
+    }
+    else {
+        // Setup the character length
+        m_hiInProcPacket.Byte.BufferSize = m_hiPrioPktIndx;
+#if TRACE_LOW_LEVEL
+        DUMP_PKT("HI pkt", &m_hiInProcPacket);
+#endif
+        // Send the packet to app and wait until it reads it
+        SendPacketToApp(m_hiInProcPacket, true);
+    }
+    // Return to last processing state
+    m_state = m_pushedState;
+    m_pushedState = READ_STATE_IDLE;
+    m_hiPrioPktIndx = 0;
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//*****************************************************************************
+//  NAME                                                                      *
+//      CSerialEx::ProcessChunk
+//
+//  DESCRIPTION:
+///     Frame a block of received characters. Runs of stray octets and
+///     packet octets, the length octet included, are copied as spans; only
+///     start of packet octets go through the ProcessNextChar FSM, which
+///     keeps the fragment and high priority interleave rules in one place.
+///
+///     \param pChunk[in] Received characters.
+///     \param nChars[in] Number of characters at \a pChunk.
+//
+//  SYNOPSIS:
+void CSerialEx::ProcessChunk(const char *pChunk, size_t nChars) {
+    const char *pEnd = pChunk + nChars;
+
+    while (pChunk < pEnd
+           && !((m_pTermFlag != NULL) && (*m_pTermFlag))
+           && !m_rdAutoFlush) {
+        size_t nLeft = size_t(pEnd - pChunk);
+        size_t nSpan;
+
+        if (m_state == READ_STATE_IDLE) {
+            // Everything up to the next start of packet is stray
+            nSpan = FindStartOfPacket(pChunk, nLeft);
+            if (nSpan) {
+#if TRACE_STRAY
+                _RPT1(_CRT_WARN, "READ_STATE_IDLE: %d strays\n", int(nSpan));
+#endif
+                // Max count of 127
+                m_strayCount = (m_strayCount + nSpan < 127)
+                               ? unsigned(m_strayCount + nSpan) : 127;
+                pChunk += nSpan;
+                continue;
+            }
+            ProcessNextChar(*pChunk++);
+            continue;
+        }
+
+        // Accumulating payload for the current packet
+        bool isHiPrio = inHighPrioState();
+        packetbuf &pkt = isHiPrio ? m_hiInProcPacket : m_lowInProcPacket;
+        unsigned &pktIndx = isHiPrio ? m_hiPrioPktIndx : m_lowPrioPktIndx;
+        unsigned &checksum = isHiPrio ? m_hiChecksum : m_lowChecksum;
+
+        // Stop after the length octet, the true length is known then
+        size_t nNeed = (pktIndx <= LEN_LOC)
+                       ? LEN_LOC + 1 - pktIndx
+                       : pkt.Fld.PktLen + PKT_OVERHEAD_LEN - pktIndx;
+        // A start of packet interrupts or fragments this one
+        nSpan = FindStartOfPacket(pChunk, (nNeed < nLeft) ? nNeed : nLeft);
+        if (nSpan == 0) {
+            ProcessNextChar(*pChunk++);
+            continue;
+        }
+
+        memcpy(&pkt.Byte.Buffer[pktIndx], pChunk, nSpan);
+        pktIndx += unsigned(nSpan);
+        for (const char *pSpanEnd = pChunk + nSpan; pChunk < pSpanEnd; pChunk++) {
+            checksum += *pChunk;
+        }
+        // Have we reached the checksum?
+        if (pktIndx >= pkt.Fld.PktLen + PKT_OVERHEAD_LEN) {
+            if (isHiPrio) {
+                FinishHiPacket();
+            }
+            else {
+                FinishLowPacket();
+            }
+        }
+    }
+}
+//                                                                            *
+//*****************************************************************************
+
+
 //*****************************************************************************
 //  NAME                                                                      *
 //      CSerialEx::ProcessNextChar
@@ -437,7 +635,7 @@ bool CSerialEx::TestAndPushHiPacket(char nextChar) {
 ///     Detailed description.
 //
 //  SYNOPSIS:
-inline void CSerialEx::ProcessNextChar(char nextChar) {
+void CSerialEx::ProcessNextChar(char nextChar) {
 #if TRACE_LOW_LEVEL
     _RPT2(_CRT_WARN, "ProcessNextChar(%d): char 0x%02x\n",
           m_state, nextChar);
@@ -496,30 +694,13 @@ inline void CSerialEx::ProcessNextChar(char nextChar) {
             if (TestAndPushHiPacket(nextChar)) {
                 break;
             }
-#define PKT_OVERHEAD_LEN (MN_API_PACKET_HDR_LEN+MN_API_PACKET_TAIL_LEN)
             // Accumulate characters and calculate the checksum
             m_lowInProcPacket.Byte.Buffer[m_lowPrioPktIndx++] = nextChar;
             m_lowChecksum += nextChar;
             // Have we reached the checksum?
             if (m_lowPrioPktIndx
                 >= m_lowInProcPacket.Fld.PktLen + PKT_OVERHEAD_LEN) {
-                // Non-zero means corruption
-                if (m_lowChecksum & 0x7F) {
-                    // Checksum Error!
-                    SendErrToApp(ND_ERRNET_CHKSUM,
-                                 m_lowInProcPacket.Fld.Addr, 0);
-                }
-                else {
-                    // Setup the character length
-                    m_lowInProcPacket.Byte.BufferSize = m_lowPrioPktIndx;
-#if TRACE_LOW_LEVEL
-                    DUMP_PKT("LO pkt", &m_lowInProcPacket);
-#endif
-                    // Send the packet to app and wait until it reads it
-                    SendPacketToApp(m_lowInProcPacket, true);
-                }
-                // We are done, go idle
-                m_state = READ_STATE_IDLE;
+                FinishLowPacket();
             }
             break;
         // --------------------------------------------------
@@ -535,25 +716,7 @@ inline void CSerialEx::ProcessNextChar(char nextChar) {
             // Have we reached the checksum?
             if (m_hiPrioPktIndx
                 >= m_hiInProcPacket.Fld.PktLen + PKT_OVERHEAD_LEN) {
-                // Non-zero means corruption
-                if (m_hiChecksum & 0x7F) {
-                    // Checksum Error!
-                    SendErrToApp(ND_ERRNET_CHKSUM,
-                                 m_hiInProcPacket.Fld.Addr, 0);
-                }
-                else {
-                    // Setup the character length
-                    m_hiInProcPacket.Byte.BufferSize = m_hiPrioPktIndx;
-#if TRACE_LOW_LEVEL
-                    DUMP_PKT("HI pkt", &m_hiInProcPacket);
-#endif
-                    // Send the packet to app and wait until it reads it
-                    SendPacketToApp(m_hiInProcPacket, true);
-                }
-                // Return to last processing state
-                m_state = m_pushedState;
-                m_pushedState = READ_STATE_IDLE;
-                m_hiPrioPktIndx = 0;
+                FinishHiPacket();
             }
             break;
         default:
@@ -583,9 +746,6 @@ inline void CSerialEx::ProcessNextChar(char nextChar) {
 //
 //  SYNOPSIS:
 int CSerialEx::Run(void *context) {
-    // Packet parsing current character
-    char thisChar;
-
     // Port event statististics
 #if TRACE_THREAD || TRACE_DESTRUCT
     _RPT2(_CRT_WARN,
@@ -641,6 +801,7 @@ int CSerialEx::Run(void *context) {
 
         // Store stuff if we had a successful read and not flushing
         if (m_readSize) {
+            m_nCharsSeen += m_readSize;
             if (!m_rdAutoFlush) {
                 // Make them available in the buffer
                 m_rdBuffer.makeAvailable(m_readSize);
@@ -659,18 +820,10 @@ int CSerialEx::Run(void *context) {
 #endif
         // Process any buffer items based on operational mode
         if (m_packetMode) {
-            // Process all the characters in our buffer
-            while (m_rdBuffer.getChar(thisChar)
-                   && !((m_pTermFlag != NULL) && (*m_pTermFlag))
-                   && !m_rdAutoFlush) {
-#ifdef _DEBUG
-                static bool dbg = false;
-                if (dbg) {
-                    _RPT1(_CRT_WARN, "chr=0x%02x\n", 0xff & thisChar);
-                }
-#endif
-                ProcessNextChar(thisChar);
-            }
+            // Frame all the characters in our buffer
+            const char *pChunk;
+            size_t nChunk = m_rdBuffer.getSpan(pChunk);
+            ProcessChunk(pChunk, nChunk);
             // Reset the buffer for next read
             m_rdBuffer.flush();
         }
@@ -802,27 +955,50 @@ void CSerialEx::SendPacketToApp(packetbuf &thePacket, BOOL Convert7To8Bit) {
     }
 #endif
     if (m_pUserCommInterrupt && !m_rdAutoFlush) {
-        // We are going to use this packet, stash it in heap
-        packetbuf *pkt = new packetbuf;
-        // Copy to internal buffer with proper conversion if required.
-        if (Convert7To8Bit) {
-            convert7to8(thePacket, *pkt);
+        // Hold off frees of the registration we are about to use
+        m_pktHookInUse = 1;
+        CCmemoryBarrier();
+        pktHookReg *pReg = m_pPktHookReg;
+        // Packets still queued were not offered to the hook, keep order
+        // with them by queueing this one too
+        if (pReg && !m_finishedPackets.empty()) {
+            pReg = NULL;
         }
-        else {
-            *pkt = thePacket;
+        // We are going to use this packet, fill the next ring slot in place
+        packetbuf *pkt = m_finishedPackets.claim();
+        packetbuf hookPkt;
+        bool consumed = false;
+        if (!pkt && pReg) {
+            // The hook may still consume it
+            pkt = &hookPkt;
+        }
+        if (pkt) {
+            // Copy to internal buffer with proper conversion if required.
+            if (Convert7To8Bit) {
+                convert7to8(thePacket, *pkt);
+            }
+            else {
+                *pkt = thePacket;
+            }
+            // Let the hook handle it here, the slot is reused if it does
+            consumed = pReg && (*pReg->pHook)(pReg->context, *pkt);
+        }
+        CCmemoryBarrier();
+        m_pktHookInUse = 0;
+        if (consumed) {
+            return;
         }
-        // Lock GetPkt state until we finish setup
-        m_SendPacketToAppLock.Lock();
-        // We want to actually send, queue to back
-        m_finishedPackets.push_back(pkt);
+        if (!pkt || pkt == &hookPkt) {
+            // Application is not keeping up, drop it
+            INCREMENT_ERRORCNT(m_ErrorReport.RXPKT_OVERFLOWcnt);
+            return;
+        }
+        m_finishedPackets.publish();
         // Tell application layer we have something new
-        m_AppPacketAvailable = true;
         m_responsePacketWaiting.SetEvent();
         if (m_pUserCommInterrupt) {
             m_pUserCommInterrupt->SetEvent();
         }
-        // Allow interactions with m_AppPacketAvailable & m_finishedPackets
-        m_SendPacketToAppLock.Unlock();
     }
     else {
         // Flush everything we have
@@ -897,38 +1073,35 @@ bool CSerialEx::GetPkt(packetbuf &buffer) {
         // Wait for one to show up or time-out
         if (m_responsePacketWaiting.WaitFor(FRAME_READ_TIMEOUT + 500)) {
             // Copy our buffer to the caller
-            m_SendPacketToAppLock.Lock();
 #if RECORD_PKT_DEPTH
-            if (m_finishedPackets.size() > m_maxDepth) {
-                m_maxDepth = m_finishedPackets.size();
+            if (m_finishedPackets.depth() > m_maxDepth) {
+                m_maxDepth = m_finishedPackets.depth();
             }
 #endif
-            if (m_finishedPackets.size()) {
-                packetbuf *pkt = m_finishedPackets.front();
+            if (m_finishedPackets.pop(buffer)) {
 #if TRACE_LOW_LEVEL
-                DUMP_PKT("SerialEx: <= ", pkt);
+                DUMP_PKT("SerialEx: <= ", &buffer);
 #endif
-                buffer = *pkt;
-                delete pkt;
-                m_finishedPackets.pop_front();
                 // Setup app layer for next read if we have them and not terminating
-                if ((m_finishedPackets.size() == 0) || Terminating()) {
-                    m_AppPacketAvailable = false;
+                if (m_finishedPackets.empty() || Terminating()) {
                     m_responsePacketWaiting.ResetEvent();
                     if (m_pUserCommInterrupt) {
                         m_pUserCommInterrupt->ResetEvent();
                     }
+                    // Re-arm if the reader queued one after our test
+                    if (!m_finishedPackets.empty() && !Terminating()) {
+                        m_responsePacketWaiting.SetEvent();
+                        if (m_pUserCommInterrupt) {
+                            m_pUserCommInterrupt->SetEvent();
+                        }
+                    }
                 }
-                m_SendPacketToAppLock.Unlock();
 #if TRACE_HIGH_LEVEL
                 _RPT1(_CRT_WARN, "%.1f CSerialEx::GetPkt...(OK)!\n",
                       infcCoreTime());
 #endif
                 return (true);
             }
-            else {
-                m_SendPacketToAppLock.Unlock();
-            }
         }
         else {
             buffer.Byte.BufferSize = 0;
@@ -987,6 +1160,59 @@ bool CSerialEx::SendPkt(packetbuf &buffer) {
 //*****************************************************************************
 
 
+//*****************************************************************************
+//  NAME                                                                      *
+//      CSerialEx::SendPkts
+//
+//  DESCRIPTION:
+///     Send several packets to the serial ring channel with one write.
+///
+///     \param pBuffers Array of packets to send
+///     \param nPkts Number of packets in \p pBuffers
+///     \return TRUE on success
+///
+///     The packets are converted back to back into one channel buffer so
+///     they reach the ring with a single write instead of one per packet.
+///     More than SEND_PKTS_MAX packets are written in groups of that size.
+//
+//  SYNOPSIS:
+bool CSerialEx::SendPkts(packetbuf *pBuffers, size_t nPkts) {
+    CSerial::SERAPI_ERR result = API_ERROR_SUCCESS;
+    DWORD nWritten;
+    packetbuf sendBuf;                          // Converted packet
+    char chanBuf[SEND_PKTS_MAX * sizeof(sendBuf.Byte.Buffer)];
+    size_t chanLen = 0, nInChan = 0;
+
+    for (size_t i = 0; i < nPkts; i++) {
+        packetbuf &buffer = pBuffers[i];
+        // Clean start of packet
+        buffer.Byte.Buffer[0] |= 0x80;          // Set start of packet
+        buffer.Byte.Buffer[1] &= ~(0x80);       // Insure length field MSB clear
+
+        convert8to7(buffer, sendBuf);           // Convert to channel format
+        memcpy(&chanBuf[chanLen], sendBuf.Byte.Buffer,
+               sendBuf.Byte.BufferSize);
+        chanLen += sendBuf.Byte.BufferSize;
+
+        // Write when full or at the end
+        if (++nInChan == SEND_PKTS_MAX || i == nPkts - 1) {
+            result = Write(chanBuf, chanLen, &nWritten);
+            m_nCharsTX += nWritten;
+            if (result != API_ERROR_SUCCESS) {
+                _RPTF1(_CRT_WARN, "CSerial::SendPkts - err 0x%x\n",
+                       (unsigned int)result);
+                m_lLastError = result;
+                break;
+            }
+            chanLen = nInChan = 0;
+        }
+    }
+    return (result == API_ERROR_SUCCESS);
+}
+//                                                                            *
+//*****************************************************************************
+
+
 //*****************************************************************************
 //  NAME                                                                      *
 //      CSerialEx::IsPacketAvailable
@@ -1002,7 +1228,7 @@ bool CSerialEx::SendPkt(packetbuf &buffer) {
 //  SYNOPSIS:
 bool CSerialEx::IsPacketAvailable(void) {
     bool avail;
-    avail = m_AppPacketAvailable;
+    avail = !m_finishedPackets.empty();
     return (avail && m_packetMode);
 }
 //                                                                            *
@@ -1164,18 +1390,14 @@ void CSerialEx::Flush() {
 
     // Prevent packet waiters from restarting
     m_responsePacketWaiting.ResetEvent();
-    // Let stuff pile up
-    CThread::Sleep(100);
+    // Let stuff pile up until the line goes quiet
+    WaitForQuiet(SERIAL_QUIET_MS, 100);
     // Make sure all the events are cleared
     GetError();
     // Kill serial traffic accumulated
     m_SendPacketToAppLock.Lock();
     m_rdBuffer.flush();
-    for (size_t i = 0; m_finishedPackets.size(); i++) {
-        packetbuf *buf = m_finishedPackets.front();
-        m_finishedPackets.pop_front();
-        delete buf;
-    }
+    m_finishedPackets.discard();
     m_responsePacketWaiting.ResetEvent();
     // Restart the packet parser
     PacketParseReset();
@@ -1189,6 +1411,65 @@ void CSerialEx::Flush() {
 //*****************************************************************************
 
 
+//*****************************************************************************
+//  NAME                                                                      *
+//      CSerialEx::WaitForQuiet / WaitForReply
+//
+//  DESCRIPTION:
+///     Wait for the characters in flight to arrive. WaitForQuiet returns as
+///     soon as the read thread has seen nothing for \a quietMs. WaitForReply
+///     first waits for the character count to move past \a seenFrom, taken
+///     with CharsSeen before the request was sent, so a reply slower than
+///     the quiet period is not missed. Both give up when \a maxMs has
+///     passed.
+///
+///     \param seenFrom character count before the request
+///     \param quietMs silence that ends the wait
+///     \param maxMs upper bound on the wait
+///     \return true if the line went quiet, after a reply for WaitForReply
+//
+//  SYNOPSIS:
+bool CSerialEx::WaitForQuiet(Uint32 quietMs, Uint32 maxMs) {
+    double startMs = infcCoreTime();
+    double lastRxMs = startMs;
+    Uint32 seen = m_nCharsSeen;
+    for (;;) {
+        double nowMs = infcCoreTime();
+        // Restart the quiet period on any arrival
+        if (m_nCharsSeen != seen) {
+            seen = m_nCharsSeen;
+            lastRxMs = nowMs;
+        }
+        if (nowMs - lastRxMs >= quietMs) {
+            return (true);
+        }
+        if (nowMs - startMs >= maxMs) {
+            return (false);
+        }
+        CThread::Sleep(1);
+    }
+}
+
+bool CSerialEx::WaitForReply(Uint32 seenFrom, Uint32 quietMs, Uint32 maxMs) {
+    double startMs = infcCoreTime();
+    double elapsedMs;
+
+    // The quiet period starts with the first character of the reply
+    while (m_nCharsSeen == seenFrom) {
+        if (infcCoreTime() - startMs >= maxMs) {
+            return (false);
+        }
+        CThread::Sleep(1);
+    }
+    // Round the time left up so the whole wait never ends short of maxMs
+    elapsedMs = infcCoreTime() - startMs;
+    return (WaitForQuiet(quietMs, (elapsedMs < maxMs)
+                                  ? Uint32(maxMs - elapsedMs + 0.999) : 0));
+}
+//                                                                            *
+//*****************************************************************************
+
+
 void CSerialEx::ErrorReportClear() {
     m_ErrorReport.clear();
 }
@@ -1226,57 +1507,117 @@ __inline void CSerialEx::cpymem(
 //*****************************************************************************
 
 
-// This function should allow intentional misconduct by having the
-// buffer length not related to packet header length+overhead. If allowed
-// this function can be used to test buffer and network proceeing by
-// allowing fragmented packets to be transmitted as well as stray data.
+//*****************************************************************************
+//  NAME                                                                      *
+//      Channel codec word helpers
+//
+//  DESCRIPTION:
+///     The link carries 8-bit payloads as groups of seven octets packed
+///     into eight 7-bit characters. A group is handled as one 64-bit word:
+///     Spread7 moves each 7-bit field of a 56-bit word into its own octet
+///     and Gather7 is the inverse. SumOctets adds the eight octets of a
+///     word for the running checksum.
+//
+//  SYNOPSIS:
+static inline Uint64 LoadOctets(const nodechar *pSrc, size_t nOctets) {
+    Uint64 word = 0;
+#if defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    memcpy(&word, pSrc, nOctets);
+#else
+    while (nOctets--) {
+        word = (word << 8) | Uint8(pSrc[nOctets]);
+    }
+#endif
+    return word;
+}
+
+static inline void StoreOctets(nodechar *pDest, Uint64 word, size_t nOctets) {
+#if defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    memcpy(pDest, &word, nOctets);
+#else
+    for (size_t i = 0; i < nOctets; i++, word >>= 8) {
+        pDest[i] = nodechar(word);
+    }
+#endif
+}
+
+static inline Uint64 Spread7(Uint64 word) {
+    return (word & 0x7fULL)
+           | ((word << 1) & (0x7fULL << 8))
+           | ((word << 2) & (0x7fULL << 16))
+           | ((word << 3) & (0x7fULL << 24))
+           | ((word << 4) & (0x7fULL << 32))
+           | ((word << 5) & (0x7fULL << 40))
+           | ((word << 6) & (0x7fULL << 48))
+           | ((word << 7) & (0x7fULL << 56));
+}
+
+static inline Uint64 Gather7(Uint64 word) {
+    word &= 0x7f7f7f7f7f7f7f7fULL;
+    return (word & 0x7fULL)
+           | ((word >> 1) & (0x7fULL << 7))
+           | ((word >> 2) & (0x7fULL << 14))
+           | ((word >> 3) & (0x7fULL << 21))
+           | ((word >> 4) & (0x7fULL << 28))
+           | ((word >> 5) & (0x7fULL << 35))
+           | ((word >> 6) & (0x7fULL << 42))
+           | ((word >> 7) & (0x7fULL << 49));
+}
+
+static inline unsigned SumOctets(Uint64 word) {
+    // Pairwise into 16-bit lanes so the total cannot carry between lanes
+    word = (word & 0x00ff00ff00ff00ffULL) + ((word >> 8) & 0x00ff00ff00ff00ffULL);
+    return unsigned((word * 0x0001000100010001ULL) >> 48);
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//*****************************************************************************
+//  NAME                                                                      *
+//      CSerialEx::convert8to7
+//
+//  DESCRIPTION:
+///     Convert an application packet to channel format and append the
+///     checksum, which is accumulated while the payload is packed.
+///
+///     This function should allow intentional misconduct by having the
+///     buffer length not related to packet header length+overhead. If
+///     allowed this function can be used to test buffer and network
+///     processing by allowing fragmented packets to be transmitted as well
+///     as stray data.
+///
+///     \param inBuf[in] 8-bit application packet.
+///     \param outBuf[out] 7-bit channel packet with checksum.
+//
+//  SYNOPSIS:
 void CSerialEx::convert8to7(packetbuf &inBuf, packetbuf &outBuf) {
     // we copy the first 2 bytes without translation
     outBuf.Byte.Buffer[0] = inBuf.Byte.Buffer[0];
     outBuf.Byte.Buffer[1] = inBuf.Byte.Buffer[1];
 
-    nodechar *s = &inBuf.Byte.Buffer[2];
+    const nodechar *s = &inBuf.Byte.Buffer[2];
     nodechar *d = &outBuf.Byte.Buffer[2];
     nodechar *origD = d;
-    unsigned long chksum = 0;
+    unsigned chksum = 0;
 
     // Allow caller to lie about length to create frag or stray data
     int num8 = inBuf.Fld.PktLen;
-    int consumeBytes;
-    int outBytes;
 
     while (num8 > 0) {
-        consumeBytes = num8 >= 7 ? 7 : num8;
-        outBytes = consumeBytes + 1;
-        switch (outBytes) {
-            case 8:
-                d[7] = 0x7f & ((unsigned char)s[6] >> 1);
-            // no break OK (special line for Code Analyzer to suppress warning)
-            case 7:
-                d[6] = 0x7f & ((s[6] << 6) | ((unsigned char)s[5] >> 2));
-            // no break OK (special line for Code Analyzer to suppress warning)
-            case 6:
-                d[5] = 0x7f & ((s[5] << 5) | ((unsigned char)s[4] >> 3));
-            // no break OK (special line for Code Analyzer to suppress warning)
-            case 5:
-                d[4] = 0x7f & ((s[4] << 4) | ((unsigned char)s[3] >> 4));
-            // no break OK (special line for Code Analyzer to suppress warning)
-            case 4:
-                d[3] = 0x7f & ((s[3] << 3) | ((unsigned char)s[2] >> 5));
-            // no break OK (special line for Code Analyzer to suppress warning)
-            case 3:
-                d[2] = 0x7f & ((s[2] << 2) | ((unsigned char)s[1] >> 6));
-            // no break OK (special line for Code Analyzer to suppress warning)
-            case 2:
-                d[1] = 0x7f & ((s[1] << 1) | ((unsigned char)s[0] >> 7));
-            // no break OK (special line for Code Analyzer to suppress warning)
-            case 1:
-                d[0] = 0x7f &   s[0];
-                // no break OK (special line for Code Analyzer to suppress warning)
+        size_t consumeBytes = num8 >= 7 ? 7 : num8;
+        size_t outBytes = consumeBytes + 1;
+        // A short group carries the low bits of the next octet in its
+        // top character, as the octet codec always has.
+        Uint64 word = Spread7(LoadOctets(s, (consumeBytes < 7) ? outBytes : 7));
+        if (outBytes < 8) {
+            word &= (1ULL << (8 * outBytes)) - 1;
         }
+        StoreOctets(d, word, outBytes);
+        chksum += SumOctets(word);
         d += outBytes;
         s += consumeBytes;
-        num8 -= consumeBytes;
+        num8 -= int(consumeBytes);
     }
     // Adjusts output header for expansion due to 8->7
     outBuf.Fld.PktLen = (d - origD);
@@ -1285,38 +1626,49 @@ void CSerialEx::convert8to7(packetbuf &inBuf, packetbuf &outBuf) {
     outBuf.Byte.BufferSize = (nodeulong)(inBuf.Byte.BufferSize
                                          + (d - origD) - inBuf.Fld.PktLen
                                          + MN_API_PACKET_TAIL_LEN);
-    for (unsigned i = 0; i < (outBuf.Fld.PktLen + 2U); i++) {
-        chksum += outBuf.Byte.Buffer[i];
-    }
-    chksum = (-1 * chksum) & 0x7f;
+    // Header octets complete the checksum
+    chksum += outBuf.Byte.Buffer[0] + outBuf.Byte.Buffer[1];
+    chksum = (0 - chksum) & 0x7f;
     outBuf.Byte.Buffer[outBuf.Fld.PktLen + 2] = (nodechar) chksum;
 }
 //                                                                            *
 //*****************************************************************************
 
+
+//*****************************************************************************
+//  NAME                                                                      *
+//      CSerialEx::convert7to8
+//
+//  DESCRIPTION:
+///     Convert a received channel packet back to application format. The
+///     checksum was verified by the framer as the packet arrived.
+///
+///     \param inBuf[in] 7-bit channel packet.
+///     \param outBuf[out] 8-bit application packet.
+//
+//  SYNOPSIS:
 void CSerialEx::convert7to8(packetbuf &inBuf, packetbuf &outBuf) {
     // we copy the header without translation
     outBuf.Byte.Buffer[0] = inBuf.Byte.Buffer[0];
     outBuf.Byte.Buffer[1] = inBuf.Byte.Buffer[1];
 
-
     int num7 = inBuf.Fld.PktLen;
 
-    nodechar *buf7 = &inBuf.Byte.Buffer[RESP_LOC];
+    const nodechar *buf7 = &inBuf.Byte.Buffer[RESP_LOC];
     nodechar *d = &outBuf.Byte.Buffer[RESP_LOC];
-    nodechar *origD = d;
 
-    int i, mod8;
-    for (i = 0; i < num7; ++i) {
-        mod8 = 0x07 & i;
-        *d |= 0xff & (buf7[i] << (8 - mod8));
-        d += mod8 != 0;         // inc. d 7 out of 8 times
-        *d = buf7[i] >> mod8;
+    // Full groups of eight characters make seven octets
+    for (; num7 >= 8; num7 -= 8, buf7 += 8, d += 7) {
+        StoreOctets(d, Gather7(LoadOctets(buf7, 8)), 7);
+    }
+    // The tail group leaves its last, partial octet past the length
+    if (num7 > 0) {
+        StoreOctets(d, Gather7(LoadOctets(buf7, num7)), num7);
     }
 
-    outBuf.Fld.PktLen = (num7 == 1) ? 1 : d - origD;
+    num7 = inBuf.Fld.PktLen;
+    outBuf.Fld.PktLen = (num7 == 1) ? 1 : num7 - (num7 + 7) / 8;
     outBuf.Byte.BufferSize = outBuf.Fld.PktLen + MN_API_PACKET_HDR_LEN;
-
 }
 //                                                                            *
 //*****************************************************************************
@@ -1342,6 +1694,50 @@ void CSerialEx::RegisterUserPktCommEvent(CCEvent *pUsersEvent) {
 //*****************************************************************************
 
 
+//*****************************************************************************
+//  NAME                                                                      *
+//      CSerialEx::RegisterPktHook
+//
+//  DESCRIPTION:
+///     Install a function our thread offers each received packet to before
+///     it is queued for GetPkt. Packets the hook consumes are not queued.
+///     The hook runs on the serial read thread and must not block. Packets
+///     are only offered while none are queued, so a change of hook never
+///     reorders them.
+///
+///     The hook and context are published as one registration. The one
+///     replaced is freed once our thread is not using it.
+///
+///     \param pHook Hook function, NULL to remove the hook.
+///     \param context Passed to \a pHook with each packet.
+//
+//  SYNOPSIS:
+void CSerialEx::RegisterPktHook(PktHook pHook, void *context) {
+    pktHookReg *pNew = NULL;
+    pktHookReg *pOld;
+    if (pHook) {
+        pNew = new pktHookReg;
+        pNew->pHook = pHook;
+        pNew->context = context;
+    }
+    do {
+        pOld = m_pPktHookReg;
+    } while (!CCatomicCAS(&m_pPktHookReg, pOld, pNew));
+    if (!pOld) {
+        return;
+    }
+    // Our thread picks up the new registration on its next packet
+    if (!IsReaderThread()) {
+        while (m_pktHookInUse) {
+            CThread::Sleep(0);
+        }
+    }
+    delete pOld;
+}
+//                                                                            *
+//*****************************************************************************
+
+
 //*****************************************************************************
 //  NAME                                                                      *
 //      CSerialEvt::CSerialEvt
@@ -1368,6 +1764,7 @@ CSerialEvt::CSerialEvt(CSerialEx *pOwner) {
 #if (defined(_WIN32)||defined(_WIN64))
     SetDLLterm(true);
 #endif
+    SetRole(THREAD_ROLE_SERIAL_READER);
     LaunchThread(this, 1);
 }
 CSerialEvt::~CSerialEvt() {
@@ -1390,6 +1787,31 @@ CSerialEvt::~CSerialEvt() {
 //*****************************************************************************
 
 
+//*****************************************************************************
+//  NAME                                                                      *
+//      CSerialEvt::Terminate
+//
+//  DESCRIPTION:
+/**
+    The event loop blocks until an event is posted, so post the flag and
+    an event before joining with the thread.
+
+    \return handle/ptr to thread
+**/
+//  SYNOPSIS:
+HANDLE CSerialEvt::Terminate() {
+    if (m_pTermFlag) {
+        *m_pTermFlag = true;
+    }
+    if (pPort) {
+        pPort->ForceCommEvent();
+    }
+    return CThread::Terminate();
+}
+//                                                                            *
+//*****************************************************************************
+
+
 //*****************************************************************************
 //  NAME                                                                      *
 //      CSerialEvt::Run
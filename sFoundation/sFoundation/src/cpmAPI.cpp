@@ -2167,6 +2167,8 @@ void cpmClassDelete(multiaddr theMultiAddr) {
     pNodeDB = &SysInventory[cNum].NodeInfo[NODE_ADDR(theMultiAddr)];
     // Delete if no one else has
     if (pNodeDB->paramBankList) {
+        // Remember what was learned for the next start
+        coreParamCacheCapture(theMultiAddr);
         for (unsigned iBank = 0; iBank < pNodeDB->bankCount; iBank++) {
             free((void *)(pNodeDB->paramBankList[iBank]).valueDB);
             (pNodeDB->paramBankList[iBank]).valueDB = NULL;
@@ -2210,79 +2212,86 @@ void cpmClassDelete(multiaddr theMultiAddr) {
 cnErrCode cpmClassSetup(
     multiaddr theMultiAddr) {
     cnErrCode errRet;
-    packetbuf resp, fwVers, dummy;
     register byNodeDB *pNodeDB;
     netaddr cNum = NET_NUM(theMultiAddr);
+    // Identity and clear on read diagnostic reads, each sent as one burst
+    static const nodeparam idParams[] = {
+        MN_P_NODEID, CPM_P_FW_VERS
+    };
+    static const nodeparam diagParams[] = {
+        CPM_P_NETERR_APP_CHKSUM, CPM_P_NETERR_APP_FRAG,
+        CPM_P_NETERR_APP_STRAY, CPM_P_NETERR_APP_OVERRUN
+    };
+    const multiaddr addrs[] = {
+        theMultiAddr, theMultiAddr, theMultiAddr, theMultiAddr
+    };
+    packetbuf ids[2], dummy[4];
+    cnErrCode idErrs[2], dummyErrs[4];
 
     // Stop using old memory
     cpmClassDelete(theMultiAddr);
     // Make sure this is a Integrated Servo Controller
-    errRet = netGetParameter(theMultiAddr, MN_P_NODEID, &resp);
+    errRet = netGetParameterRawList(cNum, 2, addrs, idParams, ids, idErrs);
     if (errRet == MN_OK)  {
-        errRet = netGetParameter(theMultiAddr, CPM_P_FW_VERS, &fwVers);
-        if (errRet == MN_OK)  {
-            // Shorthand to access the device ID field
-#define DEVID ((devID_t *)(&resp.Byte.Buffer[0]))
-#define FWVER ((versID_t *)(&fwVers.Byte.Buffer[0]))
-            // Fill in the database from the node if this is a ClearPath-SC
-            if (DEVID->fld.devType == NODEID_CS || DEVID->fld.devType == NODEID_GS || DEVID->fld.devType == NODEID_EP)     {
-                // Initialize the register/shortcut
-                pNodeDB = &SysInventory[cNum].NodeInfo[NODE_ADDR(theMultiAddr)];
-                // Wire in our destructor
-                pNodeDB->delFunc = cpmClassDelete;
-                // Initialize the per node database
-                pNodeDB->bankCount = 4;
-                // Update the ID area
-                pNodeDB->theID.fld.devType = DEVID->fld.devType;
-                pNodeDB->theID.fld.devModel = DEVID->fld.devModel;
-                // Create and initialize the parameter banks
-                pNodeDB->paramBankList = (paramBank *)calloc(pNodeDB->bankCount,
-                                         sizeof(paramBank));
-                // Bank 0 information
-                (pNodeDB->paramBankList[0]).nParams = PARAM_BASE_COUNT;
-                (pNodeDB->paramBankList[0]).fixedInfoDB = &cpmInfoDB[0];
-                // Create the value storage area together
-                (pNodeDB->paramBankList[0]).valueDB
-                    = (paramValue *)calloc(PARAM_BASE_COUNT,
-                                           sizeof(paramValue));
-                // Bank 1 information
-                (pNodeDB->paramBankList[1]).nParams = PARAM_DRV_COUNT;
-                (pNodeDB->paramBankList[1]).fixedInfoDB = &cpmDrvInfoDB[0];
-                // Create the value storage area together
-                (pNodeDB->paramBankList[1]).valueDB
-                    = (paramValue *)calloc(PARAM_DRV_COUNT,
-                                           sizeof(paramValue));
-                // Bank 2 information
-                (pNodeDB->paramBankList[2]).nParams = PARAM_APP_COUNT;
-                (pNodeDB->paramBankList[2]).fixedInfoDB = &cpmAppInfoDB[0];
-                // Create the value storage area together
-                (pNodeDB->paramBankList[2]).valueDB
-                    = (paramValue *)calloc(PARAM_APP_COUNT,
-                                           sizeof(paramValue));
-                (pNodeDB->paramBankList[3]).nParams = PARAM_APP20_COUNT;
-                (pNodeDB->paramBankList[3]).fixedInfoDB = &cpmApp20InfoDB[0];
-                // Create the value storage area together
-                (pNodeDB->paramBankList[3]).valueDB
-                    = (paramValue *)calloc(PARAM_APP20_COUNT,
-                                           sizeof(paramValue));
-
-                // Create by node information
-                pNodeDB->pNodeSpecific = new iscState;
-
-                // Initialize the class specific items
-                pNodeDB->pClassInfo = &cpmClassDB;
-
-                // Reset all node diagnostics by reading them (clear on read)
-                netGetParameter(theMultiAddr, CPM_P_NETERR_APP_CHKSUM, &dummy);
-                netGetParameter(theMultiAddr, CPM_P_NETERR_APP_FRAG, &dummy);
-                netGetParameter(theMultiAddr, CPM_P_NETERR_APP_STRAY, &dummy);
-                netGetParameter(theMultiAddr, CPM_P_NETERR_APP_OVERRUN, &dummy);
-
-                errRet = coreUpdateParamInfo(theMultiAddr);
-            }
-            else {
-                errRet = MN_ERR_WRONG_NODE_TYPE;
-            }
+        // Shorthand to access the device ID field
+#define DEVID ((devID_t *)(&ids[0].Byte.Buffer[0]))
+#define FWVER ((versID_t *)(&ids[1].Byte.Buffer[0]))
+        // Fill in the database from the node if this is a ClearPath-SC
+        if (DEVID->fld.devType == NODEID_CS || DEVID->fld.devType == NODEID_GS || DEVID->fld.devType == NODEID_EP)     {
+            // Initialize the register/shortcut
+            pNodeDB = &SysInventory[cNum].NodeInfo[NODE_ADDR(theMultiAddr)];
+            // Wire in our destructor
+            pNodeDB->delFunc = cpmClassDelete;
+            // Initialize the per node database
+            pNodeDB->bankCount = 4;
+            // Update the ID area
+            pNodeDB->theID.fld.devType = DEVID->fld.devType;
+            pNodeDB->theID.fld.devModel = DEVID->fld.devModel;
+            // Create and initialize the parameter banks
+            pNodeDB->paramBankList = (paramBank *)calloc(pNodeDB->bankCount,
+                                     sizeof(paramBank));
+            // Bank 0 information
+            (pNodeDB->paramBankList[0]).nParams = PARAM_BASE_COUNT;
+            (pNodeDB->paramBankList[0]).fixedInfoDB = &cpmInfoDB[0];
+            // Create the value storage area together
+            (pNodeDB->paramBankList[0]).valueDB
+                = (paramValue *)calloc(PARAM_BASE_COUNT,
+                                       sizeof(paramValue));
+            // Bank 1 information
+            (pNodeDB->paramBankList[1]).nParams = PARAM_DRV_COUNT;
+            (pNodeDB->paramBankList[1]).fixedInfoDB = &cpmDrvInfoDB[0];
+            // Create the value storage area together
+            (pNodeDB->paramBankList[1]).valueDB
+                = (paramValue *)calloc(PARAM_DRV_COUNT,
+                                       sizeof(paramValue));
+            // Bank 2 information
+            (pNodeDB->paramBankList[2]).nParams = PARAM_APP_COUNT;
+            (pNodeDB->paramBankList[2]).fixedInfoDB = &cpmAppInfoDB[0];
+            // Create the value storage area together
+            (pNodeDB->paramBankList[2]).valueDB
+                = (paramValue *)calloc(PARAM_APP_COUNT,
+                                       sizeof(paramValue));
+            (pNodeDB->paramBankList[3]).nParams = PARAM_APP20_COUNT;
+            (pNodeDB->paramBankList[3]).fixedInfoDB = &cpmApp20InfoDB[0];
+            // Create the value storage area together
+            (pNodeDB->paramBankList[3]).valueDB
+                = (paramValue *)calloc(PARAM_APP20_COUNT,
+                                       sizeof(paramValue));
+
+            // Create by node information
+            pNodeDB->pNodeSpecific = new iscState;
+
+            // Initialize the class specific items
+            pNodeDB->pClassInfo = &cpmClassDB;
+
+            // Reset all node diagnostics by reading them (clear on read)
+            netGetParameterRawList(cNum, 4, addrs, diagParams, dummy,
+                                   dummyErrs);
+
+            errRet = coreUpdateParamInfo(theMultiAddr);
+        }
+        else {
+            errRet = MN_ERR_WRONG_NODE_TYPE;
         }
     }
     return (errRet);
@@ -1718,6 +1718,87 @@ void SysCPMportAdv::SetBackgroundPolling(bool enable) {
     infcBackgroundPollControl(m_pPort->NetNumber(), enable);
 }
 
+/**
+\copydoc IPortAdv::LatencyStats
+**/
+void SysCPMportAdv::LatencyStats(latencyScopes scope, size_t key,
+                                 mnLatencyHist &hist, bool reset) {
+    cnErrCode theErr = infcLatencyStatsGet(m_pPort->NetNumber(), scope,
+                                           nodeulong(key), &hist, reset);
+    if (theErr != MN_OK) {
+        mnErr eInfo;
+        fillInErrs(eInfo, theErr, _TEK_FUNC_SIG_,
+                   "Failure to get latency stats %d:%d on network %d",
+                   scope, key, m_pPort->NetNumber());
+        throwSystemError(eInfo);
+    }
+}
+
+/**
+\copydoc IPortAdv::LatencyStatsReset
+**/
+void SysCPMportAdv::LatencyStatsReset() {
+    cnErrCode theErr = infcLatencyStatsReset(m_pPort->NetNumber());
+    if (theErr != MN_OK) {
+        mnErr eInfo;
+        fillInErrs(eInfo, theErr, _TEK_FUNC_SIG_,
+                   "Failure to reset latency stats on network %d",
+                   m_pPort->NetNumber());
+        throwSystemError(eInfo);
+    }
+}
+
+/**
+\copydoc IPortAdv::CyclicStart
+**/
+void SysCPMportAdv::CyclicStart(size_t periodMs) {
+    cnErrCode theErr = netCyclicStart(m_pPort->NetNumber(),
+                                      nodeulong(periodMs));
+    if (theErr != MN_OK) {
+        mnErr eInfo;
+        fillInErrs(eInfo, theErr, _TEK_FUNC_SIG_,
+                   "Failure to start cyclic refresh every %dms on network %d",
+                   int(periodMs), m_pPort->NetNumber());
+        throwSystemError(eInfo);
+    }
+}
+
+/**
+\copydoc IPortAdv::CyclicStop
+**/
+void SysCPMportAdv::CyclicStop() {
+    // Stopping a stopped refresh is harmless
+    netCyclicStop(m_pPort->NetNumber());
+}
+
+/**
+\copydoc IPortAdv::CyclicStats
+**/
+void SysCPMportAdv::CyclicStats(mnCyclicStats &stats, bool reset) {
+    cnErrCode theErr = netCyclicStats(m_pPort->NetNumber(), &stats, reset);
+    if (theErr != MN_OK) {
+        mnErr eInfo;
+        fillInErrs(eInfo, theErr, _TEK_FUNC_SIG_,
+                   "Failure to get cyclic refresh stats on network %d",
+                   m_pPort->NetNumber());
+        throwSystemError(eInfo);
+    }
+}
+
+/**
+\copydoc IPortAdv::StartupProfile
+**/
+void SysCPMportAdv::StartupProfile(mnStartupProfile &profile) {
+    cnErrCode theErr = infcStartupProfileGet(m_pPort->NetNumber(), &profile);
+    if (theErr != MN_OK) {
+        mnErr eInfo;
+        fillInErrs(eInfo, theErr, _TEK_FUNC_SIG_,
+                   "Failure to get startup profile on network %d",
+                   m_pPort->NetNumber());
+        throwSystemError(eInfo);
+    }
+}
+
 //= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
 // SysCPMattnPort Class Implementations
 //= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
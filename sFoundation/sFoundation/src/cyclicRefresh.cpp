@@ -0,0 +1,667 @@
+//******************************************************************************
+// $Workfile: cyclicRefresh.cpp $
+//
+// DESCRIPTION:
+/**
+    \file
+    \brief Background cyclic refresh of subscribed parameters
+
+    A thread per port reads every subscribed parameter of the port's nodes
+    each period with the reads sent back to back. Each value is published
+    to its slot under a sequence count so readers take the latest value
+    without a lock or a command.
+**/
+// CREATION DATE:
+//  10/16/2026
+//
+// COPYRIGHT NOTICE:
+//  (C)Copyright 2026  Teknic, Inc.  All rights reserved.
+//
+//  This copyright notice must be reproduced in any copy, modification,
+//  or portion thereof merged into another program. A copy of the
+//  copyright notice must be included in the object library of a user
+//  program.
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  cyclicRefresh.cpp headers
+//
+// Our driver headers
+#include "cyclicRefresh.h"
+#include "netCmdPrivate.h"
+#include "mnErrors.h"
+
+#include <algorithm>
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  cyclicRefresh.cpp imported references
+//
+extern mnNetInvRecords SysInventory[NET_CONTROLLER_MAX];
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  cyclicRefresh.cpp static variables
+//
+// Serializes creating, starting and stopping the port engines
+static CCCriticalSection cyclicLock;
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      cyclicRefresh::cyclicRefresh construction and destruction
+//
+//  DESCRIPTION:
+/**
+    Construct a stopped engine for port \a cNum. The destructor stops the
+    thread. Slots still subscribed stay with their subscribers, who free
+    them on unsubscribing.
+**/
+//  SYNOPSIS:
+cyclicRefresh::cyclicRefresh(netaddr cNum) :
+    m_cNum(cNum),
+    m_pThread(NULL),
+    m_periodNs(0),
+    m_lastSampleNs(0) {
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+cyclicRefresh::~cyclicRefresh() {
+    Stop();
+    m_slots.clear();
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      cyclicRefresh::Subscribe / Unsubscribe
+//
+//  DESCRIPTION:
+/**
+    Add a slot for parameter \a param of node \a addr to the cycle, or take
+    one out. A slot taken out during a cycle is freed when the cycle is
+    done with it.
+**/
+//  SYNOPSIS:
+cyclicSlot *cyclicRefresh::Subscribe(multiaddr addr, nodeparam param) {
+    cyclicSlot *pSlot = new cyclicSlot;
+
+    pSlot->addr = addr;
+    pSlot->param = param;
+    pSlot->refs = 1;
+    pSlot->listed = true;
+    pSlot->seq = 0;
+    pSlot->valid = false;
+    pSlot->updatedNs = 0;
+    pSlot->periodNs = 0;
+    m_lock.Lock();
+    m_slots.push_back(pSlot);
+    m_lock.Unlock();
+    return (pSlot);
+}
+
+void cyclicRefresh::Unsubscribe(cyclicSlot *pSlot) {
+    std::vector<cyclicSlot *>::iterator it;
+
+    m_lock.Lock();
+    it = std::find(m_slots.begin(), m_slots.end(), pSlot);
+    if (it != m_slots.end()) {
+        m_slots.erase(it);
+        pSlot->listed = false;
+        release(pSlot);
+    }
+    m_lock.Unlock();
+}
+
+void cyclicRefresh::release(cyclicSlot *pSlot) {
+    if (--pSlot->refs == 0) {
+        delete pSlot;
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      cyclicRefresh::publish / Read
+//
+//  DESCRIPTION:
+/**
+    Sequence counted access to a slot's value. There is one writer at a
+    time, readers retry while the count is odd or changes under them.
+
+    \return Read returns true if the slot holds a value
+**/
+//  SYNOPSIS:
+void cyclicRefresh::publish(cyclicSlot *pSlot, bool valid,
+                            const paramValue &val, Uint64 sampleNs,
+                            Uint64 periodNs) {
+    pSlot->seq++;
+    CCmemoryBarrier();
+    pSlot->valid = valid;
+    pSlot->updatedNs = sampleNs;
+    pSlot->periodNs = periodNs;
+    pSlot->value = val;
+    CCmemoryBarrier();
+    pSlot->seq++;
+}
+
+bool cyclicRefresh::Read(cyclicSlot *pSlot, paramValue *pVal,
+                         Uint64 *pUpdatedNs, Uint64 *pPeriodNs) {
+    Uint32 seq;
+    bool valid;
+    Uint64 updatedNs, periodNs;
+
+    for (;;) {
+        seq = pSlot->seq;
+        CCmemoryBarrier();
+        if (seq & 1) {
+            continue;
+        }
+        valid = pSlot->valid;
+        updatedNs = pSlot->updatedNs;
+        periodNs = pSlot->periodNs;
+        if (valid && pVal) {
+            *pVal = pSlot->value;
+        }
+        CCmemoryBarrier();
+        if (pSlot->seq == seq) {
+            break;
+        }
+    }
+    if (valid && pUpdatedNs) {
+        *pUpdatedNs = updatedNs;
+    }
+    if (valid && pPeriodNs) {
+        *pPeriodNs = periodNs;
+    }
+    return (valid);
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      cyclicRefresh::cycle
+//
+//  DESCRIPTION:
+/**
+    Read every subscribed value in one batch and publish the results. The
+    batch is sent in windows of the ring's command limit by
+    netGetParameterList. A failed read invalidates the slot, so readers go
+    back to the node rather than take a value the node no longer gives.
+**/
+//  SYNOPSIS:
+void cyclicRefresh::cycle() {
+    Uint64 startNs, endNs, sampleNs, periodNs;
+    paramValue noValue;
+    double cycleMs;
+    size_t i, n;
+
+    m_lock.Lock();
+    m_work = m_slots;
+    for (i = 0; i < m_work.size(); i++) {
+        m_work[i]->refs++;
+    }
+    m_lock.Unlock();
+
+    n = m_work.size();
+    m_addrs.resize(n);
+    m_params.resize(n);
+    m_vals.resize(n);
+    m_errs.resize(n);
+    for (i = 0; i < n; i++) {
+        m_addrs[i] = m_work[i]->addr;
+        m_params[i] = m_work[i]->param;
+    }
+    startNs = coreTimeNs();
+    if (n) {
+        netGetParameterList(m_cNum, nodeulong(n), &m_addrs[0], &m_params[0],
+                            &m_vals[0], &m_errs[0]);
+    }
+    endNs = coreTimeNs();
+    sampleNs = startNs + (endNs - startNs) / 2;
+    cycleMs = (endNs - startNs) / 1e6;
+    periodNs = m_periodNs;
+
+    m_lock.Lock();
+    for (i = 0; i < n; i++) {
+        if (m_errs[i] != MN_OK) {
+            m_stats.Failed++;
+            if (m_work[i]->listed) {
+                publish(m_work[i], false, noValue, 0, 0);
+            }
+        }
+        else if (m_work[i]->listed) {
+            publish(m_work[i], true, m_vals[i], sampleNs, periodNs);
+        }
+        release(m_work[i]);
+    }
+    m_stats.Cycles++;
+    m_stats.LastCycleMs = cycleMs;
+    if (cycleMs > m_stats.MaxCycleMs) {
+        m_stats.MaxCycleMs = cycleMs;
+    }
+    if (n) {
+        m_lastSampleNs = sampleNs;
+    }
+    m_lock.Unlock();
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      cyclicRefresh::Start / Stop
+//
+//  DESCRIPTION:
+/**
+    Start the refresh thread with a period of \a periodMs, or change the
+    period of a running one. Stop ends the thread and invalidates the
+    slots so readers go back to the node.
+
+    \return #cnErrCode; MN_OK if the thread is running, or was stopped
+**/
+//  SYNOPSIS:
+cnErrCode cyclicRefresh::Start(Uint32 periodMs) {
+    if (periodMs < CYCLIC_PERIOD_MIN_MS) {
+        return (MN_ERR_BADARG);
+    }
+    m_periodNs = Uint64(periodMs) * 1000000;
+    if (!m_pThread) {
+        m_pThread = new cyclicThread(*this);
+        m_pThread->LaunchThread(m_pThread);
+    }
+    return (MN_OK);
+}
+
+cnErrCode cyclicRefresh::Stop() {
+    paramValue noValue;
+    size_t i;
+
+    if (!m_pThread) {
+        return (MN_ERR_CLOSED);
+    }
+    // No cycle runs past here
+    delete m_pThread;
+    m_pThread = NULL;
+    m_periodNs = 0;
+
+    m_lock.Lock();
+    for (i = 0; i < m_slots.size(); i++) {
+        publish(m_slots[i], false, noValue, 0, 0);
+    }
+    m_lastSampleNs = 0;
+    m_lock.Unlock();
+    return (MN_OK);
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      cyclicRefresh::Stats
+//
+//  DESCRIPTION:
+/**
+    Copy the statistics to \a pStats and clear the counts if \a reset.
+**/
+//  SYNOPSIS:
+void cyclicRefresh::Stats(mnCyclicStats *pStats, bool reset) {
+    Uint64 nowNs = coreTimeNs();
+
+    m_lock.Lock();
+    *pStats = m_stats;
+    pStats->Subscribed = Uint32(m_slots.size());
+    pStats->PeriodMs = m_periodNs / 1e6;
+    pStats->AgeMs = m_lastSampleNs ? (nowNs - m_lastSampleNs) / 1e6 : -1;
+    if (reset) {
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+    m_lock.Unlock();
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      cyclicThread construction and destruction
+//
+//  DESCRIPTION:
+/**
+    Construct the thread for \a owner. The destructor waits for the cycle
+    in progress to finish.
+**/
+//  SYNOPSIS:
+cyclicThread::cyclicThread(cyclicRefresh &owner) :
+    m_owner(owner) {
+    m_wake.ResetEvent();
+}
+
+cyclicThread::~cyclicThread() {
+    // Insure we exit
+    Terminate();
+    WaitForTerm();
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      cyclicThread::Run
+//
+//  DESCRIPTION:
+/**
+    Refresh thread. Start a cycle every period until terminated. Cycles
+    keep their schedule, when one overruns the starts it passed are
+    skipped and counted as missed.
+
+    \return 0
+**/
+//  SYNOPSIS:
+int cyclicThread::Run(void *context) {
+    Uint64 nextNs = coreTimeNs(), nowNs, periodNs, skipped;
+
+    while (!*m_pTermFlag) {
+        nowNs = coreTimeNs();
+        if (nowNs < nextNs) {
+            m_wake.WaitFor(unsigned((nextNs - nowNs + 999999) / 1000000));
+            continue;
+        }
+        m_owner.cycle();
+        periodNs = m_owner.m_periodNs;
+        nextNs += periodNs;
+        nowNs = coreTimeNs();
+        if (nowNs > nextNs) {
+            skipped = (nowNs - nextNs) / periodNs + 1;
+            nextNs += skipped * periodNs;
+            m_owner.m_lock.Lock();
+            m_owner.m_stats.Missed += skipped;
+            m_owner.m_lock.Unlock();
+        }
+    }
+    return (0);
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      cyclicThread::Terminate
+//
+//  DESCRIPTION:
+/**
+    Insure the thread exits in a timely manner.
+
+    \return handle/ptr to thread
+**/
+//  SYNOPSIS:
+void *cyclicThread::Terminate() {
+    *m_pTermFlag = true;
+    m_wake.SetEvent();
+    return (CThread::Terminate());
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netCyclicSubscribe
+//
+//  DESCRIPTION:
+/**
+    Add parameter \a theParam of node \a theMultiAddr to the cyclic refresh
+    of the node's port. The value is refreshed while the port's refresh is
+    started, see netCyclicStart. Clear on read parameters are refused as a
+    background read would lose their contents.
+
+    \param[in] theMultiAddr Node address.
+    \param[in] theParam Parameter number.
+    \param[out] ppSlot Slot to read the value from, free it with
+    netCyclicUnsubscribe.
+    \return #cnErrCode; MN_OK if subscribed
+**/
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL netCyclicSubscribe(
+    multiaddr theMultiAddr,
+    nodeparam theParam,
+    cyclicSlot **ppSlot) {
+    netaddr cNum = coreController(theMultiAddr);
+    paramInfo theInfo;
+    cnErrCode theErr;
+
+    if (!ppSlot) {
+        return (MN_ERR_BADARG);
+    }
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return (MN_ERR_DEV_ADDR);
+    }
+    theErr = netGetParameterInfo(theMultiAddr, theParam, &theInfo, NULL);
+    if (theErr != MN_OK) {
+        return (theErr);
+    }
+    if (theInfo.paramType == PT_NONE || (theInfo.paramType & PT_CLR)) {
+        return (MN_ERR_BADARG);
+    }
+    mnNetInvRecords &theNet = SysInventory[cNum];
+    cyclicLock.Lock();
+    if (!theNet.pCyclic) {
+        theNet.pCyclic = new cyclicRefresh(cNum);
+    }
+    *ppSlot = theNet.pCyclic->Subscribe(theMultiAddr, theParam);
+    cyclicLock.Unlock();
+    return (MN_OK);
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netCyclicUnsubscribe
+//
+//  DESCRIPTION:
+/**
+    Take \a pSlot out of its port's cyclic refresh and free it. The slot
+    must not be used afterwards.
+
+    \param[in] pSlot Slot from netCyclicSubscribe or NULL.
+**/
+//  SYNOPSIS:
+MN_EXPORT void MN_DECL netCyclicUnsubscribe(
+    cyclicSlot *pSlot) {
+    if (!pSlot) {
+        return;
+    }
+    mnNetInvRecords &theNet = SysInventory[coreController(pSlot->addr)];
+    cyclicLock.Lock();
+    if (theNet.pCyclic) {
+        theNet.pCyclic->Unsubscribe(pSlot);
+    }
+    else {
+        // The engine is gone, nothing else refers to the slot
+        delete pSlot;
+    }
+    cyclicLock.Unlock();
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netCyclicRead
+//
+//  DESCRIPTION:
+/**
+    Copy the latest value of \a pSlot without a command or a lock. A value
+    older than CYCLIC_STALE_PERIODS periods, as when the refresh thread
+    falls behind, is still copied but reported as timed out.
+
+    \param[in] pSlot Slot from netCyclicSubscribe.
+    \param[out] pRetVal Value, or NULL.
+    \param[out] pAgeMs Milliseconds since the value was sampled, or NULL.
+    \return #cnErrCode; MN_OK if the slot holds a fresh value, MN_ERR_TIMEOUT
+    if it is stale, MN_ERR_DATAACQ_EMPTY before the first cycle, after a
+    failed read and while the refresh is stopped
+**/
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL netCyclicRead(
+    cyclicSlot *pSlot,
+    paramValue *pRetVal,
+    double *pAgeMs) {
+    Uint64 updatedNs, periodNs, ageNs;
+
+    if (!pSlot) {
+        return (MN_ERR_BADARG);
+    }
+    if (!cyclicRefresh::Read(pSlot, pRetVal, &updatedNs, &periodNs)) {
+        return (MN_ERR_DATAACQ_EMPTY);
+    }
+    ageNs = coreTimeNs() - updatedNs;
+    if (pAgeMs) {
+        *pAgeMs = ageNs / 1e6;
+    }
+    if (ageNs > CYCLIC_STALE_PERIODS * periodNs) {
+        return (MN_ERR_TIMEOUT);
+    }
+    return (MN_OK);
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netCyclicStart / netCyclicStop
+//
+//  DESCRIPTION:
+/**
+    Start the cyclic refresh of port \a cNum with a period of \a periodMs,
+    or change the period if it is running. Stop ends it and invalidates
+    the subscribed values, the subscriptions remain for the next start.
+
+    \param[in] cNum Channel number. The first channel is zero.
+    \param[in] periodMs Cycle period in milliseconds.
+    \return #cnErrCode; MN_OK if started or stopped, MN_ERR_CLOSED when
+    stopping a port that is not refreshing
+**/
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL netCyclicStart(
+    netaddr cNum,
+    nodeulong periodMs) {
+    cnErrCode theErr;
+
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return (MN_ERR_DEV_ADDR);
+    }
+    mnNetInvRecords &theNet = SysInventory[cNum];
+    cyclicLock.Lock();
+    if (!theNet.pCyclic) {
+        theNet.pCyclic = new cyclicRefresh(cNum);
+    }
+    theErr = theNet.pCyclic->Start(Uint32(periodMs));
+    cyclicLock.Unlock();
+    return (theErr);
+}
+
+MN_EXPORT cnErrCode MN_DECL netCyclicStop(
+    netaddr cNum) {
+    cnErrCode theErr = MN_ERR_CLOSED;
+
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return (MN_ERR_DEV_ADDR);
+    }
+    mnNetInvRecords &theNet = SysInventory[cNum];
+    cyclicLock.Lock();
+    if (theNet.pCyclic) {
+        theErr = theNet.pCyclic->Stop();
+    }
+    cyclicLock.Unlock();
+    return (theErr);
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netCyclicStats
+//
+//  DESCRIPTION:
+/**
+    Get the cyclic refresh statistics of port \a cNum.
+
+    \param[in] cNum Channel number. The first channel is zero.
+    \param[out] pStats Statistics.
+    \param[in] reset Clear the counts after copying them.
+    \return #cnErrCode; MN_OK if copied
+**/
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL netCyclicStats(
+    netaddr cNum,
+    mnCyclicStats *pStats,
+    nodebool reset) {
+    if (!pStats) {
+        return (MN_ERR_BADARG);
+    }
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return (MN_ERR_DEV_ADDR);
+    }
+    mnNetInvRecords &theNet = SysInventory[cNum];
+    cyclicLock.Lock();
+    if (theNet.pCyclic) {
+        theNet.pCyclic->Stats(pStats, reset != 0);
+    }
+    else {
+        memset(pStats, 0, sizeof(*pStats));
+        pStats->AgeMs = -1;
+    }
+    cyclicLock.Unlock();
+    return (MN_OK);
+}
+//                                                                             *
+//******************************************************************************
+
+
+//==============================================================================
+//  END OF FILE cyclicRefresh.cpp
+//==============================================================================
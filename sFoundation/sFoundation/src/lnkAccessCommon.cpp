@@ -119,10 +119,13 @@
 #include "netCmdPrivate.h"
 #include "SerialEx.h"
 #include "netCmdAPI.h"
+#include "traceStream.h"
+#include "cyclicRefresh.h"
 // Std Library
 #include <fstream>
 // System include files
 #include <assert.h>
+#include <string.h>
 #if (defined(_WIN32)||defined(_WIN64))
     #include <direct.h>
     #include <crtdbg.h>
@@ -304,12 +307,16 @@ infcInvalCacheCallback userInvalCacheFunc = NULL;
 BOOL InfcDumpOnExit = TRUE;
 // Global time-out setting
 unsigned InfcRespTimeOut = FRAME_READ_TIMEOUT + FRAME_READ_TIMEOUT / 8;
+// Shortest adaptive time-out, 0 to always use InfcRespTimeOut
+unsigned InfcRespTimeOutMin = 100;
 // Default read thread priority
 int InfcPrioBoostFactor = 0;
 // Last dump file number
 unsigned InfcLastDumpNumber = 0;
 // Inhibits running diagnostics
 BOOL InfcDiagnosticsOn = TRUE;
+// Write startup phases to the trace as marks
+BOOL InfcStartupTrace = FALSE;
 // When non-zero, the system is initializing. This should always
 // equal the sum of the SysInventory[*].Initializing
 int InitializingGlobal = 0;
@@ -332,6 +339,7 @@ extern mnNetInvRecords SysInventory[NET_CONTROLLER_MAX];
 extern BOOL InfcDiagnosticsOn;          // Inhibits running diagnostics
 extern unsigned InfcLastDumpNumber;     // Last Dump File number
 extern unsigned InfcRespTimeOut;        // Response time-out setting
+extern unsigned InfcRespTimeOutMin;     // Adaptive time-out floor
 
 // Global references
 extern mnNetDiagResults NetDiags[NET_CONTROLLER_MAX];
@@ -413,7 +421,7 @@ void DUMP_PKT(netaddr cNum, const char *msg, packetbuf *buf, bool backArrow) {
 //  SYNOPSIS:
 netStateInfo::netStateInfo(nodeulong ringCmdsMax,
                            netaddr controllerNum)
-    : CmdPaceSemaphore(ringCmdsMax, ringCmdsMax),
+    : CmdPaceSemaphore(ringCmdsMax),
       DataAcqMode(),
       ErrList(),
       NetChgList() {
@@ -452,6 +460,10 @@ netStateInfo::netStateInfo(nodeulong ringCmdsMax,
     CmdsIdle.SetEvent();
 
     nPktsSent = nPktsRcvd = nRespOutstanding = 0;
+    readThreadRx = FALSE;
+    nAsyncOutstanding = 0;
+    nOrphans = 0;
+    pCanceledAsync = NULL;
 
     for (node = 0; node < MN_API_MAX_NODES; node++) {
         // Initialize the node response databases, assuming no waiters
@@ -460,6 +472,9 @@ netStateInfo::netStateInfo(nodeulong ringCmdsMax,
         respNodeState[node].errPkt.Byte.BufferSize = 0;
         respNodeState[node].sendCnt = 0;
         respNodeState[node].respCnt = 0;
+        for (unsigned cls = 0; cls < RTO_CLASS_CNT; cls++) {
+            respNodeState[node].rto[cls].Clear();
+        }
 
         //while we're going through the nodes, mark that they haven't been changed
         paramsHaveChanged[node] = FALSE;
@@ -492,25 +507,26 @@ netStateInfo::netStateInfo(nodeulong ringCmdsMax,
     ReadThread.SetTerminateFlag(&SelfDestruct);
 
     // Create trackers for each possible command in progress on this net
+    assert(ringCmdsMax <= TRK_POOL_MAX);
     pTrkFixedList =
         (respTrackInfo **)calloc(ringCmdsMax, sizeof(respTrackInfo *));
-    pTrkList = (respTrackInfo **)calloc(ringCmdsMax, sizeof(respTrackInfo *));
+    assert(pTrkFixedList);
     for (node = 0; node < ringCmdsMax; node++) {
         pTrkFixedList[node] = new respTrackInfo;
-        pTrkList[node] = pTrkFixedList[node];
+        pTrkFixedList[node]->slot = node;
     }
-    assert(pTrkList);
 #if TRACE_SIZES
     _RPT2(_CRT_WARN, "respTrackInfo size=%d(0x%x)\n",
           sizeof(respTrackInfo)*ringCmdsMax,
           sizeof(respTrackInfo)*ringCmdsMax);
-    _RPT1(_CRT_WARN, "sizeof(rxTraceBuf)=%d\n", sizeof(rxTraceBuf));
-    _RPT1(_CRT_WARN, "sizeof(txTraceBuf)=%d\n", sizeof(txTraceBuf));
+    _RPT1(_CRT_WARN, "sizeof(rxTraceSlot)=%d\n", sizeof(rxTraceSlot));
+    _RPT1(_CRT_WARN, "sizeof(txTraceSlot)=%d\n", sizeof(txTraceSlot));
     _RPT1(_CRT_WARN, "sizeof(traceHeader)=%d\n", sizeof(traceHeader));
 #endif
 
-    // Insure the tail is initialized
-    pTrkTail = &pTrkList[ringCmdsMax - 1];
+    // All trackers start free
+    trkFreeMask = (ringCmdsMax >= TRK_POOL_MAX) ? ~Uint64(0)
+                  : (Uint64(1) << ringCmdsMax) - 1;
     // Create our discovery thread
     pAutoDiscover = new autoDiscoverThread;
 #if TRACE_SIZES
@@ -519,11 +535,13 @@ netStateInfo::netStateInfo(nodeulong ringCmdsMax,
           sizeof(autoDiscoverThread));
 #endif
     // Get it started until parking point
+    pAutoDiscover->SetRole(THREAD_ROLE_AUTO_DISCOVER);
     pAutoDiscover->LaunchThread(this);
     pAutoDiscover->WaitUntilParked();
     errorRecursePrevent = 0;
 
     // Lastly, start our read thread now that our state has settled in
+    ReadThread.SetRole(THREAD_ROLE_READ_PKT);
     ReadThread.LaunchThread(this, InfcPrioBoostFactor);
     // Wait for it to start up and enter "halted" state
     ReadThread.ForceStop();
@@ -531,6 +549,7 @@ netStateInfo::netStateInfo(nodeulong ringCmdsMax,
     // Initialize the polling rate and start in halted state
     pollDelayTimeMS = 250;
     pPollerThread = new netPollerThread(this);
+    pPollerThread->SetRole(THREAD_ROLE_POLLER);
     pPollerThread->LaunchThread(this);
 
 #if TRACE_LOW_LEVEL || TRACE_DESTRUCT
@@ -600,7 +619,7 @@ netStateInfo::~netStateInfo() {
     for (i = 0; i < RingCmdsMax; i++) {
         // Signal events waiting for responses
         if (pTrkFixedList && pTrkFixedList[i]) {
-            pTrkFixedList[i]->evtRespWait.SetEvent();
+            pTrkFixedList[i]->respDone.Fire();
         }
     }
     // Make sure those waiting (re)start
@@ -614,8 +633,30 @@ netStateInfo::~netStateInfo() {
           infcCoreTime(), cNum);
 #endif
 
-    // Wait for read thread to terminate to prevent access violations
-    ReadThread.WaitForTerm();
+    // Join the read thread so it cannot complete trackers behind us
+    ReadThread.TerminateAndWait();
+
+    // Fail submitted commands that never saw their response. Each is
+    // detached under its list's lock and completed after releasing it.
+    for (i = 0; i < RESP_LIST_CNT; i++) {
+        respNodeList *pList = respList(i);
+        for (;;) {
+            asyncCmdInfo *pAsync = NULL;
+            pList->listLock.Lock();
+            for (respTrackInfo *pInfo = pList->head; pInfo && !pAsync;
+                    pInfo = pInfo->next) {
+                pAsync = pInfo->pAsync;
+                pInfo->pAsync = NULL;
+            }
+            pList->listLock.Unlock();
+            if (!pAsync) {
+                break;
+            }
+            completeAsync(pAsync, MN_ERR_CLOSED);
+        }
+    }
+    // And those a flush left for its caller
+    completeCanceled();
 
     // Done with serial port now
 #if TRACE_LOW_LEVEL || TRACE_DESTRUCT
@@ -634,15 +675,8 @@ netStateInfo::~netStateInfo() {
           infcCoreTime(), cNum);
 #endif
 
-    pTrkTail = NULL;
-    if (pTrkList) {
-        // Return the tracking database memory
-        for (i = 0; i < RingCmdsMax; i++) {
-            pTrkList[i] = NULL;
-        }
-        free(pTrkList);
-        pTrkList = NULL;
-    }
+    // No more trackers to hand out
+    trkFreeMask = 0;
     if (pTrkFixedList) {
         // Return the tracking database memory
         for (i = 0; i < RingCmdsMax; i++) {
@@ -677,13 +711,15 @@ netStateInfo::~netStateInfo() {
 //      netStateInfo::enterCmdLock
 //
 //  DESCRIPTION:
-//      Enter command interface lock section
+//      Enter command interface lock section. This locks the whole response
+//      database; command traffic itself only locks the lists it uses.
 //
 //  SYNOPSIS:
 void netStateInfo::enterCmdLock() {
     if (!cmdLock.Lock()) {
         _RPT1(_CRT_WARN, "enterCmdLock%d: time-out\n", cNum);
     }
+    lockLists((1U << RESP_LIST_CNT) - 1);
 }
 //                                                                             *
 //******************************************************************************
@@ -701,6 +737,7 @@ void netStateInfo::enterCmdLock() {
 //
 //  SYNOPSIS:
 void netStateInfo::exitCmdLock() {
+    unlockLists((1U << RESP_LIST_CNT) - 1);
     if (!cmdLock.Unlock()) {
         _RPT2(_CRT_WARN, "exitCmdLock: semaphore %d release err 0x%X\n",
               cNum, GetLastError());
@@ -710,6 +747,363 @@ void netStateInfo::exitCmdLock() {
 //******************************************************************************
 
 
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::lockLists
+//
+//  DESCRIPTION:
+//      Lock the response lists selected by <listMask>, bit n selecting
+//      list n. Lists are always locked in index order to avoid deadlocks.
+//
+//  SYNOPSIS:
+void netStateInfo::lockLists(Uint32 listMask) {
+    for (unsigned i = 0; i < RESP_LIST_CNT; i++) {
+        if (listMask & (1U << i)) {
+            respList(i)->listLock.Lock();
+        }
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::unlockLists
+//
+//  DESCRIPTION:
+//      Unlock the response lists selected by <listMask>.
+//
+//  SYNOPSIS:
+void netStateInfo::unlockLists(Uint32 listMask) {
+    for (unsigned i = RESP_LIST_CNT; i-- > 0;) {
+        if (listMask & (1U << i)) {
+            respList(i)->listLock.Unlock();
+        }
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::rtoClassOf
+//
+//  DESCRIPTION:
+//      Adaptive time-out class of <pCmd>. Only commands known to be
+//      answered right away adapt, the rest keep the fixed time-out so slow
+//      but healthy commands are never cut short.
+//
+//  SYNOPSIS:
+rtoClasses netStateInfo::rtoClassOf(
+    const packetbuf *pCmd) {
+    if (pCmd->Fld.PktType != MN_PKT_TYPE_CMD
+            || pCmd->Byte.BufferSize <= CMD_LOC) {
+        return RTO_CLASS_FIXED;
+    }
+    switch (pCmd->Byte.Buffer[CMD_LOC]) {
+        case MN_CMD_GET_PARAM0:
+        case MN_CMD_GET_PARAM1:
+        case MN_CMD_GET_PARAM2:
+        case MN_CMD_GET_PARAM3:
+            return RTO_CLASS_GET;
+        case MN_CMD_NODE_STOP:
+        case MN_CMD_NET_ACCESS:
+        case MN_CMD_ALERT_CLR:
+            return RTO_CLASS_CTL;
+        default:
+            return RTO_CLASS_FIXED;
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::respTimeoutNs
+//
+//  DESCRIPTION:
+//      Response time-out for <pCmd> from the round trips measured for its
+//      node and class, between InfcRespTimeOutMin and InfcRespTimeOut. The
+//      estimate is read without its list lock, a stale value only shifts
+//      the time-out of this one command.
+//
+//  SYNOPSIS:
+Uint64 netStateInfo::respTimeoutNs(
+    packetbuf *pCmd) {
+    Uint64 ceilNs = coreMsToNs(InfcRespTimeOut);
+    rtoClasses rtoClass = rtoClassOf(pCmd);
+
+    if (rtoClass == RTO_CLASS_FIXED) {
+        return ceilNs;
+    }
+    return respList(respListIndex(pCmd))->rto[rtoClass].TimeoutNs(
+               coreMsToNs(InfcRespTimeOutMin), ceilNs);
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::cmdClassOf
+//
+//  DESCRIPTION:
+//      Scheduling class of <pCmd>. Node stops and triggers are always
+//      urgent and motion at least CMD_CLASS_MOTION, anything else takes the
+//      class set for the sending thread by infcCmdClassSet.
+//
+//  SYNOPSIS:
+static thread_local cmdClasses threadCmdClass = CMD_CLASS_NORMAL;
+
+cmdClasses netStateInfo::cmdClassOf(
+    const packetbuf *pCmd) {
+    cmdClasses cls = threadCmdClass;
+    unsigned cmdCode;
+
+    switch (pCmd->Fld.PktType) {
+        case MN_PKT_TYPE_TRIGGER:
+            return CMD_CLASS_URGENT;
+        case MN_PKT_TYPE_EXTEND_HIGH:
+            return cls < CMD_CLASS_MOTION ? cls : CMD_CLASS_MOTION;
+        case MN_PKT_TYPE_CMD:
+            break;
+        default:
+            return cls;
+    }
+    if (pCmd->Byte.BufferSize <= CMD_LOC) {
+        return cls;
+    }
+    cmdCode = Uint8(pCmd->Byte.Buffer[CMD_LOC]);
+    if (cmdCode == MN_CMD_NODE_STOP) {
+        return CMD_CLASS_URGENT;
+    }
+    if (cmdCode >= CMD_CLASS_MOVE_FIRST && cmdCode <= CMD_CLASS_MOVE_LAST
+            && cls > CMD_CLASS_MOTION) {
+        return CMD_CLASS_MOTION;
+    }
+    return cls;
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      cmdPacer
+//
+//  DESCRIPTION:
+//      The command slots of the ring. A returned slot is handed directly to
+//      the oldest waiter of the most urgent class, so a less urgent thread
+//      that was blocked first cannot take it. The waiter is woken while the
+//      lock is held, it only reads its grant under the lock so it cannot
+//      leave, and free its event, before the wake up is done.
+//
+//      Slots are only added to the free count, under the lock, when no
+//      thread waits. A free slot is taken with a compare and swap, so a
+//      command that finds room in the ring neither takes the lock nor
+//      builds a waiter.
+//
+//  SYNOPSIS:
+cmdPacer::cmdPacer(
+    long slots) :
+    freeSlots(slots),
+    maxSlots(slots) {
+    for (unsigned cls = 0; cls < CMD_CLASS_CNT; cls++) {
+        head[cls] = tail[cls] = NULL;
+    }
+}
+
+bool cmdPacer::TakeFree() {
+    long nowFree;
+
+    while ((nowFree = freeSlots) > 0) {
+        if (CCatomicCAS(&freeSlots, nowFree, nowFree - 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool cmdPacer::Lock(
+    cmdClasses cls,
+    Uint64 *pWaitNs) {
+    if (TakeFree()) {
+        if (pWaitNs) {
+            *pWaitNs = 0;
+        }
+        return true;
+    }
+    if (unsigned(cls) >= CMD_CLASS_CNT) {
+        cls = CMD_CLASS_NORMAL;
+    }
+    WaitForSlot(cls, pWaitNs);
+    return true;
+}
+
+void cmdPacer::WaitForSlot(
+    cmdClasses cls,
+    Uint64 *pWaitNs) {
+    waiter me;
+    Uint64 startNs;
+    bool granted;
+
+    lock.Lock();
+    // A slot returned since the first look is still free, as no one waits
+    if (TakeFree()) {
+        lock.Unlock();
+        if (pWaitNs) {
+            *pWaitNs = 0;
+        }
+        return;
+    }
+    if (tail[cls]) {
+        tail[cls]->next = &me;
+    }
+    else {
+        head[cls] = &me;
+    }
+    tail[cls] = &me;
+    lock.Unlock();
+
+    startNs = coreTimeNs();
+    do {
+        me.wake.WaitFor();
+        lock.Lock();
+        granted = me.granted;
+        lock.Unlock();
+    } while (!granted);
+    if (pWaitNs) {
+        *pWaitNs = coreTimeNs() - startNs;
+    }
+}
+
+bool cmdPacer::TryLock() {
+    return TakeFree();
+}
+
+int cmdPacer::Unlock() {
+    return Unlock(1) ? 1 : 0;
+}
+
+bool cmdPacer::Unlock(
+    long count,
+    long *pFreeCount) {
+    unsigned cls;
+
+    lock.Lock();
+    // More slots back than were taken is a bookkeeping error, refuse it
+    // and leave the count as it was
+    if (freeSlots + count > maxSlots) {
+        _RPT3(_CRT_WARN, "%.1f cmdPacer::Unlock(%d) over max, %d free\n",
+              infcCoreTime(), int(count), int(freeSlots));
+        if (pFreeCount) {
+            *pFreeCount = freeSlots;
+        }
+        lock.Unlock();
+        return false;
+    }
+    for (; count > 0; count--) {
+        for (cls = 0; cls < CMD_CLASS_CNT && !head[cls]; cls++) {
+        }
+        if (cls == CMD_CLASS_CNT) {
+            CCatomicAdd(&freeSlots, 1);
+            continue;
+        }
+        waiter *pNext = head[cls];
+        head[cls] = pNext->next;
+        if (!head[cls]) {
+            tail[cls] = NULL;
+        }
+        pNext->granted = true;
+        pNext->wake.SetEvent();
+    }
+    if (pFreeCount) {
+        *pFreeCount = freeSlots;
+    }
+    lock.Unlock();
+    return true;
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::trkAlloc
+//
+//  DESCRIPTION:
+//      Claim a free response tracker without locking. Each tracker owns a
+//      bit of trkFreeMask, which is claimed by clearing it.
+//
+//  RETURNS:
+//      The tracker or NULL if none are free or the port is going away.
+//
+//  SYNOPSIS:
+respTrackInfo *netStateInfo::trkAlloc() {
+    Uint64 freeNow, freeBit;
+    do {
+        freeNow = trkFreeMask;
+        if (freeNow == 0) {
+            return (NULL);
+        }
+        // Lowest free tracker
+        freeBit = freeNow & (~freeNow + 1);
+    } while (!CCatomicCAS(&trkFreeMask, freeNow, freeNow & ~freeBit));
+    return (pTrkFixedList[CClowestBit(freeBit)]);
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::trkFree
+//
+//  DESCRIPTION:
+//      Return a tracker claimed by trkAlloc.
+//
+//  SYNOPSIS:
+void netStateInfo::trkFree(respTrackInfo *pTrk) {
+    // An orphan is done once its late response came or it expired
+    if (pTrk->orphaned) {
+        pTrk->orphaned = FALSE;
+        CCatomicSub(&nOrphans, 1);
+    }
+    CCatomicFetchOr(&trkFreeMask, Uint64(1) << pTrk->slot);
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::respRelease
+//
+//  DESCRIPTION:
+//      Retire one outstanding response, never going below zero as a flush
+//      may have cleared the count already.
+//
+//  RETURNS:
+//      The number of responses still outstanding.
+//
+//  SYNOPSIS:
+nodeulong netStateInfo::respRelease() {
+    nodeulong nowCnt;
+    do {
+        nowCnt = nRespOutstanding;
+        if (nowCnt == 0) {
+            return (0);
+        }
+    } while (!CCatomicCAS(&nRespOutstanding, nowCnt, nowCnt - 1));
+    return (nowCnt - 1);
+}
+//                                                                             *
+//******************************************************************************
+
+
 //******************************************************************************
 //  NAME                                                                       *
 //      netStateInfo::isRecoveryThread
@@ -735,7 +1129,8 @@ nodebool netStateInfo::isRecoveryThread() {
 //      netStateInfo::isReadThread
 //
 //  DESCRIPTION:
-//      Return true if the current thread is the read thread.
+//      Return true if the current thread is the read thread. In single-hop
+//      mode the serial reader completes responses and counts as well.
 //
 //  RETURNS:
 //      bool
@@ -744,54 +1139,79 @@ nodebool netStateInfo::isRecoveryThread() {
 nodebool netStateInfo::isReadThread() {
     nodeulong curThread = CThread::CurrentThreadID();
 
+    if (SysInventory[cNum].SingleHopRx && pSerialPort
+            && pSerialPort->IsReaderThread()) {
+        return (TRUE);
+    }
     return (ReadThread.ThreadID() == curThread);
 }
 //                                                                             *
 //******************************************************************************
 
 
+//******************************************************************************
+//  NAME                                                                       *
+//      tracePktCopy
+//
+//  DESCRIPTION:
+//      Store only the used bytes of <pkt> into a trace ring slot and return
+//      that count.
+//
+//  SYNOPSIS:
+static Uint8 tracePktCopy(Uint8 *dest, const packetbuf *pkt) {
+    size_t len = pkt->Byte.BufferSize;
+    if (len > MN_NET_PACKET_MAX) {
+        len = MN_NET_PACKET_MAX;
+    }
+    memcpy(dest, pkt->Byte.Buffer, len);
+    return (Uint8)len;
+}
+//                                                                             *
+//******************************************************************************
+
+
 //******************************************************************************
 //  NAME                                                                       *
 //      mnNetInvRecords::logSend
 //
 //  DESCRIPTION:
-//      Log the sent item and return the TX serial number.
+//      Log the sent item and return the TX serial number. Concurrent
+//      senders claim distinct slots and never wait on each other or on a
+//      trace dump.
 //
 //  RETURNS:
 //      this entry's serial number
 //
 //  SYNOPSIS:
 unsigned mnNetInvRecords::logSend(packetbuf *cmd, cnErrCode theErr,
-                                  double timeStamp) {
-    unsigned nextSerNum = sendSerNum, indx;
+                                  Uint64 timeNs) {
+    unsigned nextSerNum;
     if (!pNCS) {
-        return nextSerNum;
+        return sendSerNum;
     }
-    TXlogLock.Lock();
     // Save and increment the serial number
-    nextSerNum = sendSerNum++;
-    // Wrap the log file index
-    indx = nextSerNum % SEND_DEPTH;
+    nextSerNum = CCatomicFetchAdd(&sendSerNum, 1);
     // Setup issues!
     assert(txTraces);
 
     if (TraceActive) {
-        txTraceBuf *pTxTrace;                   // Pointer to tx traces
         // Make shortcut to transmit trace log entry for the rest of command
-        pTxTrace = &txTraces[indx];
-        txTraceIndx = indx;
-        // Log the send number
-        pTxTrace->order = nextSerNum;
+        txTraceSlot *pTxTrace = &txTraces[nextSerNum % SEND_DEPTH];
+        Uint64 stamp = 2 * Uint64(nextSerNum);
+        // Mark slot busy for readers
+        pTxTrace->seq = stamp + 1;
+        CCmemoryBarrier();
         // Log when it left here
-        pTxTrace->timeStamp = timeStamp;
-        // Log the command itself
-        pTxTrace->packet = *cmd;
+        pTxTrace->timeNs = timeNs;
         // Log command depth
         pTxTrace->depth = pNCS->nRespOutstanding;
         // Log as a failure
-        pTxTrace->failed = (unsigned short)theErr;
+        pTxTrace->failed = (Uint16)theErr;
+        // Log the used part of the command itself
+        pTxTrace->len = tracePktCopy(pTxTrace->bytes, cmd);
+        CCmemoryBarrier();
+        pTxTrace->seq = stamp + 2;
     }
-    TXlogLock.Unlock();
 #if defined(_DEBUG)
     if (theErr != MN_OK) {
         _RPT3(_CRT_WARN, "%.1f TX Error(%d): 0x%x\n", infcCoreTime(),
@@ -805,6 +1225,280 @@ unsigned mnNetInvRecords::logSend(packetbuf *cmd, cnErrCode theErr,
 //******************************************************************************
 
 
+//******************************************************************************
+//  NAME                                                                       *
+//      mnNetInvRecords::logRxRecord
+//
+//  DESCRIPTION:
+//      Claim the next receive serial number and, if tracing, fill its ring
+//      slot.
+//
+//  SYNOPSIS:
+void mnNetInvRecords::logRxRecord(
+    packetbuf *readBuf,
+    cnErrCode theErr,
+    Uint32 sendCnt,
+    Uint32 sendSer,
+    Uint64 timeNs) {
+    Uint32 rxSerNum = CCatomicFetchAdd(&respSerNum, 1);
+
+    // Do actual tracing work if turned on
+    if (TraceActive) {
+        // Setup "shortcuts"
+        rxTraceSlot *pRXtrc = &rxTraces[rxSerNum % RECV_DEPTH];
+        Uint64 stamp = 2 * Uint64(rxSerNum);
+        // Mark slot busy for readers
+        pRXtrc->seq = stamp + 1;
+        CCmemoryBarrier();
+        // Log the receipt time
+        pRXtrc->timeNs = timeNs;
+        // Log the used part of the packet
+        pRXtrc->len = tracePktCopy(pRXtrc->bytes, readBuf);
+        pRXtrc->sendCnt = sendCnt;
+        pRXtrc->sendSer = sendSer;
+        // Record the error code
+        pRXtrc->error = theErr;
+        CCmemoryBarrier();
+        pRXtrc->seq = stamp + 2;
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      mnNetInvRecords::logMark
+//
+//  DESCRIPTION:
+//      Record a port event in the receive trace as a marker record. The
+//      <info> byte, or the <len> bytes at <pData>, are stored as the
+//      packet.
+//
+//  SYNOPSIS:
+void mnNetInvRecords::logMark(
+    Uint32 kind,
+    cnErrCode theErr,
+    Uint8 info) {
+    logMark(kind, theErr, &info, 1);
+}
+
+void mnNetInvRecords::logMark(
+    Uint32 kind,
+    cnErrCode theErr,
+    const void *pData,
+    Uint8 len) {
+    packetbuf markPkt;
+
+    if (!pNCS || !rxTraces) {
+        return;
+    }
+    if (len > MN_NET_PACKET_MAX) {
+        len = MN_NET_PACKET_MAX;
+    }
+    memcpy(markPkt.Byte.Buffer, pData, len);
+    markPkt.Byte.BufferSize = len;
+    logRxRecord(&markPkt, theErr, kind, TRACE_MARK_SER, coreTimeNs());
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      startupTimer
+//
+//  DESCRIPTION:
+//      Time a startup phase of port <cNum> into its StartupProfile. Begin
+//      and Finish bracket the whole startup. Only the port's initializing
+//      thread writes its profile.
+//
+//  SYNOPSIS:
+startupTimer::startupTimer(
+    netaddr cNum,
+    startupPhases phase,
+    int node) :
+    m_cNum(cNum),
+    m_phase(phase),
+    m_node(node),
+    m_startNs(coreTimeNs()),
+    m_startCmds(SysInventory[cNum].sendSerNum),
+    m_running(true) {
+}
+
+startupTimer::~startupTimer() {
+    End();
+}
+
+void startupTimer::End() {
+    mnNetInvRecords &theNet = SysInventory[m_cNum];
+    mnStartupProfile &prof = theNet.StartupProfile;
+    traceStartupMark mark;
+
+    if (!m_running) {
+        return;
+    }
+    m_running = false;
+    Uint64 durNs = coreTimeNs() - m_startNs;
+    Uint32 cmds = theNet.sendSerNum - m_startCmds;
+    prof.Phase[m_phase].Runs++;
+    prof.Phase[m_phase].Commands += cmds;
+    prof.Phase[m_phase].DurationMs += durNs / 1e6;
+    if (m_node >= 0 && m_node < int(MN_API_MAX_NODES)) {
+        prof.Node[m_node].Runs++;
+        prof.Node[m_node].Commands += cmds;
+        prof.Node[m_node].DurationMs += durNs / 1e6;
+    }
+    if (InfcStartupTrace) {
+        mark.phase = Uint8(m_phase);
+        mark.node = m_node < 0 ? TRACE_MARK_PORT : Uint8(m_node);
+        mark.durationUs = durNs / 1000 > 0xFFFFFFFFULL
+                          ? 0xFFFFFFFFU : Uint32(durNs / 1000);
+        mark.commands = cmds;
+        theNet.logMark(TRACE_MARK_STARTUP, MN_OK, &mark, sizeof(mark));
+    }
+}
+
+void startupTimer::Begin(
+    netaddr cNum) {
+    mnNetInvRecords &theNet = SysInventory[cNum];
+
+    memset(&theNet.StartupProfile, 0, sizeof(theNet.StartupProfile));
+    theNet.StartupProfile.StartMs = infcCoreTime();
+    theNet.StartupCmds0 = theNet.sendSerNum;
+}
+
+void startupTimer::Finish(
+    netaddr cNum,
+    cnErrCode result) {
+    mnNetInvRecords &theNet = SysInventory[cNum];
+
+    theNet.StartupProfile.TotalMs = infcCoreTime()
+                                    - theNet.StartupProfile.StartMs;
+    theNet.StartupProfile.Commands = theNet.sendSerNum - theNet.StartupCmds0;
+    theNet.StartupProfile.Result = result;
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      mnNetInvRecords::logLatency
+//
+//  DESCRIPTION:
+//      Add the outcome of <cmd> to the port, node and command code latency
+//      histograms. Only atomic operations are used so completing threads
+//      never wait on each other or on a reader. logQueueWait does the same
+//      for the time a command of a class waited for the ring.
+//
+//  SYNOPSIS:
+static void latencyAdd(
+    mnLatencyHist &hist,
+    Uint64 us) {
+    Uint64 seenMax = hist.MaxUs;
+
+    CCatomicFetchAdd(&hist.Buckets[mnLatencyHist::BucketOf(us)], 1);
+    CCatomicFetchAdd(&hist.SumUs, us);
+    CCatomicFetchAdd(&hist.Count, 1);
+    while (us > seenMax) {
+        Uint64 was = CCatomicCASval(&hist.MaxUs, seenMax, us);
+        if (was == seenMax) {
+            break;
+        }
+        seenMax = was;
+    }
+}
+
+void mnNetInvRecords::logLatency(
+    const packetbuf &cmd,
+    Uint64 execNs,
+    bool timedOut) {
+    latencyTables *pTables = pLatency;
+    mnLatencyHist *pCmdHist = NULL;
+    Uint64 us = (execNs + 500) / 1000;
+
+    if (!pTables) {
+        return;
+    }
+    if (cmd.Fld.PktType == MN_PKT_TYPE_CMD && cmd.Byte.BufferSize > CMD_LOC) {
+        pCmdHist = &pTables->cmd[Uint8(cmd.Byte.Buffer[CMD_LOC])];
+    }
+    mnLatencyHist &nodeHist = pTables->node[cmd.Fld.Addr];
+    if (timedOut) {
+        CCatomicFetchAdd(&pTables->port.Timeouts, 1);
+        CCatomicFetchAdd(&nodeHist.Timeouts, 1);
+        if (pCmdHist) {
+            CCatomicFetchAdd(&pCmdHist->Timeouts, 1);
+        }
+        return;
+    }
+    latencyAdd(pTables->port, us);
+    latencyAdd(nodeHist, us);
+    if (pCmdHist) {
+        latencyAdd(*pCmdHist, us);
+    }
+}
+
+void mnNetInvRecords::logQueueWait(
+    cmdClasses cls,
+    Uint64 waitNs) {
+    latencyTables *pTables = pLatency;
+
+    if (pTables && unsigned(cls) < CMD_CLASS_CNT) {
+        latencyAdd(pTables->queue[cls], (waitNs + 500) / 1000);
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      mnNetInvRecords::paramFlightsSent
+//
+//  DESCRIPTION:
+//      Called with <pCmd> just sent. Unless it is a parameter read, reads in
+//      flight to its node may have been answered before it took effect, so
+//      they are unlinked and later readers send their own. Threads already
+//      joined still share them.
+//
+//  SYNOPSIS:
+void mnNetInvRecords::paramFlightsSent(
+    const packetbuf *pCmd) {
+    multiaddr theAddr;
+
+    if (!pParamFlights || !pNCS) {
+        return;
+    }
+    if (pCmd->Fld.PktType == MN_PKT_TYPE_CMD
+            && pCmd->Byte.BufferSize > CMD_LOC) {
+        switch (pCmd->Byte.Buffer[CMD_LOC]) {
+            case MN_CMD_GET_PARAM0:
+            case MN_CMD_GET_PARAM1:
+            case MN_CMD_GET_PARAM2:
+            case MN_CMD_GET_PARAM3:
+                return;
+            default:
+                break;
+        }
+    }
+    theAddr = MULTI_ADDR(pNCS->cNum, pCmd->Fld.Addr);
+    paramFlightLock.Lock();
+    for (paramFlight **ppLink = &pParamFlights; *ppLink;) {
+        if ((*ppLink)->addr == theAddr) {
+            *ppLink = (*ppLink)->next;
+        }
+        else {
+            ppLink = &(*ppLink)->next;
+        }
+    }
+    paramFlightLock.Unlock();
+}
+//                                                                             *
+//******************************************************************************
+
+
 //******************************************************************************
 //  NAME                                                                       *
 //      mnNetInvRecords::logReceive
@@ -820,48 +1514,27 @@ double mnNetInvRecords::logReceive(
     packetbuf *readBuf,
     cnErrCode theErr,
     respTrackInfo *fillInfo,
-    double timeStamp) {
-    size_t rxSerNum, rxTraceIndex;
-    rxTraceBuf *pRXtrc;
-    txTraceBuf *pTXtrc;
+    Uint64 timeNs) {
     double eTime = 0;
     if (!pNCS) {
         return 0;
     }
     // Setup issues!
     assert(rxTraces);
-    assert(txTraces);
 
-    RXlogLock.Lock();
-    rxSerNum = respSerNum++;
-    // Wrap the log item
-    rxTraceIndex = rxTraceIndx = rxSerNum % RECV_DEPTH;
-    // Setup "shortcuts"
-    pRXtrc = &rxTraces[rxTraceIndex];
-    // Do actual tracing work if turned on
-    if (TraceActive) {
-        // Log the serial number of received packet
-        pRXtrc->order = (Uint32)rxSerNum;
-        // Log the receipt time
-        pRXtrc->timeStamp = timeStamp;
-        // Log the packet
-        pRXtrc->packet = *readBuf;
-        if (fillInfo) {
-            // Expected a response here
-            pTXtrc = &txTraces[fillInfo->sendSerNum % SEND_DEPTH];
-            pRXtrc->sendCnt = fillInfo->nSentAtAddr;
-            pRXtrc->sendSer = fillInfo->sendSerNum;
-            eTime = pRXtrc->timeStamp - pTXtrc->timeStamp;
-        }
-        else {
-            // Unexpected response or error
-            pRXtrc->sendCnt = -1;
-            pRXtrc->sendSer = -1;
-        }
+    if (fillInfo) {
+        // Expected a response here
+        logRxRecord(readBuf, theErr, fillInfo->nSentAtAddr,
+                    fillInfo->sendSerNum, timeNs);
+    }
+    else {
+        // Unexpected response or error
+        logRxRecord(readBuf, theErr, -1, -1, timeNs);
+    }
+    // Time on the wire from the integer stamps, the ms trace copy rounds
+    if (fillInfo && timeNs > fillInfo->cmdStartNs) {
+        eTime = coreNsToMs(timeNs - fillInfo->cmdStartNs);
     }
-    // Record the error code
-    pRXtrc->error = theErr;
-    RXlogLock.Unlock();
 #if 1 //defined(_DEBUG)
     if (theErr != MN_OK && pNCS->cNum == 1) {
         _RPT4(_CRT_WARN,
@@ -883,7 +1556,7 @@ double mnNetInvRecords::logReceive(
 //      Remove the head item from the <respArea> nodelist and relieve the
 //      command pacing semaphore by one item.
 //
-//      NOTE: The response database should be locked when this function is
+//      NOTE: The <respArea> list lock should be held when this function is
 //      called.
 //
 //  SYNOPSIS:
@@ -908,13 +1581,10 @@ void netStateInfo::removeHeadDBitem(
         pRespArea->tail = NULL;
     }
     // Signal we have something
-    pThisInfo->evtRespWait.SetEvent();
-    // Synchronize with others waiting
-    pThisInfo->evtRespWait.WaitFor();
+    pThisInfo->respDone.Fire();
 
     // Return this tracker to pool
-    ++pTrkTail;                 // Create space at the end
-    *pTrkTail = pThisInfo;
+    trkFree(pThisInfo);
     // Release the command semaphore allowing one more
     // There is one less to expect now
 #if defined(_DEBUG)
@@ -924,10 +1594,9 @@ void netStateInfo::removeHeadDBitem(
 #endif
     if (dataOK) {
         // Make sure the read thread keeps running
-        if (nRespOutstanding > 0)
-            if (--nRespOutstanding > 0) {
-                ReadThread.Start();
-            }
+        if (respRelease() > 0) {
+            ReadThread.Start();
+        }
     }
     else {
         infcErrInfo semaErr;
@@ -952,7 +1621,7 @@ void netStateInfo::removeHeadDBitem(
 //      This is the function called to remove a database item from the running
 //      queue. The command pacing semaphore is relieved by one item.
 //
-//      NOTE: The response database should be locked when this function is
+//      NOTE: The <respArea> list lock should be held when this function is
 //      called.
 //
 //  SYNOPSIS:
@@ -998,19 +1667,13 @@ void netStateInfo::removeThisDBitem(
         return;
     }
     // Signal we have something
-    if (pRespInfo->evtRespWait.isOK()) {
 #if TRACE_LOW_PRINT
-        _RPT2(_CRT_WARN, "%.1f removeDB wait event set hndl=0x%0lx\n",
-              infcCoreTime(),
-              reinterpret_cast<long>(pRespInfo->evtRespWait.GetHandle()));
+    _RPT2(_CRT_WARN, "%.1f removeDB wait released slot=%u\n",
+          infcCoreTime(), pRespInfo->slot);
 #endif
-        pRespInfo->evtRespWait.SetEvent();
-        // Synchronize with others waiting
-        pRespInfo->evtRespWait.WaitFor();
-    }
-    // Return this tracker to the end of the pool
-    ++pTrkTail;
-    *pTrkTail = pRespInfo;
+    pRespInfo->respDone.Fire();
+    // Return this tracker to the pool
+    trkFree(pRespInfo);
     // Release the command semaphore allowing one more
     // There is one less to expect now
 #ifdef _DEBUG
@@ -1019,10 +1682,9 @@ void netStateInfo::removeThisDBitem(
     dataOK = CmdPaceSemaphore.Unlock();
 #endif
     if (dataOK) {
-        if (nRespOutstanding > 0)
-            if (--nRespOutstanding > 0) {
-                ReadThread.Start();
-            }
+        if (respRelease() > 0) {
+            ReadThread.Start();
+        }
     }
     else {
         infcErrInfo semaErr;
@@ -1039,6 +1701,159 @@ void netStateInfo::removeThisDBitem(
 //*****************************************************************************
 
 
+//****************************************************************************
+//  NAME                                                                     *
+//      netStateInfo::timeoutDBitem
+//
+//  DESCRIPTION:
+//      Retire <pRespInfo>, whose waiter has timed out. Responses are matched
+//      to commands by their order at each node, so a response arriving
+//      after its entry was removed would be taken for the next command's.
+//      An entry that timed out before the fixed time-out is therefore left
+//      in place as an orphan. It absorbs the late response, or is removed
+//      by expireAsyncItems once the fixed time-out has passed too.
+//
+//      NOTE: The <pRespArea> list lock must be held.
+//
+//  SYNOPSIS:
+void netStateInfo::timeoutDBitem(
+    respTrackInfo *pRespInfo,
+    respNodeList *pRespArea) {
+    if (pRespInfo->respTimeoutNs >= coreMsToNs(InfcRespTimeOut)) {
+        removeThisDBitem(pRespInfo, pRespArea);
+        return;
+    }
+    // The waiter's response area is no longer ours to fill
+    pRespInfo->buf = NULL;
+    pRespInfo->orphaned = TRUE;
+    CCatomicAdd(&nOrphans, 1);
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::completeHeadResp
+//
+//  DESCRIPTION:
+//      Deliver <readBuf> to the oldest waiter on <pNodeList>, record its
+//      statistics and return its tracker. Submitted commands are completed
+//      after the list lock is released.
+//
+//      NOTE: The <pNodeList> list lock must be held and its head non-NULL.
+//      The lock is released on return.
+//
+//  SYNOPSIS:
+void netStateInfo::completeHeadResp(
+    respNodeList *pNodeList,
+    packetbuf &readBuf,
+    Uint64 rxNs,
+    Uint64 readNs) {
+    mnNetInvRecords &theNet = SysInventory[cNum];
+    respTrackInfo *pFillInfo = pNodeList->head;
+    asyncCmdInfo *pAsync;
+
+    // Say we got something and copy to user buffer
+    pFillInfo->bufOK = TRUE;
+    if (pFillInfo->buf != NULL) {
+        *(pFillInfo->buf) = readBuf;
+    }
+    // Record time it took to read the response
+    pFillInfo->stats.rxTime = coreNsToMs(readNs);
+    pFillInfo->stats.pResp = pFillInfo->buf;
+    // Record receive time - send time + queue delay + overhead
+    pFillInfo->stats.pacedTime = coreNsToMs(coreTimeNs()
+                                            - pFillInfo->funcStartNs);
+    // Record receive time - send time and packet received
+    pFillInfo->stats.execTime = theNet.logReceive(&readBuf, MN_OK,
+                                                  pFillInfo, rxNs);
+    Uint64 rttNs = rxNs > pFillInfo->cmdStartNs
+                   ? rxNs - pFillInfo->cmdStartNs : 0;
+    // An orphan's time-out was already counted
+    if (!pFillInfo->orphaned) {
+        theNet.logLatency(pFillInfo->stats.cmd, rttNs, false);
+    }
+    // Feed the adaptive time-out of this node and class
+    rtoClasses rtoClass = rtoClassOf(&pFillInfo->stats.cmd);
+    if (rtoClass != RTO_CLASS_FIXED) {
+        pNodeList->rto[rtoClass].Sample(rttNs);
+    }
+    // Signal performance outcomes
+    if (userCmdCompleteFunc != NULL && theNet.TraceActive) {
+        (*userCmdCompleteFunc)(cNum, &pFillInfo->stats);
+    }
+    // Submitted commands complete here
+    pAsync = pFillInfo->pAsync;
+    pFillInfo->pAsync = NULL;
+    // We are done using this response, return it back to free pool
+    removeHeadDBitem(pNodeList);
+    pNodeList->listLock.Unlock();
+    if (pAsync != NULL) {
+        completeAsync(pAsync, MN_OK);
+    }
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::singleHopRx
+//
+//  DESCRIPTION:
+//      Serial reader packet hook used in single-hop receive mode. Expected
+//      responses are matched to their tracker and completed right on the
+//      serial reader thread, skipping the hand-off to the read thread and
+//      its wake-up. Everything else, such as node initiated packets, net
+//      rejects and unsolicited responses, is left for the read thread so
+//      callbacks keep running there. While the read thread is handling a
+//      packet this one is left for it too, to keep responses in order.
+//
+//  RETURNS:
+//      true if the packet was consumed
+//
+//  SYNOPSIS:
+bool netStateInfo::singleHopRx(
+    void *context,
+    packetbuf &thePacket) {
+    netStateInfo *pNCS = static_cast<netStateInfo *>(context);
+    mnNetInvRecords &theNet = SysInventory[pNCS->cNum];
+    respNodeList *pNodeList;
+
+    // Only plain responses to our commands
+    if (pNCS->SelfDestruct || pNCS->readThreadRx
+            || thePacket.Byte.BufferSize == 0
+            || thePacket.Fld.Src != MN_SRC_HOST
+            || theNet.OpenState == FLASHING) {
+        return (false);
+    }
+    if ((unsigned)thePacket.Fld.PktType == MN_PKT_TYPE_ERROR) {
+        netErrGeneric *pErrPkt =
+            (netErrGeneric *)&thePacket.Byte.Buffer[RESP_LOC];
+        if (pErrPkt->Fld.ErrCls == ND_ERRCLS_NET) {
+            return (false);
+        }
+    }
+    pNodeList = pNCS->respList(respListIndex(&thePacket));
+    pNodeList->listLock.Lock();
+    if (pNodeList->head == NULL) {
+        // Unsolicited, let the read thread report it
+        pNodeList->listLock.Unlock();
+        return (false);
+    }
+#if TRACE_SEND_RESP
+    DUMP_PKT(pNCS->cNum, "singleHopRx   ", &thePacket, true);
+#endif
+    CCatomicAdd(&pNCS->nPktsRcvd, 1);
+    pNodeList->respCnt++;
+    pNCS->completeHeadResp(pNodeList, thePacket, coreTimeNs(), 0);
+    return (true);
+}
+//                                                                            *
+//*****************************************************************************
+
+
 //******************************************************************************
 //  NAME                                                                       *
 //      netStateInfo::waitForIdle
@@ -1052,6 +1867,215 @@ void netStateInfo::waitForIdle() {
         infcSleep(100);
     }
 }
+//                                                                            *
+//*****************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::completeAsync
+//
+//  DESCRIPTION:
+//      Post the outcome of a command started by infcSubmitCommand, signal
+//      any waiter, run its callback and drop the tracking reference. The
+//      tracker must already be detached from <pAsync>.
+//
+//  SYNOPSIS:
+void netStateInfo::completeAsync(
+    asyncCmdInfo *pAsync,
+    cnErrCode theErr) {
+    pAsync->result = theErr;
+    // Make the result visible before done
+    CCmemoryBarrier();
+    pAsync->done = TRUE;
+    pAsync->evtDone.SetEvent();
+    if (pAsync->doneFunc != NULL) {
+        (*pAsync->doneFunc)(pAsync, theErr, pAsync->pResp, pAsync->context);
+    }
+    CCatomicSub(&nAsyncOutstanding, 1);
+    // No longer in play
+    if (m_cmdsInPlay.Decr() == 0) {
+        CmdsIdle.SetEvent();
+    }
+    if (CCatomicSub(&pAsync->refs, 1) == 0) {
+        delete pAsync;
+    }
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::expireAsyncItems
+//
+//  DESCRIPTION:
+//      Submitted commands have no thread waiting on their response event,
+//      so the read thread calls this periodically to apply the time-out
+//      infcRunCommand would have. Each overdue command is retired by
+//      timeoutDBitem and completed with MN_ERR_RESP_TIMEOUT outside of its
+//      list lock. Orphans whose late response never came are removed once
+//      the fixed time-out has passed.
+//
+//  SYNOPSIS:
+void netStateInfo::expireAsyncItems() {
+    mnNetInvRecords &theNet = SysInventory[cNum];
+    respTrackInfo *pExpired;
+    respNodeList *pExpiredArea;
+    asyncCmdInfo *pAsync;
+    Uint64 ceilNs = coreMsToNs(InfcRespTimeOut);
+    unsigned i;
+
+    for (;;) {
+        Uint64 now = coreTimeNs();
+        pExpired = NULL;
+        pExpiredArea = NULL;
+        for (i = 0; i < RESP_LIST_CNT && !pExpired; i++) {
+            respNodeList *pList = respList(i);
+            pList->listLock.Lock();
+            for (respTrackInfo *pInfo = pList->head; pInfo;
+                    pInfo = pInfo->next) {
+                Uint64 limitNs = pInfo->orphaned ? ceilNs
+                                 : pInfo->respTimeoutNs;
+                if ((pInfo->pAsync || pInfo->orphaned)
+                        && now > pInfo->cmdStartNs
+                        && (now - pInfo->cmdStartNs) > limitNs) {
+                    pExpired = pInfo;
+                    pExpiredArea = pList;
+                    break;
+                }
+            }
+            // Keep the list with the expired item locked
+            if (!pExpired) {
+                pList->listLock.Unlock();
+            }
+        }
+        if (!pExpired) {
+            return;
+        }
+        if (pExpired->orphaned) {
+            // Its time-out was reported when it was orphaned
+            removeThisDBitem(pExpired, pExpiredArea);
+            pExpiredArea->listLock.Unlock();
+            continue;
+        }
+        pAsync = pExpired->pAsync;
+        pExpired->pAsync = NULL;
+        DUMP_PKT(cNum, "**Timeout cmd ", &pExpired->stats.cmd);
+        // Add failure to the rx log file
+        if (theNet.TraceActive) {
+            packetbuf nullPkt;
+
+            // Create null packet buffer
+            nullPkt.Byte.BufferSize = 0;
+            nullPkt.Byte.Buffer[0] = nullPkt.Byte.Buffer[1] = 0;
+            // Assign a receive trace record
+            theNet.logReceive(&nullPkt, MN_ERR_RESP_TIMEOUT,
+                              pExpired, now);
+        }
+        theNet.logLatency(pExpired->stats.cmd, 0, true);
+        rtoClasses rtoClass = rtoClassOf(&pExpired->stats.cmd);
+        if (rtoClass != RTO_CLASS_FIXED) {
+            pExpiredArea->rto[rtoClass].backoff++;
+        }
+        if (theNet.OpenState == OPENED_ONLINE) {
+            // Send off the error callback
+            infcErrInfo errInfo;
+            errInfo.errCode = MN_ERR_RESP_TIMEOUT;
+            errInfo.cNum = cNum;
+            infcCopyPktToPkt18(&errInfo.response, &pExpired->stats.cmd);
+            errInfo.node = pExpired->stats.cmd.Fld.Addr;
+            infcFireErrCallback(&errInfo);
+        }
+        // Remove this as an expected item
+        timeoutDBitem(pExpired, pExpiredArea);
+        pExpiredArea->listLock.Unlock();
+        completeAsync(pAsync, MN_ERR_RESP_TIMEOUT);
+    }
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::abandonAsync
+//
+//  DESCRIPTION:
+//      Remove <pAsync> from the response database and complete it with
+//      MN_ERR_RESP_TIMEOUT, so its response area is not written after its
+//      submitter has given up on it. If it is not found its completion is
+//      already under way on another thread.
+//
+//  SYNOPSIS:
+void netStateInfo::abandonAsync(
+    asyncCmdInfo *pAsync) {
+    unsigned i;
+
+    for (i = 0; i < RESP_LIST_CNT; i++) {
+        respNodeList *pList = respList(i);
+        pList->listLock.Lock();
+        for (respTrackInfo *pInfo = pList->head; pInfo;
+                pInfo = pInfo->next) {
+            if (pInfo->pAsync == pAsync) {
+                pInfo->pAsync = NULL;
+                SysInventory[cNum].logLatency(pInfo->stats.cmd, 0, true);
+                timeoutDBitem(pInfo, pList);
+                pList->listLock.Unlock();
+                completeAsync(pAsync, MN_ERR_RESP_TIMEOUT);
+                return;
+            }
+        }
+        pList->listLock.Unlock();
+    }
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::cancelAsync
+//
+//  DESCRIPTION:
+//      A flush runs with the list locks held, where completing a submitted
+//      command could run its callback under them. The flush detaches the
+//      command from its tracker and queues it here instead.
+//
+//  SYNOPSIS:
+void netStateInfo::cancelAsync(
+    asyncCmdInfo *pAsync) {
+    canceledLock.Lock();
+    pAsync->nextCanceled = pCanceledAsync;
+    pCanceledAsync = pAsync;
+    canceledLock.Unlock();
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netStateInfo::completeCanceled
+//
+//  DESCRIPTION:
+//      Complete the commands queued by cancelAsync with MN_ERR_CANCELED.
+//      The flush's caller runs this after releasing the list locks.
+//
+//  SYNOPSIS:
+void netStateInfo::completeCanceled() {
+    asyncCmdInfo *pAsync, *pNext;
+
+    canceledLock.Lock();
+    pAsync = pCanceledAsync;
+    pCanceledAsync = NULL;
+    canceledLock.Unlock();
+    while (pAsync) {
+        pNext = pAsync->nextCanceled;
+        completeAsync(pAsync, MN_ERR_CANCELED);
+        pAsync = pNext;
+    }
+}
 /// \endcond                                                                  *
 //*****************************************************************************
 
@@ -1123,8 +2147,9 @@ int readPktThread::Run(void *context) {
     packetbuf readBuf;
     respTrackInfo *pFillInfo;
     respNodeList *pNodeList;
-    double eTime = 0;   // Execution time
-    double rxTime;
+    Uint64 eTime = 0;   // Read time (ns)
+    Uint64 rxTime = 0;  // Core time packet arrived (ns)
+    Uint64 lastExpireAt = 0;            // Last submitted cmd time-out scan
 
     // Initialize our netStateInfo pointer to allow interactions with
     // the network.
@@ -1211,6 +2236,15 @@ int readPktThread::Run(void *context) {
                     pNCS->ctsCount = errReport.CTScnt;
                 }
 
+                // Time-out submitted commands, no thread waits on them,
+                // and remove orphans whose response never came
+                if ((pNCS->nAsyncOutstanding > 0 || pNCS->nOrphans > 0)
+                        && (coreTimeNs() - lastExpireAt)
+                        >= coreMsToNs(RD_THREAD_PREMPTIVE_WAIT)) {
+                    lastExpireAt = coreTimeNs();
+                    pNCS->expireAsyncItems();
+                }
+
                 //DEBUG
                 //_RPT1(_CRT_WARN, "%.1f *\n", infcCoreTime());
                 // Read should be OK if comm event signalled, we there is a packet,
@@ -1224,13 +2258,14 @@ int readPktThread::Run(void *context) {
                 if (doTheRead && !((m_pTermFlag != NULL) && *m_pTermFlag)) {
                     // Yes, read it now
                     readBuf.Byte.BufferSize = 0;            // Null in case of failure
-                    eTime = infcCoreTime();                 // Make sure time is reset
+                    eTime = coreTimeNs();                   // Make sure time is reset
+                    // Keep the single-hop hook off until this one is done
+                    pNCS->readThreadRx = TRUE;
+                    CCmemoryBarrier();
                     theErr = infcGetResponse(pNCS->cNum, &readBuf);
-                    rxTime = infcCoreTime();
+                    rxTime = coreTimeNs();
                     eTime = rxTime - eTime;
 
-                    // Lock other command starts and housekeepers out here
-                    ENTER_LOCK("readThreadProc");
                     // How did the read go?
                     if (theErr == MN_OK) {
 #if TRACE_SEND_RESP
@@ -1265,8 +2300,6 @@ int readPktThread::Run(void *context) {
                             theErr = MN_ERR_NULL_RETURN;
                             // Log the outcome
                             theNet.logReceive(&readBuf, theErr, NULL, rxTime);
-                            // Release cmd lock on database
-                            EXIT_LOCK("readThreadProc (nil buffer)");
                         }
                         else {
                             // Extract address once to "automatic"
@@ -1280,6 +2313,9 @@ int readPktThread::Run(void *context) {
                                 // This is a regular packet
                                 pNodeList = &pNCS->respNodeState[respAddr];
                             }
+                            // Lock command starts and housekeepers for this
+                            // list out, other nodes proceed
+                            pNodeList->listLock.Lock();
                             // Update statistic
                             pNodeList->respCnt++;
                             // Get the head of our database item
@@ -1296,7 +2332,7 @@ int readPktThread::Run(void *context) {
                                     ((unsigned)readBuf.Fld.PktType == MN_PKT_TYPE_ERROR)
                                     && (pErrPkt->Fld.ErrCls == ND_ERRCLS_NET);
                                 if (isNetReject) {
-                                    EXIT_LOCK("readThreadProc (isNetReject)");
+                                    pNodeList->listLock.Unlock();
                                     //In this case, the host noticed a net error while reading in
                                     // a packet; increment the host diagStats to signal to those who
                                     // might care
@@ -1421,31 +2457,9 @@ int readPktThread::Run(void *context) {
                                                   pNodeList->respCnt);
                                     }
 #endif
-                                    // Say we got something and copy to user buffer
-                                    pFillInfo->bufOK = TRUE;
-                                    if (pFillInfo->buf != NULL) {
-                                        *(pFillInfo->buf) = readBuf;
-                                    }
-                                    // Record time it took to read the response
-                                    pFillInfo->stats.rxTime = eTime;
-                                    pFillInfo->stats.pResp = pFillInfo->buf;
-                                    // Record receive time - send time + queue delay + overhead
-                                    pFillInfo->stats.pacedTime =
-                                        infcCoreTime() - pFillInfo->funcStartAt;
-                                    // Record receive time - send time and packet received
-                                    pFillInfo->stats.execTime
-                                        = theNet.logReceive(&readBuf, theErr,
-                                                            pFillInfo, rxTime);
-                                    // Signal performance outcomes
-                                    if (userCmdCompleteFunc != NULL &&
-                                        theNet.TraceActive) {
-                                        (*userCmdCompleteFunc)(pNCS->cNum,
-                                                               &pFillInfo->stats);
-                                    }
-                                    // We are done using this response, return it back to free pool
-                                    pNCS->removeHeadDBitem(pNodeList);
-                                    // Log the outcome
-                                    EXIT_LOCK("readThreadProc (norm expect)");
+                                    // Copy to the waiter and restart it
+                                    pNCS->completeHeadResp(pNodeList, readBuf,
+                                                           rxTime, eTime);
 #if TRACE_HIGH_LEVEL&0
                                     _RPT2(_CRT_WARN, "cmd completed net %d in %.2f ms\n",
                                           pNCS->cNum, pFillInfo->stats.execTime);
@@ -1468,8 +2482,8 @@ int readPktThread::Run(void *context) {
                                                 theNet.logReceive(&readBuf,
                                                                   theErr, NULL,
                                                                   rxTime);
-                                                // Release cmd lock on database
-                                                EXIT_LOCK("readThreadProc (unsol)");
+                                                // Release the list lock
+                                                pNodeList->listLock.Unlock();
                                                 // Create dump file to show context
                                                 _RPT2(_CRT_WARN,
                                                       "readThread(%d) MN_PKT_TYPE_ERROR detected by node %d\n",
@@ -1486,8 +2500,8 @@ int readPktThread::Run(void *context) {
                                                 }
                                                 // Log the outcome
                                                 theNet.logReceive(&readBuf, theErr, NULL, rxTime);
-                                                // Release cmd lock on database
-                                                EXIT_LOCK("readThreadProc (unsol)");
+                                                // Release the list lock
+                                                pNodeList->listLock.Unlock();
                                                 // Tick the debug log with this information
                                                 _RPT2(_CRT_WARN,
                                                       "readThread(%d): unsolicited packet response: node=%d\n",
@@ -1497,7 +2511,7 @@ int readPktThread::Run(void *context) {
                                         }
                                     }
                                     else {
-                                        EXIT_LOCK("readThreadProc (unexpected)");
+                                        pNodeList->listLock.Unlock();
                                     }
                                 }
                             }  // src==MN_SRC_HOST
@@ -1509,17 +2523,19 @@ int readPktThread::Run(void *context) {
                                 // Log the reception
                                 theNet.logReceive(&readBuf, theErr, NULL,
                                                   rxTime);
-                                // Prevent deadlock on any callbacks we no longer interact with cmd database
-                                EXIT_LOCK("readThread: src=MN_SRC_NODE");
+                                // Prevent deadlock on any callbacks we no longer interact with the list
+                                pNodeList->listLock.Unlock();
                                 // Process the buffer and signal information
                                 processNodeInitiatedPkt(pNCS->cNum, respAddr,
                                                         pNCS, readBuf);
                             } // src=MN_SRC_MODE
                         } // if (bufferSize==0)
+                        CCmemoryBarrier();
+                        pNCS->readThreadRx = FALSE;
                     }
                     else { // theErr != MN_OK (infcGetResponse failed)
+                        pNCS->readThreadRx = FALSE;
                         if (theNet.OpenState == FLASHING) {
-                            EXIT_LOCK("readThread: inserial");
                             // Halt ourselves
                             ReadLock.Lock();
                             NextState(READ_HALT_REQ);
@@ -1529,14 +2545,12 @@ int readPktThread::Run(void *context) {
                         else {
                             // Shutting down
                             if (((m_pTermFlag != NULL) && *m_pTermFlag)) {
-                                EXIT_LOCK("readThread(read failure, shutting down)");
                                 goto exit_thread;
                             }
                             // Read failed, create a "null" receive record in the trace
                             _RPT3(_CRT_WARN,
                                   "%.1f readThread(%d): read failed code=0x%x\n",
                                   infcCoreTime(), pNCS->cNum, theErr);
-                            EXIT_LOCK("readThread(read failure)");
                         }
                     } // (2) infcGetResponse
                 } // (1) if (doRead && !*m_pTermFlag)
@@ -1673,6 +2687,26 @@ void readPktThread::NextState(readThreadStates nextState) {
 //*****************************************************************************
 
 
+//*****************************************************************************
+//  NAME                                                                      *
+//      readPktThread::Terminate
+//
+//  DESCRIPTION:
+///     Set the terminate flag and open the operation gate, so a halted
+///     thread sees the flag and its control function returns.
+///
+///     \return handle/ptr to thread
+//
+//  SYNOPSIS:
+void *readPktThread::Terminate() {
+    *m_pTermFlag = true;
+    m_InternalSync.SetEvent();
+    return (CThread::Terminate());
+}
+//                                                                            *
+//*****************************************************************************
+
+
 //*****************************************************************************
 //  NAME                                                                      *
 //      readPktThread::ForceStop
@@ -2273,12 +3307,14 @@ int autoDiscoverThread::Run(void *context) {
                 m_goneOnline = false;
                 m_faultingErr = theErr;
             }
-            else {
+            else if (!(m_pTermFlag && *m_pTermFlag)) {
                 // Wait for supervision to restart us....
                 m_ThreadParkedEvent.WaitFor();
             }
         }
-        else {
+        // Terminate may have signalled before the reset above, so look at
+        // its flag before waiting for a signal that already came.
+        else if (!(m_pTermFlag && *m_pTermFlag)) {
             // Wait for supervision to restart us....
             m_ThreadParkedEvent.WaitFor();
         }
@@ -2616,8 +3652,9 @@ restartOnlineSearch:
     m_critSect.Lock();
     m_parked = true;
     m_InternalSyncAck.SetEvent();
-    // Insure we don't leave gate closed if we closed it
-    if (engagedCmdGate) {
+    // Insure we don't leave gate closed if we closed it. A discovery start
+    // closes it for us, so open it too if we are terminated before then.
+    if (engagedCmdGate || (m_pTermFlag && *m_pTermFlag)) {
         pNCS->CmdGate.SetEvent();
     }
 
@@ -2845,10 +3882,16 @@ MN_EXPORT cnErrCode MN_DECL infcResetNetRate(
                   infcCoreTime(), cNum, serErr);
             return (MN_ERR_PORT_PROBLEM);
         }
-        // Wait for break to cycle around
-        infcSleep(Uint32(COMM_EVT_BRK_DLY_MS * 1.2));
+        // Wait for break to cycle around, leaving as soon as it does
+        double brkStartMs = infcCoreTime();
+        do {
+            pNCS->pSerialPort->ErrorReportGet(&currentErrors);
+            if (currentErrors.BREAKcnt != 0) {
+                break;
+            }
+            infcSleep(1);
+        } while (infcCoreTime() - brkStartMs < COMM_EVT_BRK_DLY_MS * 1.2);
         // Did we see one?
-        pNCS->pSerialPort->ErrorReportGet(&currentErrors);
         // Basic connectivity if we saw break cycle around
         if (currentErrors.BREAKcnt == 0) {
             _RPT2(_CRT_WARN,
@@ -2860,6 +3903,12 @@ MN_EXPORT cnErrCode MN_DECL infcResetNetRate(
             continue;
         }
         else {
+            // Let the characters trailing the break arrive, within the
+            // old bound
+            double leftMs = COMM_EVT_BRK_DLY_MS * 1.2
+                            - (infcCoreTime() - brkStartMs);
+            pNCS->pSerialPort->WaitForQuiet(SERIAL_QUIET_MS,
+                                            (leftMs > 0) ? Uint32(leftMs) : 0);
             theErr = MN_OK;
         }
 
@@ -3104,6 +4153,296 @@ MN_EXPORT cnErrCode MN_DECL  infcSetNetRate(
 //*******************************************************************************
 
 
+//******************************************************************************
+//  NAME                                                                       *
+//      infcQueueCommands
+//
+//  DESCRIPTION:
+//      This function performs steps 1) through 5) of infcRunCommand for
+//      infcRunCommand, infcSubmitCommand and infcRunCommandBatch. Commands
+//      from <theCommands> are paced, sent and entered into the response
+//      database so the read thread will copy each response to the matching
+//      <theResponses> entry. When <pAsyncs> is non-NULL the read thread also
+//      completes the matching record.
+//
+//      Only the first command waits for the pacing semaphore. Following
+//      commands join the same window while the semaphore has room, and
+//      are sent with a single write while holding only the response lists
+//      the window uses. The number sent is returned via <pnQueued>.
+//
+//      On success the list locks are released and the first tracker, its
+//      node list and the tag to wait for are returned via <ppRespInfo>,
+//      <ppRespArea> and <pRespTag> when these are non-NULL. On failure the
+//      trackers and the pacing semaphore have already been returned.
+//
+//  RETURNS:
+//      Standard return codes
+//
+//  SYNOPSIS:
+static cnErrCode infcQueueCommands(
+    netaddr cNum,
+    netStateInfo *pNCS,
+    packetbuf *theCommands,             // array of filled in commands
+    packetbuf *theResponses,            // array of response areas
+    asyncCmdInfo **pAsyncs,             // submitted command records or NULL
+    size_t nCmds,                       // entries in the arrays
+    Uint64 funcStartNs,                 // core time the API function started
+    size_t *pnQueued,                   // commands sent
+    respTrackInfo **ppRespInfo,         // first tracker assigned
+    respNodeList **ppRespArea,          // node list first tracker is on
+    Uint32 *pRespTag) {                 // first tracker's completion tag
+    cnErrCode theErr = MN_OK;
+    respNodeList *pRespArea;                            // By node address & type data areas
+    respTrackInfo *pRespInfo;                           // Thread / response info data
+    respTrackInfo *pWinInfo[SEND_PKTS_MAX];             // Trackers in this window
+    respNodeList *pWinArea[SEND_PKTS_MAX];              // Their response areas
+    size_t nWin, i;
+    Uint32 winLists;                                    // Lists the window uses
+    cmdClasses cmdClass;                                // Scheduling class
+    Uint64 queueNs;                                     // Wait for the ring
+    BOOL sleepOK;
+    BOOL dataOK, inRecovery;
+    mnNetInvRecords &theNet = SysInventory[cNum];
+    packetbuf *theCommand = &theCommands[0];
+
+    *pnQueued = 0;
+
+    // Are we in recovery thread?
+    inRecovery = pNCS->isRecoveryThread();
+
+    // If diagnostic is running we slowly cancel user's requests to
+    // prevent application spinout.
+    if (!inRecovery && !pNCS->CmdGate.WaitFor(FRAME_WRITE_TIMEOUT)) {
+        return MN_ERR_CANCELED;
+    }
+
+    // Block here if too many commands are attempted at once, the read
+    // thread will release each of these if the send is successful.
+    // If the transmission fails, we releave this semaphore. Waiting
+    // commands get the freed slots by class, most urgent first.
+    cmdClass = netStateInfo::cmdClassOf(theCommand);
+    sleepOK = pNCS->CmdPaceSemaphore.Lock(cmdClass, &queueNs);
+    theNet.logQueueWait(cmdClass, queueNs);
+
+    // Too long to release, this should only occur if there is a deadlock
+    if (!sleepOK) {
+        //NOTE: Since the semaphore wait time is now infinite, we should never
+        // get in here!
+        infcErrInfo semaErr;
+        _RPT1(_CRT_WARN,
+              "infcRunCommand(%d): pace semaphore release err, deadlocked?\n",
+              cNum);
+        semaErr.errCode = MN_ERR_SEND_LOCKED;
+        semaErr.cNum = cNum;
+        semaErr.node = -1;
+        infcCopyPktToPkt18(&semaErr.response, theCommand);
+        infcFireErrCallback(&semaErr);
+        // Log the problem
+        theNet.logSend(theCommand, MN_ERR_SEND_LOCKED, coreTimeNs());
+        // We are screwed, kill all pending work to flush
+        infcFlush(cNum);
+        return (MN_ERR_SEND_LOCKED);
+    }
+    // Fill the window with the commands the ring has room for now. Never
+    // wait here, another thread may be holding the rest of the window.
+    nWin = 1;
+    while (nWin < nCmds && nWin < SEND_PKTS_MAX
+            && pNCS->CmdPaceSemaphore.TryLock()) {
+        nWin++;
+    }
+    // Attempt to send command while not initializing?
+    if (!inRecovery && SysInventory[cNum].OpenState != OPENED_ONLINE
+            && !(SysInventory[cNum].Initializing)) {
+        // Log the send attempt and the error it caused
+        theNet.logSend(theCommand, MN_ERR_CMD_OFFLINE, coreTimeNs());
+        // Prevent leaking locks!
+#ifdef _DEBUG
+        pNCS->CmdPaceSemaphore.Unlock(nWin, &pNCS->SemaCount);
+#else
+        pNCS->CmdPaceSemaphore.Unlock(nWin);
+#endif
+        return (MN_ERR_CMD_OFFLINE);
+    }
+
+    //
+    // Lock out the other threads until we have this sent out
+    // and the response database entries have been made.
+    // The rule for responses is that by node, responses are in order, but
+    // not nodes are allowed to return out of the transmit order.
+    // For example:
+    // - command #1 is issued to node 3
+    // - command #2 is issued to node 0 (NC)
+    // - command #3 is issued to node 3
+    //
+    // The responses could come back #2, #1, #3 or #1, #2, #3.  Responses
+    // from an individual node are always processed the order transmitted.
+    // If a node can finish ahead of another node in the ring, it may
+    // transmit its result ahead of the transmit order. Only the lists of
+    // the nodes in this window are locked, so traffic to other nodes is
+    // not held up.
+    //
+    winLists = 0;
+    for (i = 0; i < nWin; i++) {
+        winLists |= 1U << netStateInfo::respListIndex(&theCommands[i]);
+    }
+    pNCS->lockLists(winLists);
+
+    for (i = 0; i < nWin; i++) {
+        theCommand = &theCommands[i];
+        // Setup the response area for this command while sending/wait.
+        pRespArea = pNCS->respList(netStateInfo::respListIndex(theCommand));
+#if TRACE_LOW_PRINT&&TRACE_SEND_RESP
+        _RPT2(_CRT_WARN, "\nS%d(%d)", theCommand->Fld.Addr,
+              pRespArea->sendCnt + 1);
+#endif
+        // The semaphore has as many units as there are trackers, so each
+        // unit we hold guarantees one is free.
+        pRespInfo = pNCS->trkAlloc();
+
+        // Initialize the response database tracking info
+        pRespInfo->stats.cmd = *theCommand;     // Save our command
+        pRespInfo->next = NULL;                 // We are always a leaf
+        pRespInfo->buf = &theResponses[i];      // Where to finally store resp
+        pRespInfo->bufOK = FALSE;               // Nothing here yet
+        pRespInfo->funcStartNs = funcStartNs;   // Record function start
+        pRespInfo->respTimeoutNs = pNCS->respTimeoutNs(theCommand);
+        pRespInfo->nSentAtAddr = ++pRespArea->sendCnt;
+        pRespInfo->pAsync = pAsyncs ? pAsyncs[i] : NULL;
+        pWinInfo[i] = pRespInfo;
+        pWinArea[i] = pRespArea;
+    }
+
+    // Record time when command hits the net
+    Uint64 cmdStartNs = coreTimeNs();
+    CCatomicAdd(&pNCS->nRespOutstanding, nWin);
+    if (nWin == 1) {
+        theErr = infcSendCommand(cNum, &theCommands[0]);
+    }
+    else {
+        theErr = infcSendCommands(cNum, theCommands, nWin);
+    }
+    if (theErr != MN_OK) {
+        CCatomicSub(&pNCS->nRespOutstanding, nWin);
+    }
+    for (i = 0; i < nWin; i++) {
+        pWinInfo[i]->cmdStartNs = cmdStartNs;
+        pWinInfo[i]->stats.sendTime = coreNsToMs(coreTimeNs()
+                                                 - cmdStartNs);
+    }
+    // If we sent command, continue processing for the expected response.
+    if (theErr == MN_OK) {
+        for (i = 0; i < nWin; i++) {
+            pRespInfo = pWinInfo[i];
+            pRespArea = pWinArea[i];
+            // Later reads must not share one sent before this command,
+            // the node's list lock keeps new reads from being sent first
+            theNet.paramFlightsSent(&theCommands[i]);
+            // We expect one to return
+            pRespInfo->stats.ringDepth = pNCS->nRespOutstanding;
+
+            // Initialize database pointers if first time through here
+            if (pRespArea->head == NULL) {
+                pRespArea->head = pRespInfo;    // Head = first one
+                pRespArea->tail = NULL;     // Reset the tail
+            }
+            // Link previous item to this one if there was one
+            if (pRespArea->tail != NULL) {
+                pRespArea->tail->next = pRespInfo;
+            }
+            // Tail always points to latest sent item
+            pRespArea->tail = pRespInfo;        // DB tail ptr to the end
+            // Save our serial number
+            pRespInfo->sendSerNum = theNet.logSend(&theCommands[i], theErr,
+                                                   pRespInfo->cmdStartNs);
+            // Arm the one-shot for this use of the tracker
+            pRespInfo->respTag = pRespInfo->respDone.Arm();
+        }
+        if (pRespTag) {
+            *pRespTag = pWinInfo[0]->respTag;
+        }
+
+        // Make sure the read thread starts running
+        pNCS->ReadThread.Start();
+
+        // Unlock the lists now that the response database is updated
+        pNCS->unlockLists(winLists);
+        // Hand the tracking back to the caller
+        *pnQueued = nWin;
+        if (ppRespInfo) {
+            *ppRespInfo = pWinInfo[0];
+        }
+        if (ppRespArea) {
+            *ppRespArea = pWinArea[0];
+        }
+        return (MN_OK);
+    }
+    _RPT2(_CRT_WARN, "infcRunCommand: failed send 0x%0x @ %f\n",
+          theErr, infcCoreTime());
+    // Return the tracking DB items
+    for (i = nWin; i-- > 0;) {
+        pWinInfo[i]->pAsync = NULL;
+        pNCS->trkFree(pWinInfo[i]);
+    }
+    // Release the command semaphore allowing more (if even possible)
+    // - note we have the list locks when we get here, don't forget to
+    // release them.
+#ifdef _DEBUG
+    dataOK = pNCS->CmdPaceSemaphore.Unlock(nWin, &pNCS->SemaCount);
+#else
+    dataOK = pNCS->CmdPaceSemaphore.Unlock(nWin);
+#endif
+    if (dataOK) {
+        // Make sure read thread keeps running
+        if (pNCS->respRelease() > 0) {
+            pNCS->ReadThread.Start();
+        }
+    }
+    else {
+        infcErrInfo semaErr;
+        int semaErrCode = GetLastError();
+        _RPT1(_CRT_ERROR, "readThread: semaphore release err 0x%X\n",
+              semaErrCode);
+        semaErr.errCode = MN_ERR_SEND_UNLOCK;
+        semaErr.cNum = cNum;
+        semaErr.node = semaErrCode;
+        pNCS->unlockLists(winLists);
+        infcFireErrCallback(&semaErr);
+        theErr = (cnErrCode)GetLastError();
+        _RPT1(_CRT_ERROR, "infcRunCommand: semaphore release err 0x%X\n",
+              theErr);
+        theNet.logSend(&theCommands[0], MN_ERR_SEND_UNLOCK, coreTimeNs());
+        return (theErr);
+    }
+    // Release locks, started upon command attempt
+    pNCS->unlockLists(winLists);
+    // Command failed, make sure there is someone to clean up
+    // any remaining items.
+    pNCS->ReadThread.Start();
+    // Log transfer timeout to a special error
+    if (theErr == MN_ERR_TIMEOUT) {
+        theErr = MN_ERR_SEND_FAILED;
+    }
+    for (i = 0; i < nWin; i++) {
+        theNet.logSend(&theCommands[i], theErr, coreTimeNs());
+    }
+    // Send off the callback if it exists
+    {
+        infcErrInfo errInfo;
+        // Fill in the relevant information
+        errInfo.errCode = theErr;
+        errInfo.cNum = cNum;
+        infcCopyPktToPkt18(&errInfo.response, &theCommands[0]);
+        errInfo.node = 0;
+        // Notify the user
+        infcFireErrCallback(&errInfo);
+    }
+    // Return the last error
+    return theErr;
+}
+//                                                                           *
+//******************************************************************************
+
+
 //******************************************************************************
 //  NAME                                                                       *
 //      infcRunCommand
@@ -3130,30 +4469,197 @@ MN_EXPORT cnErrCode MN_DECL  infcSetNetRate(
 //             it returns the appropriate code.
 //
 //  RETURNS:
-//      Standard return codes
+//      Standard return codes
+//
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL infcRunCommand(
+    netaddr cNum,
+    packetbuf *theCommand,              // pointer to filled in command
+    packetbuf *theResponse) {           // pointer to response area
+    Uint64 funcStartNs = coreTimeNs();                  // Time we started this function
+    cnErrCode theErr = MN_OK;
+    respNodeList *pRespArea;                            // By node address & type data areas
+    respTrackInfo *pRespInfo;                           // Thread / response info data
+    size_t nQueued;                                     // Commands sent
+    Uint32 respTag;                                     // Our use of the tracker
+    mnCompletionInfo stats;                             // Command completion statistics
+
+    register netStateInfo *pNCS;                        // Quick access to net info
+
+    // Is the device in our range?
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return MN_ERR_DEV_ADDR;
+    }
+
+    // We must have defined buffers
+    if (!theResponse || !theCommand) {
+        return MN_ERR_BADARG;
+    }
+
+    // Initialize fast pointer to our data
+    mnNetInvRecords &theNet = SysInventory[cNum];
+    pNCS = theNet.pNCS;
+
+    // Don't allow if the port is not open
+    if (!pNCS || !pNCS->pSerialPort || !pNCS->pSerialPort->IsOpen()) {
+        return (MN_ERR_CLOSED);
+    }
+
+    // RAII Lock on pNCS until return
+    netStateInfo::cmdsIdleEvt idleChecker(*pNCS);
+
+    // Don't do in serial port mode
+    if (theNet.OpenState == FLASHING) {
+        return (MN_ERR_IN_SERIAL_PORT);
+    }
+
+    // Cannot run commands from the read thread
+    if (pNCS->isReadThread()) {
+        return (MN_ERR_CMD_IN_ATTN);
+    }
+
+    theCommand->Fld.StartOfPacket = 1;
+    theResponse->Byte.BufferSize = 0;
+    theResponse->Fld.PktLen = 0;
+
+    // Check for outstanding responses
+    if (pNCS->nRespOutstanding == 0 && inDebugging) {
+        if (SysPortCount > 1) {
+            // Check for outstanding responses on other ports
+        }
+        else {
+            // Release the debugging thread lock gate, allowing us to step
+            // through code
+            debugThreadLockResponseGate.SetEvent();
+        }
+    }
+
+    // Check if the current thread should hit the gate
+    if (inDebugging) {
+        if (CThread::CurrentThreadID() != lockedThreadID) {
+            // Blocks new commands from being sent
+            debugGate.WaitFor(INFINITE);
+        }
+    }
+
+    // Wait no longer than this node usually needs for this command
+    unsigned waitMs = unsigned((pNCS->respTimeoutNs(theCommand) + 999999)
+                               / 1000000);
+
+    // Send and track the command
+    theErr = infcQueueCommands(cNum, pNCS, theCommand, theResponse, NULL, 1,
+                               funcStartNs, &nQueued, &pRespInfo, &pRespArea,
+                               &respTag);
+    if (theErr != MN_OK) {
+        return (theErr);
+    }
+    // This thread is waiting for the response, wait for event or timeout
+#if TRACE_LOW_PRINT&&TRACE_SEND_RESP
+    _RPT0(_CRT_WARN, "W");
+#endif
+    BOOL waitOK = pRespInfo->respDone.WaitFor(respTag, waitMs);
+#if TRACE_LOW_PRINT&&TRACE_SEND_RESP
+    _RPT1(_CRT_WARN, ".<%d>", waitOK);
+#endif
+    if (!waitOK) {
+        // -------------------------------------------------- //
+        // We are restarted via time-out                      //
+        // -------------------------------------------------- //
+        theErr = MN_ERR_RESP_TIMEOUT;
+        pRespArea->listLock.Lock();
+        // The response may have arrived while we took the lock, then the
+        // tracker may already be in use by another command.
+        if (!pRespInfo->respDone.Pending(respTag)) {
+            pRespArea->listLock.Unlock();
+            return (MN_OK);
+        }
+        DUMP_PKT(cNum, "**Timeout cmd ", &pRespInfo->stats.cmd);
+        // Add failure to the rx log file
+        if (SysInventory[cNum].TraceActive) {
+            packetbuf nullPkt;
+
+            // Create null packet buffer
+            nullPkt.Byte.BufferSize = 0;
+            nullPkt.Byte.Buffer[0] = nullPkt.Byte.Buffer[1] = 0;
+            // Assign a receive trace record
+            theNet.logReceive(&nullPkt, MN_ERR_RESP_TIMEOUT,
+                              pRespInfo, coreTimeNs());
+        }
+        theNet.logLatency(pRespInfo->stats.cmd, 0, true);
+        rtoClasses rtoClass = netStateInfo::rtoClassOf(&pRespInfo->stats.cmd);
+        if (rtoClass != RTO_CLASS_FIXED) {
+            pRespArea->rto[rtoClass].backoff++;
+        }
+        if (SysInventory[cNum].OpenState == OPENED_ONLINE) {
+            // Send off the error callback, fill in the relevant
+            // error information
+            infcErrInfo errInfo;
+            errInfo.errCode = theErr;
+            errInfo.cNum = cNum;
+            infcCopyPktToPkt18(&errInfo.response, theCommand);
+            errInfo.node = theCommand->Fld.Addr;
+            // Notify the user
+            infcFireErrCallback(&errInfo);
+        }
+        // Remove this as an expected item
+        pNCS->timeoutDBitem(pRespInfo, pRespArea);
+        pRespArea->listLock.Unlock();
+    }
+    // Return the last error
+    return theErr;
+}
+//                                                                           *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      infcSubmitCommand
+//
+//  DESCRIPTION:
+//      This function will send the buffer specified in <theCommand> and
+//      return once it is sent and tracked, without waiting for the response.
+//      The read thread stores the response in <theResponse>, which must stay
+//      valid until the command completes, and then:
+//          1) records the outcome for infcCommandDone and infcCommandWait
+//          2) calls <doneFunc> with <context>, if one was given
+//
+//      If <pHandle> is non-NULL a completion handle is returned there and
+//      must be returned via infcCommandRelease. A NULL <pHandle> is allowed
+//      when <doneFunc> is used. Responses not seen within the infcRunCommand
+//      time-out complete with MN_ERR_RESP_TIMEOUT.
+//
+//      The command pacing semaphore still applies, so a single thread can
+//      keep the ring's command limit in flight. Submitting beyond that
+//      blocks until an earlier command completes.
+//
+//  RETURNS:
+//      Standard return codes for the send. The command outcome is
+//      delivered via the completion handle or callback.
 //
 //  SYNOPSIS:
-MN_EXPORT cnErrCode MN_DECL infcRunCommand(
+MN_EXPORT cnErrCode MN_DECL infcSubmitCommand(
     netaddr cNum,
     packetbuf *theCommand,              // pointer to filled in command
-    packetbuf *theResponse) {           // pointer to response area
-    double funcStartAt = infcCoreTime();                // Time we started this function
-    cnErrCode theErr = MN_OK;
-    respNodeList *pRespArea;                            // By node address & type data areas
-    respTrackInfo *pRespInfo;                           // Thread / response info data
-    BOOL sleepOK;
-    BOOL dataOK, inRecovery;
-    mnCompletionInfo stats;                             // Command completion statistics
-
-    register netStateInfo *pNCS;                        // Quick access to net info
+    packetbuf *theResponse,             // pointer to response area
+    infcCmdDoneCallback doneFunc,       // optional completion callback
+    void *context,                      // context for doneFunc
+    infcCmdHandle *pHandle) {           // optional ptr to handle result
+    Uint64 funcStartNs = coreTimeNs();                  // Time we started this function
+    cnErrCode theErr;
+    size_t nQueued;                                     // Commands sent
+    asyncCmdInfo *pAsync;                               // Completion record
+    netStateInfo *pNCS;                                 // Quick access to net info
 
+    if (pHandle) {
+        *pHandle = NULL;
+    }
     // Is the device in our range?
     if (cNum >= NET_CONTROLLER_MAX) {
         return MN_ERR_DEV_ADDR;
     }
-
-    // We must have defined buffers
-    if (!theResponse || !theCommand) {
+    // We must have defined buffers and some way to see the outcome
+    if (!theResponse || !theCommand || (!pHandle && !doneFunc)) {
         return MN_ERR_BADARG;
     }
 
@@ -3174,7 +4680,7 @@ MN_EXPORT cnErrCode MN_DECL infcRunCommand(
         return (MN_ERR_IN_SERIAL_PORT);
     }
 
-    // Cannot run commands from the read thread
+    // The read thread releases the pacing semaphore, it cannot wait on it
     if (pNCS->isReadThread()) {
         return (MN_ERR_CMD_IN_ATTN);
     }
@@ -3183,272 +4689,259 @@ MN_EXPORT cnErrCode MN_DECL infcRunCommand(
     theResponse->Byte.BufferSize = 0;
     theResponse->Fld.PktLen = 0;
 
-    // Check for outstanding responses
-    if (pNCS->nRespOutstanding == 0 && inDebugging) {
-        if (SysPortCount > 1) {
-            // Check for outstanding responses on other ports
+    // Create the completion record, referenced by the tracking and the
+    // submitter's handle.
+    pAsync = new asyncCmdInfo;
+    pAsync->doneFunc = doneFunc;
+    pAsync->context = context;
+    pAsync->pResp = theResponse;
+    pAsync->refs = pHandle ? 2 : 1;
+    if (pHandle) {
+        *pHandle = pAsync;
+    }
+    // The command stays in play until completed
+    pNCS->m_cmdsInPlay.Incr();
+    pNCS->CmdsIdle.ResetEvent();
+    CCatomicAdd(&pNCS->nAsyncOutstanding, 1);
+
+    // Send and track the command
+    theErr = infcQueueCommands(cNum, pNCS, theCommand, theResponse, &pAsync,
+                               1, funcStartNs, &nQueued, NULL, NULL, NULL);
+    if (theErr != MN_OK) {
+        // Never tracked, back out the accounting
+        CCatomicSub(&pNCS->nAsyncOutstanding, 1);
+        if (pNCS->m_cmdsInPlay.Decr() == 0) {
+            pNCS->CmdsIdle.SetEvent();
         }
-        else {
-            // Release the debugging thread lock gate, allowing us to step
-            // through code
-            debugThreadLockResponseGate.SetEvent();
+        delete pAsync;
+        if (pHandle) {
+            *pHandle = NULL;
         }
     }
+    return theErr;
+}
+//                                                                           *
+//******************************************************************************
 
-    // Check if the current thread should hit the gate
-    if (inDebugging) {
-        if (CThread::CurrentThreadID() != lockedThreadID) {
-            // Blocks new commands from being sent
-            debugGate.WaitFor(INFINITE);
+
+//******************************************************************************
+//  NAME                                                                       *
+//      infcCommandDone
+//
+//  DESCRIPTION:
+//      Poll a command started by infcSubmitCommand. Once complete, the
+//      outcome is stored at <pResult> if it is non-NULL.
+//
+//  RETURNS:
+//      TRUE if the command has completed
+//
+//  SYNOPSIS:
+MN_EXPORT nodebool MN_DECL infcCommandDone(
+    infcCmdHandle hCmd,
+    cnErrCode *pResult) {
+    if (!hCmd) {
+        if (pResult) {
+            *pResult = MN_ERR_BADARG;
         }
+        return (TRUE);
     }
-
-    // Are we in recovery thread?
-    inRecovery = pNCS->isRecoveryThread();
-
-    // If diagnostic is running we slowly cancel user's requests to
-    // prevent application spinout.
-    if (!inRecovery && !pNCS->CmdGate.WaitFor(FRAME_WRITE_TIMEOUT)) {
-        return MN_ERR_CANCELED;
+    if (!hCmd->done) {
+        return (FALSE);
     }
+    // Result was posted before done
+    CCmemoryBarrier();
+    if (pResult) {
+        *pResult = hCmd->result;
+    }
+    return (TRUE);
+}
+//                                                                           *
+//******************************************************************************
 
-    // Block here if too many commands are attempted at once, the read
-    // thread will release each of these if the send is successful.
-    // If the transmission fails, we releave this semaphore.
-    sleepOK = pNCS->CmdPaceSemaphore.Lock(INFINITE);
 
-    // Too long to release, this should only occur if there is a deadlock
-    if (!sleepOK) {
-        //NOTE: Since the semaphore wait time is now infinite, we should never
-        // get in here!
-        infcErrInfo semaErr;
-        _RPT1(_CRT_WARN,
-              "infcRunCommand(%d): pace semaphore release err, deadlocked?\n",
-              cNum);
-        semaErr.errCode = MN_ERR_SEND_LOCKED;
-        semaErr.cNum = cNum;
-        semaErr.node = -1;
-        infcCopyPktToPkt18(&semaErr.response, theCommand);
-        infcFireErrCallback(&semaErr);
-        // Log the problem
-        theNet.logSend(theCommand, MN_ERR_SEND_LOCKED, infcCoreTime());
-        // We are screwed, kill all pending work to flush
-        infcFlush(cNum);
-        return (MN_ERR_SEND_LOCKED);
+//******************************************************************************
+//  NAME                                                                       *
+//      infcCommandWait
+//
+//  DESCRIPTION:
+//      Wait up to <timeoutMs> milliseconds for a command started by
+//      infcSubmitCommand to complete. INFINITE waits for completion, which
+//      is bounded by the response time-out.
+//
+//  RETURNS:
+//      The command outcome or MN_ERR_TIMEOUT if it is still in flight.
+//
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL infcCommandWait(
+    infcCmdHandle hCmd,
+    nodeulong timeoutMs) {
+    if (!hCmd) {
+        return (MN_ERR_BADARG);
     }
-    // Attempt to send command while not initializing?
-    if (!inRecovery && SysInventory[cNum].OpenState != OPENED_ONLINE
-            && !(SysInventory[cNum].Initializing)) {
-        // Log the send attempt and the error it caused
-        theNet.logSend(theCommand, MN_ERR_CMD_OFFLINE, infcCoreTime());
-        // Prevent leaking locks!
-#ifdef _DEBUG
-        pNCS->CmdPaceSemaphore.Unlock(1, &pNCS->SemaCount);
-#else
-        pNCS->CmdPaceSemaphore.Unlock();
-#endif
-        return (MN_ERR_CMD_OFFLINE);
+    if (!hCmd->done) {
+        hCmd->evtDone.WaitFor((unsigned)timeoutMs);
+        if (!hCmd->done) {
+            return (MN_ERR_TIMEOUT);
+        }
     }
+    // Result was posted before done
+    CCmemoryBarrier();
+    return (hCmd->result);
+}
+//                                                                           *
+//******************************************************************************
 
-    // Setup the response area for this command while sending/wait.
-    if (MN_PKT_IS_HIGH_PRIO(theCommand->Fld.PktType)) {
-        // Control packets are not node related, queue separately
-        pRespArea = &pNCS->controlNodeState;
-#if TRACE_LOW_PRINT&&TRACE_SEND_RESP
-        _RPT2(_CRT_WARN, "\nS%d<%d>", theCommand->Fld.Addr,
-              pRespArea->sendCnt + 1);
-#endif
-    }
-    else {
-        // Regular packets queue at each node
-        pRespArea = &pNCS->respNodeState[theCommand->Fld.Addr];
-#if TRACE_LOW_PRINT&&TRACE_SEND_RESP
-        _RPT2(_CRT_WARN, "\nS%d(%d)", theCommand->Fld.Addr,
-              pRespArea->sendCnt + 1);
-#endif
-    }
-    //
-    // Lock out the other threads until we have this sent out
-    // and the response database entries have been made.
-    // The rule for responses is that by node, responses are in order, but
-    // not nodes are allowed to return out of the transmit order.
-    // For example:
-    // - command #1 is issued to node 3
-    // - command #2 is issued to node 0 (NC)
-    // - command #3 is issued to node 3
-    //
-    // The responses could come back #2, #1, #3 or #1, #2, #3.  Responses
-    // from an individual node are always processed the order transmitted.
-    // If a node can finish ahead of another node in the ring, it may
-    // transmit its result ahead of the transmit order.
-    //
-    ENTER_LOCK("infcRunCommand (cmd init)");
 
-    // Assign a response tracking database element.
-    if (!pNCS->pTrkTail) {
-        EXIT_LOCK("infcRunCommand(going away)");
-        // Prevent leaking locks!
-#ifdef _DEBUG
-        pNCS->CmdPaceSemaphore.Unlock(1, &pNCS->SemaCount);
-#else
-        pNCS->CmdPaceSemaphore.Unlock();
-#endif
-        return (MN_ERR_CMD_OFFLINE);
-    }
-    pRespInfo = *pNCS->pTrkTail;
-    *pNCS->pTrkTail-- = NULL;
-    if (pNCS->pTrkTail < &pNCS->pTrkList[-1]) {
-        _RPT0(_CRT_ASSERT, "infcRunCommand: oops using illegal tracker\n");
+//******************************************************************************
+//  NAME                                                                       *
+//      infcCommandRelease
+//
+//  DESCRIPTION:
+//      Return a handle obtained from infcSubmitCommand. This may be done
+//      before the command completes; the response area must still remain
+//      valid until then.
+//
+//  RETURNS:
+//      Nothing
+//
+//  SYNOPSIS:
+MN_EXPORT void MN_DECL infcCommandRelease(
+    infcCmdHandle hCmd) {
+    if (hCmd && CCatomicSub(&hCmd->refs, 1) == 0) {
+        delete hCmd;
     }
+}
+//                                                                           *
+//******************************************************************************
 
-    // Initialize the response database tracking info
-    pRespInfo->stats.cmd = *theCommand;     // Save our command
-    pRespInfo->next = NULL;                 // We are always a leaf
-    pRespInfo->buf = theResponse;           // Where to finally store resp
-    pRespInfo->bufOK = FALSE;               // Nothing here yet
-    pRespInfo->funcStartAt = funcStartAt;   // Record function start
-    pRespInfo->nSentAtAddr = ++pRespArea->sendCnt;
 
-    if (theErr == MN_OK) {
-        // Record time when command hits the net
-        pRespInfo->cmdStartAt = infcCoreTime();
-        ++pNCS->nRespOutstanding;
-        theErr = infcSendCommand(cNum, theCommand);
-        if (theErr != MN_OK) {
-            --pNCS->nRespOutstanding;
-        }
-        pRespInfo->stats.sendTime = infcCoreTime() - pRespInfo->cmdStartAt;
+//******************************************************************************
+//  NAME                                                                       *
+//      infcRunCommandBatch
+//
+//  DESCRIPTION:
+//      This function will run the <nCmds> commands in <theCommands> and
+//      wait for all of their responses, storing them in the matching
+//      <theResponses> entries and each outcome in <theErrs>.
+//
+//      Commands are sent in windows of as many as the ring's command limit
+//      allows. Each window is sent with one write and entered into the
+//      response database under one command lock acquisition. Later windows
+//      are sent as earlier responses free their slots, so the ring stays
+//      full until the whole set has been sent.
+//
+//  RETURNS:
+//      MN_OK if every command completed, else the first failure found.
+//
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL infcRunCommandBatch(
+    netaddr cNum,
+    packetbuf theCommands[],            // filled in commands
+    packetbuf theResponses[],           // response areas
+    cnErrCode theErrs[],                // per command outcome
+    nodeulong nCmds) {                  // number of commands
+    Uint64 funcStartNs = coreTimeNs();                  // Time we started this function
+    cnErrCode theErr = MN_OK;
+    asyncCmdInfo **pAsyncs;                             // Completion records
+    size_t nSent, nQueued, i;
+    netStateInfo *pNCS = NULL;                          // Quick access to net info
+
+    // We must have defined buffers
+    if (!theResponses || !theCommands || !theErrs) {
+        return MN_ERR_BADARG;
     }
-    // If we sent command, continue processing for the expected response.
-    if (theErr == MN_OK) {
-        // We expect one to return
-        pRespInfo->stats.ringDepth = pNCS->nRespOutstanding;
 
-        // Initialize database pointers if first time through here
-        if (pRespArea->head == NULL) {
-            pRespArea->head = pRespInfo;    // Head = first one
-            pRespArea->tail = NULL;     // Reset the tail
+    // Is the device in our range?
+    if (cNum >= NET_CONTROLLER_MAX) {
+        theErr = MN_ERR_DEV_ADDR;
+    }
+    else {
+        pNCS = SysInventory[cNum].pNCS;
+        // Don't allow if the port is not open
+        if (!pNCS || !pNCS->pSerialPort || !pNCS->pSerialPort->IsOpen()) {
+            theErr = MN_ERR_CLOSED;
+        }
+        // Don't do in serial port mode
+        else if (SysInventory[cNum].OpenState == FLASHING) {
+            theErr = MN_ERR_IN_SERIAL_PORT;
         }
-        // Link previous item to this one if there was one
-        if (pRespArea->tail != NULL) {
-            pRespArea->tail->next = pRespInfo;
+        // Cannot run commands from the read thread
+        else if (pNCS->isReadThread()) {
+            theErr = MN_ERR_CMD_IN_ATTN;
         }
-        // Tail always points to latest sent item
-        pRespArea->tail = pRespInfo;        // DB tail ptr to the end
-        // Save our serial number
-        pRespInfo->sendSerNum = theNet.logSend(theCommand, theErr,
-                                               pRespInfo->cmdStartAt);
-        // Make sure response wait event is unsignalled??
-        pRespInfo->evtRespWait.ResetEvent();
+    }
+    if (theErr != MN_OK || nCmds == 0) {
+        for (i = 0; i < nCmds; i++) {
+            theErrs[i] = theErr;
+        }
+        return theErr;
+    }
 
-        // Make sure the read thread starts running
-        pNCS->ReadThread.Start();
+    // RAII Lock on pNCS until return
+    netStateInfo::cmdsIdleEvt idleChecker(*pNCS);
 
-        // Unlock previous lock now that the response database is updated
-        EXIT_LOCK("infcRunCommand (restart read)");
-        // This thread is waiting for the response, wait for event or timeout
-#if TRACE_LOW_PRINT&&TRACE_SEND_RESP
-        _RPT0(_CRT_WARN, "W");
-#endif
-        BOOL waitOK = pRespInfo->evtRespWait.WaitFor(InfcRespTimeOut);
-#if TRACE_LOW_PRINT&&TRACE_SEND_RESP
-        _RPT1(_CRT_WARN, ".<%d>", sleepOK);
-#endif
-        if (!waitOK) {
-            // -------------------------------------------------- //
-            // We are restarted via time-out                      //
-            // -------------------------------------------------- //
-            theErr = MN_ERR_RESP_TIMEOUT;
-            DUMP_PKT(cNum, "**Timeout cmd ", &pRespInfo->stats.cmd);
-            ENTER_LOCK("infcRunCommand (timeout)");
-            // Add failure to the rx log file
-            if (SysInventory[cNum].TraceActive) {
-                packetbuf nullPkt;
-
-                // Create null packet buffer
-                nullPkt.Byte.BufferSize = 0;
-                nullPkt.Byte.Buffer[0] = nullPkt.Byte.Buffer[1] = 0;
-                // Assign a receive trace record
-                theNet.logReceive(&nullPkt, MN_ERR_RESP_TIMEOUT,
-                                  pRespInfo, infcCoreTime());
-            }
-            if (SysInventory[cNum].OpenState == OPENED_ONLINE) {
-                // Send off the error callback, fill in the relevant
-                // error information
-                infcErrInfo errInfo;
-                errInfo.errCode = theErr;
-                errInfo.cNum = cNum;
-                infcCopyPktToPkt18(&errInfo.response, theCommand);
-                errInfo.node = theCommand->Fld.Addr;
-                // Notify the user
-                infcFireErrCallback(&errInfo);
-            }
-            // Remove this as an expected item
-            pNCS->removeThisDBitem(pRespInfo, pRespArea);
-            EXIT_LOCK("infcRunCommand (resp timeout)");
+    // Each command completes like a submitted one, so windows can be
+    // refilled without a thread per outstanding command.
+    pAsyncs = new asyncCmdInfo *[nCmds];
+    for (i = 0; i < nCmds; i++) {
+        theCommands[i].Fld.StartOfPacket = 1;
+        theResponses[i].Byte.BufferSize = 0;
+        theResponses[i].Fld.PktLen = 0;
+        pAsyncs[i] = new asyncCmdInfo;
+        pAsyncs[i]->pResp = &theResponses[i];
+        // Released by completion and by us
+        pAsyncs[i]->refs = 2;
+        pNCS->m_cmdsInPlay.Incr();
+        CCatomicAdd(&pNCS->nAsyncOutstanding, 1);
+    }
+    pNCS->CmdsIdle.ResetEvent();
+
+    // Send the commands in windows as the ring has room
+    for (nSent = 0; nSent < nCmds; nSent += nQueued) {
+        theErr = infcQueueCommands(cNum, pNCS, &theCommands[nSent],
+                                   &theResponses[nSent], &pAsyncs[nSent],
+                                   nCmds - nSent, funcStartNs, &nQueued,
+                                   NULL, NULL, NULL);
+        if (theErr != MN_OK) {
+            break;
         }
     }
-    else {
-        _RPT2(_CRT_WARN, "infcRunCommand: failed send 0x%0x @ %f\n",
-              theErr, infcCoreTime());
-        // Return the tracking DB item
-        pNCS->pTrkTail++;
-        *pNCS->pTrkTail = pRespInfo;
-        // Release the command semaphore allowing one more (if even possible)
-        // - note we have the command lock when we get here, don't forget to
-        // release it.
-#ifdef _DEBUG
-        dataOK = pNCS->CmdPaceSemaphore.Unlock(1, &pNCS->SemaCount);
-#else
-        dataOK = pNCS->CmdPaceSemaphore.Unlock();
-#endif
-        if (dataOK) {
-            // Make sure read thread keeps running
-            if (pNCS->nRespOutstanding > 0) {
-                if (--pNCS->nRespOutstanding > 0) {
-                    pNCS->ReadThread.Start();
-                }
-            }
-        }
-        else {
-            infcErrInfo semaErr;
-            int semaErrCode = GetLastError();
-            _RPT1(_CRT_ERROR, "readThread: semaphore release err 0x%X\n",
-                  semaErrCode);
-            semaErr.errCode = MN_ERR_SEND_UNLOCK;
-            semaErr.cNum = cNum;
-            semaErr.node = semaErrCode;
-            EXIT_LOCK("infcRunCommand: (sema rel err)");
-            infcFireErrCallback(&semaErr);
-            theErr = (cnErrCode)GetLastError();
-            _RPT1(_CRT_ERROR, "infcRunCommand: semaphore release err 0x%X\n",
-                  theErr);
-            theNet.logSend(theCommand, MN_ERR_SEND_UNLOCK, infcCoreTime());
-            return (theErr);
+    // Those never sent fail with the send error
+    for (i = nSent; i < nCmds; i++) {
+        theErrs[i] = theErr;
+        CCatomicSub(&pNCS->nAsyncOutstanding, 1);
+        if (pNCS->m_cmdsInPlay.Decr() == 0) {
+            pNCS->CmdsIdle.SetEvent();
         }
-        // Release lock, started upon command attempt
-        EXIT_LOCK("infcRunCommand (send fail)");
-        // Command failed, make sure there is someone to clean up
-        // any remaining items.
-        pNCS->ReadThread.Start();
-        // Log transfer timeout to a special error
-        if (theErr == MN_ERR_TIMEOUT) {
-            theErr = MN_ERR_SEND_FAILED;
+        delete pAsyncs[i];
+    }
+    // Collect the outcomes of those sent. Time-outs are applied by the
+    // read thread; allow it an expiry pass past the longest one before
+    // giving up on it.
+    Uint64 waitNs = 0;
+    for (i = 0; i < nSent; i++) {
+        Uint64 cmdNs = pNCS->respTimeoutNs(&theCommands[i]);
+        waitNs = (cmdNs > waitNs) ? cmdNs : waitNs;
+    }
+    Uint64 deadlineNs = coreTimeNs() + waitNs
+                        + 2 * coreMsToNs(RD_THREAD_PREMPTIVE_WAIT);
+    for (i = 0; i < nSent; i++) {
+        Uint64 nowNs = coreTimeNs();
+        unsigned waitMs = (nowNs < deadlineNs)
+                          ? unsigned((deadlineNs - nowNs + 999999) / 1000000)
+                          : 0;
+        theErrs[i] = infcCommandWait(pAsyncs[i], waitMs);
+        if (theErrs[i] == MN_ERR_TIMEOUT) {
+            // Make sure it completes before its response area goes away
+            pNCS->abandonAsync(pAsyncs[i]);
+            theErrs[i] = infcCommandWait(pAsyncs[i], INFINITE);
         }
-        theNet.logSend(theCommand, theErr, infcCoreTime());
-        // Send off the callback if it exists
-        {
-            infcErrInfo errInfo;
-            // Fill in the relevant information
-            errInfo.errCode = theErr;
-            errInfo.cNum = cNum;
-            infcCopyPktToPkt18(&errInfo.response, theCommand);
-            errInfo.node = 0;
-            // Notify the user
-            infcFireErrCallback(&errInfo);
+        if (theErrs[i] != MN_OK && theErr == MN_OK) {
+            theErr = theErrs[i];
         }
+        infcCommandRelease(pAsyncs[i]);
     }
-    // Return the last error
+    delete[] pAsyncs;
     return theErr;
 }
 //                                                                           *
@@ -3518,10 +5011,13 @@ MN_EXPORT cnErrCode MN_DECL infcStartController(
 
     // Create logging on first open
     if (!theNet.txTraces) {
-        theNet.txTraces = new txTraceBuf[SEND_DEPTH];
+        theNet.txTraces = new txTraceSlot[SEND_DEPTH]();
     }
     if (!theNet.rxTraces) {
-        theNet.rxTraces = new rxTraceBuf[RECV_DEPTH];
+        theNet.rxTraces = new rxTraceSlot[RECV_DEPTH]();
+    }
+    if (!theNet.pLatency) {
+        theNet.pLatency = new latencyTables();
     }
 
     // Allow only one starter at a time
@@ -3623,6 +5119,9 @@ MN_EXPORT cnErrCode MN_DECL infcStartController(
 
         // Connect our local pkt received event to the serial channel
         pNCS->pSerialPort->RegisterUserPktCommEvent(&pNCS->ReadCommEvent);
+        pNCS->pSerialPort->RegisterPktHook(
+            SysInventory[cNum].SingleHopRx ? netStateInfo::singleHopRx : NULL,
+            pNCS);
         if (SysInventory[cNum].OpenState != OPENED_ONLINE) {
             SysInventory[cNum].OpenStateNext(OPENED_SEARCHING);
         }
@@ -3788,7 +5287,9 @@ void makeNopPacket(packetbuf *pBuf, bool isHighPrio) {
 //
 //  DESCRIPTION:
 //      Flush network received data and structures. It is assumed the data
-//      structures are locked out prior to calling this.
+//      structures are locked out prior to calling this. Submitted commands
+//      are queued for netStateInfo::completeCanceled, which the caller runs
+//      once it has released the locks.
 //
 //  RETURNS:
 //      Number of characters flushed.
@@ -3798,6 +5299,7 @@ nodeulong infcFlushProc(netaddr cNum) {
     nodeulong lostCount = 0;
     nodeushort i;
     respTrackInfo *nextWaiter, *head;
+    asyncCmdInfo *pAsync;
     packetbuf theCmd;
     netStateInfo *pNCS = SysInventory[cNum].pNCS;
 
@@ -3817,6 +5319,8 @@ nodeulong infcFlushProc(netaddr cNum) {
     pNCS->ReadThread.Stop();
     // Ignore all data past here
     pNCS->pSerialPort->AutoFlush(true);
+    // Characters seen before the NOPs, their echo follows any junk
+    Uint32 seenFrom = pNCS->pSerialPort->CharsSeen();
 
     // Create a low level NOP to clear out any frags waiting
     makeNopPacket(&theCmd, false);
@@ -3825,8 +5329,8 @@ nodeulong infcFlushProc(netaddr cNum) {
     // Create a high level NOP to clear out any frags waiting
     makeNopPacket(&theCmd, true);
     infcSendCommand(cNum, &theCmd);
-    // Let junk accumulate
-    infcSleep(50);
+    // Let junk accumulate until the echo arrives and the line goes quiet
+    pNCS->pSerialPort->WaitForReply(seenFrom, SERIAL_QUIET_MS, 50);
     // flush all data out of the serial port
     // Clean up threads waiting
     for (i = 0; i < MN_API_MAX_NODES; i++) {
@@ -3834,7 +5338,12 @@ nodeulong infcFlushProc(netaddr cNum) {
         head = pNCS->respNodeState[i].head;
         while (head != NULL) {
             nextWaiter = head->next;
+            pAsync = head->pAsync;
+            head->pAsync = NULL;
             pNCS->removeThisDBitem(head, &pNCS->respNodeState[i]);
+            if (pAsync) {
+                pNCS->cancelAsync(pAsync);
+            }
             head = nextWaiter;
         }
     }
@@ -3843,7 +5352,12 @@ nodeulong infcFlushProc(netaddr cNum) {
     head = pNCS->controlNodeState.head;
     while (head != NULL) {
         nextWaiter = head->next;
+        pAsync = head->pAsync;
+        head->pAsync = NULL;
         pNCS->removeThisDBitem(head, &pNCS->controlNodeState);
+        if (pAsync) {
+            pNCS->cancelAsync(pAsync);
+        }
         // Record the next head
         head = nextWaiter;
     }
@@ -3889,6 +5403,8 @@ nodeulong MN_DECL infcFlush(
     // Flush NC data
     lostCount = infcFlushProc(cNum);
     EXIT_LOCK("infcFlush");
+    // Flushed submitted commands complete outside of the locks
+    pNCS->completeCanceled();
     return (lostCount);
 }
 //                                                                             *
@@ -3943,9 +5459,68 @@ MN_EXPORT cnErrCode MN_DECL infcGetResponse(
 //      #cnErrCode of send success
 //
 //  SYNOPSIS:
-MN_EXPORT cnErrCode MN_DECL infcSendCommand(
+MN_EXPORT cnErrCode MN_DECL infcSendCommand(
+    netaddr cNum,
+    packetbuf *theCommand)          // pointer to a command buffer area
+{
+    netStateInfo *pNCS = SysInventory[cNum].pNCS;
+    // Interface gone?
+    if (!pNCS->pSerialPort) {
+        return (MN_ERR_CLOSED);
+    }
+
+#if TRACE_SEND_RESP
+    theCommand->Fld.StartOfPacket = 1;
+    DUMP_PKT(cNum, "SendCommand   ", theCommand);
+#endif
+
+    // Send atomically via the serial port
+    pNCS->sendLock.Lock();
+    if (pNCS->pSerialPort->SendPkt(*theCommand)) {
+        pNCS->nPktsSent++;
+        pNCS->sendLock.Unlock();
+        return (MN_OK);
+    }
+    pNCS->sendLock.Unlock();
+
+    // Something went wrong!
+    return (MN_ERR_SEND_FAILED);
+}
+
+
+// Same as infcSendCommand, but log in send log, we are not expecting response.
+cnErrCode MN_DECL infcSendCommandLog(
+    nodeushort cNum,                    // Port Index
+    packetbuf *theCommand) {            // Ptr to buffered command
+    cnErrCode theErr;
+    Uint64 txStart = coreTimeNs();
+    theErr = infcSendCommand(cNum, theCommand);
+    // If all OK, log it
+    if (cNum < NET_CONTROLLER_MAX && SysInventory[cNum].pNCS) {
+        SysInventory[cNum].logSend(theCommand, theErr, txStart);
+    }
+    return (theErr);
+}
+///                                                                            *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      infcSendCommands
+//
+//  DESCRIPTION:
+//      This function will send the <nCmds> packets in <theCommands> back to
+//      back with a single write to the serial port.
+//
+//  RETURNS:
+//      #cnErrCode of send success
+//
+//  SYNOPSIS:
+cnErrCode MN_DECL infcSendCommands(
     netaddr cNum,
-    packetbuf *theCommand)          // pointer to a command buffer area
+    packetbuf *theCommands,         // array of command buffers
+    size_t nCmds)                   // number of commands
 {
     netStateInfo *pNCS = SysInventory[cNum].pNCS;
     // Interface gone?
@@ -3954,35 +5529,25 @@ MN_EXPORT cnErrCode MN_DECL infcSendCommand(
     }
 
 #if TRACE_SEND_RESP
-    theCommand->Fld.StartOfPacket = 1;
-    DUMP_PKT(cNum, "SendCommand   ", theCommand);
+    for (size_t i = 0; i < nCmds; i++) {
+        theCommands[i].Fld.StartOfPacket = 1;
+        DUMP_PKT(cNum, "SendCommands  ", &theCommands[i]);
+    }
 #endif
 
     // Send atomically via the serial port
-    if (pNCS->pSerialPort->SendPkt(*theCommand)) {
-        pNCS->nPktsSent++;
+    pNCS->sendLock.Lock();
+    if (pNCS->pSerialPort->SendPkts(theCommands, nCmds)) {
+        pNCS->nPktsSent += nCmds;
+        pNCS->sendLock.Unlock();
         return (MN_OK);
     }
+    pNCS->sendLock.Unlock();
 
     // Something went wrong!
     return (MN_ERR_SEND_FAILED);
 }
-
-
-// Same as infcSendCommand, but log in send log, we are not expecting response.
-cnErrCode MN_DECL infcSendCommandLog(
-    nodeushort cNum,                    // Port Index
-    packetbuf *theCommand) {            // Ptr to buffered command
-    cnErrCode theErr;
-    double txStart = infcCoreTime();
-    theErr = infcSendCommand(cNum, theCommand);
-    // If all OK, log it
-    if (cNum < NET_CONTROLLER_MAX && SysInventory[cNum].pNCS) {
-        SysInventory[cNum].logSend(theCommand, theErr, txStart);
-    }
-    return (theErr);
-}
-///                                                                            *
+//                                                                             *
 //******************************************************************************
 
 
@@ -4278,6 +5843,41 @@ MN_EXPORT cnErrCode MN_DECL infcSetCmdQueueLimit(
 //******************************************************************************
 
 
+//******************************************************************************
+//  NAME                                                                       *
+//      infcSetSingleHopRx
+//
+//  DESCRIPTION:
+//      Select where responses are completed. When <enable> is TRUE the
+//      serial reader thread matches each expected response to its waiter
+//      and restarts it directly, instead of queueing it for the read
+//      thread. Other packets still go through the read thread. The setting
+//      takes effect once the packets already queued are handled and is kept
+//      across restarts of the port.
+//
+//  RETURNS:
+//      #cnErrCode
+//
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL infcSetSingleHopRx(
+    netaddr cNum,
+    nodebool enable) {
+    // Bounds check arguments
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return (MN_ERR_BADARG);
+    }
+    SysInventory[cNum].SingleHopRx = enable;
+    netStateInfo *pNCS = SysInventory[cNum].pNCS;
+    if (pNCS && pNCS->pSerialPort) {
+        pNCS->pSerialPort->RegisterPktHook(
+            enable ? netStateInfo::singleHopRx : NULL, pNCS);
+    }
+    return (MN_OK);
+}
+//                                                                             *
+//******************************************************************************
+
+
 //******************************************************************************
 //  NAME                                                                       *
 //      infcSetTraceEnable
@@ -4935,6 +6535,9 @@ void infcFireErrCallback(infcErrInfo *pErrInfo, bool forced) {
     if (!pNCS) {
         return;
     }
+    // Mark the trace timeline
+    theNet.logMark(TRACE_MARK_ERR_CALLBACK, pErrInfo->errCode,
+                   Uint8(pErrInfo->node));
 
     // Prevent recursion here
     if (pNCS->errorRecursePrevent > 0) {
@@ -5114,6 +6717,8 @@ void infcFireNetEvent(netaddr cNum, enum NetworkChanges state) {
     }
     // Queue in the list if state is changing
     if (state != pNCS->LastEvent) {
+        // Mark the trace timeline
+        SysInventory[cNum].logMark(TRACE_MARK_NET_EVENT, MN_OK, Uint8(state));
         pNCS->NetChgListLock.Lock();
         unsigned nextTail;
         // Too many there now?
@@ -6188,7 +7793,7 @@ cnErrCode infcBrokenRingDiag(
     // Add a timeout because the other net could be sending commands
     while (((errRet = infcGetResponse(cNum, &theResp)) == MN_OK) &&
             (currentTimeMS - startTimeMS < 100)) {
-        theNet.logReceive(&theResp, errRet, NULL, infcCoreTime());
+        theNet.logReceive(&theResp, errRet, NULL, coreTimeNs());
 
         // A successful read happened, make sure the response is correct
         if (theResp.Fld.PktType == MN_PKT_TYPE_EXTEND_HIGH          // Right type
@@ -6206,7 +7811,7 @@ cnErrCode infcBrokenRingDiag(
         }       //  if ( correct packet type )
 
         currentTimeMS = infcCoreTime();
-        theNet.logReceive(&theResp, errRet, NULL, infcCoreTime());
+        theNet.logReceive(&theResp, errRet, NULL, coreTimeNs());
     }   // while(infcGetResponse(cNum, &theResp)==MN_OK) {
 
     // Put serial port back into pass-through
@@ -6480,6 +8085,243 @@ MN_EXPORT infcCmdCompleteCallback MN_DECL infcSetCmdCompleteFunc(
 //****************************************************************************
 
 
+//****************************************************************************
+//  NAME                                                                     *
+//      infcLatencyStatsGet
+//
+//  DESCRIPTION:
+/**
+    Copy one of the command latency histograms of a port. The histograms
+    are kept from the first time the port is opened.
+
+    \param[in] cNum Port index.
+    \param[in] scope Histogram grouping.
+    \param[in] key Node address for LATENCY_NODE, command code for
+    LATENCY_CMD, command class for LATENCY_QUEUE, ignored for LATENCY_PORT.
+    \param[out] pHist Copy of the histogram.
+    \param[in] reset Clear the histogram as it is copied. Each count is
+    exchanged with zero so no completion is lost between the copy and the
+    clear.
+**/
+//  RETURNS:
+//      Standard return codes
+//
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL infcLatencyStatsGet(
+    netaddr cNum,
+    latencyScopes scope,
+    nodeulong key,
+    mnLatencyHist *pHist,
+    nodebool reset) {
+    mnLatencyHist *pSrc;
+    unsigned i;
+
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return MN_ERR_DEV_ADDR;
+    }
+    if (!pHist) {
+        return MN_ERR_BADARG;
+    }
+    latencyTables *pTables = SysInventory[cNum].pLatency;
+    if (!pTables) {
+        return MN_ERR_CLOSED;
+    }
+    switch (scope) {
+        case LATENCY_PORT:
+            pSrc = &pTables->port;
+            break;
+        case LATENCY_NODE:
+            if (key >= MN_API_MAX_NODES) {
+                return MN_ERR_BADARG;
+            }
+            pSrc = &pTables->node[key];
+            break;
+        case LATENCY_CMD:
+            if (key >= MN_LAT_CMD_CNT) {
+                return MN_ERR_BADARG;
+            }
+            pSrc = &pTables->cmd[key];
+            break;
+        case LATENCY_QUEUE:
+            if (key >= CMD_CLASS_CNT) {
+                return MN_ERR_BADARG;
+            }
+            pSrc = &pTables->queue[key];
+            break;
+        default:
+            return MN_ERR_BADARG;
+    }
+    if (reset) {
+        pHist->Count = CCatomicTake(&pSrc->Count);
+        pHist->SumUs = CCatomicTake(&pSrc->SumUs);
+        pHist->MaxUs = CCatomicTake(&pSrc->MaxUs);
+        pHist->Timeouts = CCatomicTake(&pSrc->Timeouts);
+        for (i = 0; i < MN_LAT_BUCKETS; i++) {
+            pHist->Buckets[i] = CCatomicTake(&pSrc->Buckets[i]);
+        }
+    }
+    else {
+        *pHist = *pSrc;
+    }
+    return MN_OK;
+}
+//                                                                           *
+//****************************************************************************
+
+
+//****************************************************************************
+//  NAME                                                                     *
+//      infcLatencyStatsReset
+//
+//  DESCRIPTION:
+/**
+    Clear all the command latency histograms of a port.
+
+    \param[in] cNum Port index.
+**/
+//  RETURNS:
+//      Standard return codes
+//
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL infcLatencyStatsReset(
+    netaddr cNum) {
+    mnLatencyHist discard;
+    nodeulong key;
+    cnErrCode theErr;
+
+    theErr = infcLatencyStatsGet(cNum, LATENCY_PORT, 0, &discard, TRUE);
+    for (key = 0; theErr == MN_OK && key < MN_API_MAX_NODES; key++) {
+        theErr = infcLatencyStatsGet(cNum, LATENCY_NODE, key, &discard, TRUE);
+    }
+    for (key = 0; theErr == MN_OK && key < MN_LAT_CMD_CNT; key++) {
+        theErr = infcLatencyStatsGet(cNum, LATENCY_CMD, key, &discard, TRUE);
+    }
+    for (key = 0; theErr == MN_OK && key < CMD_CLASS_CNT; key++) {
+        theErr = infcLatencyStatsGet(cNum, LATENCY_QUEUE, key, &discard,
+                                     TRUE);
+    }
+    return theErr;
+}
+//                                                                           *
+//****************************************************************************
+
+
+//****************************************************************************
+//  NAME                                                                     *
+//      infcSetRespTimeouts
+//
+//  DESCRIPTION:
+/**
+    Set the bounds of the response time-outs for all ports.
+
+    Parameter reads and short control commands wait for a time-out learned
+    from the recent round trips to their node, never below \a floorMs nor
+    above \a ceilingMs. Other commands, and all commands until a node has
+    answered enough of them, wait \a ceilingMs.
+
+    \param[in] floorMs Shortest adaptive time-out, 0 to always wait
+    \a ceilingMs.
+    \param[in] ceilingMs Fixed time-out.
+**/
+//  RETURNS:
+//      Standard return codes
+//
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL infcSetRespTimeouts(
+    nodeulong floorMs,
+    nodeulong ceilingMs) {
+    if (ceilingMs == 0 || floorMs > ceilingMs) {
+        return MN_ERR_BADARG;
+    }
+    InfcRespTimeOutMin = floorMs;
+    InfcRespTimeOut = ceilingMs;
+    return MN_OK;
+}
+//                                                                           *
+//****************************************************************************
+
+
+//****************************************************************************
+//  NAME                                                                     *
+//      infcCmdClassSet
+//
+//  DESCRIPTION:
+/**
+    Set the scheduling class of the commands sent by the calling thread.
+    Node stops, triggers and motion commands keep their own class when it
+    is more urgent.
+
+    \param[in] newClass Class for the thread's commands.
+**/
+//  RETURNS:
+//      The previous class of the thread
+//
+//  SYNOPSIS:
+MN_EXPORT cmdClasses MN_DECL infcCmdClassSet(
+    cmdClasses newClass) {
+    cmdClasses oldClass = threadCmdClass;
+
+    if (unsigned(newClass) < CMD_CLASS_CNT) {
+        threadCmdClass = newClass;
+    }
+    return oldClass;
+}
+//                                                                           *
+//****************************************************************************
+
+
+//****************************************************************************
+//  NAME                                                                     *
+//      infcStartupProfileGet
+//
+//  DESCRIPTION:
+/**
+    Copy the profile of the last startup of a port. A copy taken while the
+    port is starting holds the phases done so far.
+
+    \param[in] cNum Port index.
+    \param[out] pProfile The profile copy.
+**/
+//  RETURNS:
+//      Standard return codes
+//
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL infcStartupProfileGet(
+    netaddr cNum,
+    mnStartupProfile *pProfile) {
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return MN_ERR_DEV_ADDR;
+    }
+    if (!pProfile) {
+        return MN_ERR_BADARG;
+    }
+    *pProfile = SysInventory[cNum].StartupProfile;
+    return MN_OK;
+}
+//                                                                           *
+//****************************************************************************
+
+
+//****************************************************************************
+//  NAME                                                                     *
+//      infcStartupProfileTrace
+//
+//  DESCRIPTION:
+/**
+    Write each startup phase to the command trace as a marker record when
+    it ends, for all ports.
+
+    \param[in] enable Set to write the marks.
+**/
+//  SYNOPSIS:
+MN_EXPORT void MN_DECL infcStartupProfileTrace(
+    nodebool enable) {
+    InfcStartupTrace = enable ? TRUE : FALSE;
+}
+//                                                                           *
+//****************************************************************************
+
+
 //****************************************************************************
 //  NAME                                                                     *
 //      infcSetInvalCacheFunc
@@ -6620,6 +8462,79 @@ MN_EXPORT cnErrCode MN_DECL infcGetHostErrStats(
 //******************************************************************************
 
 
+//******************************************************************************
+//  NAME                                                                       *
+//      infcTraceHeaderFill
+//
+//  DESCRIPTION:
+//      Fill in the trace file header fields shared by trace dumps and trace
+//      streams. The record counts, next record indices and trace length are
+//      left for the caller.
+//
+//  SYNOPSIS:
+void infcTraceHeaderFill(netaddr cNum, traceHeader &theHeader) {
+    unsigned node;
+
+    theHeader.hdrLen = sizeof(theHeader);
+    theHeader.type = DUMP_TYPE_NUM;
+    //02-06-2012 DS Not sure why this is off by one?
+    theHeader.numOfNodes = SysInventory[cNum].InventoryLast.NumOfNodes - 1;
+    theHeader.version = infcVersion();
+    theHeader.kernVersion = 0;
+    infcFileNameA(theHeader.filename, TRACE_FILEPATH_LEN);
+#if (defined(_WIN32)||defined(_WIN64))
+    _ftime(&theHeader.timestamp);
+#else
+    // Convert to 64 bit time buffer
+    struct timeb lclTime;
+    ftime(&lclTime);
+    theHeader.timestamp.time = lclTime.time;
+    theHeader.timestamp.millitm = lclTime.millitm;
+    theHeader.timestamp.timezone = lclTime.timezone;
+    theHeader.timestamp.dstflag = lclTime.dstflag;
+#endif
+    theHeader.diags = NetDiags[cNum];
+    for (node = 0; node < MN_API_MAX_NODES; node++) {
+        theHeader.nodeTypes[node] =
+            SysInventory[cNum].InventoryNow.LastIDs[node];
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      infcTraceRxExpand / infcTraceTxExpand
+//
+//  DESCRIPTION:
+//      Expand a complete trace ring slot into its trace file record.
+//
+//  SYNOPSIS:
+void infcTraceRxExpand(const rxTraceSlot &slot, rxTraceBuf &rec) {
+    rec.timeStamp = coreNsToMs(slot.timeNs);
+    rec.sendCnt = slot.sendCnt;
+    rec.sendSer = slot.sendSer;
+    rec.order = traceSlotSerial(slot.seq);
+    memcpy(rec.packet.Byte.Buffer, slot.bytes, slot.len);
+    rec.packet.Byte.BufferSize = slot.len;
+    rec.__pad = 0;
+    rec.error = slot.error;
+}
+
+void infcTraceTxExpand(const txTraceSlot &slot, txTraceBuf &rec) {
+    rec.timeStamp = coreNsToMs(slot.timeNs);
+    rec.order = traceSlotSerial(slot.seq);
+    rec.depth = slot.depth;
+    memcpy(rec.packet.Byte.Buffer, slot.bytes, slot.len);
+    rec.packet.Byte.BufferSize = slot.len;
+    rec.failed = slot.failed;
+    rec.pad = 0;
+}
+//                                                                             *
+//******************************************************************************
+
+
 //******************************************************************************
 // NAME                                                                        *
 //      infcTraceDumpA
@@ -6664,8 +8579,7 @@ MN_EXPORT cnErrCode MN_DECL infcTraceDump(
     netaddr cNum,
     const wchar_t *pFilePath) {
     std::ofstream outStream;
-    Uint32 len;
-    txTraceBuf zero;
+    Uint32 len, serNum, nextSerNum;
     traceHeader theHeader;
     cnErrCode theErr = MN_OK;
     mnNetInvRecords &theNet = SysInventory[cNum];
@@ -6692,70 +8606,56 @@ MN_EXPORT cnErrCode MN_DECL infcTraceDump(
     if (!outStream.write((char *)&len, sizeof(len))) {
         return (MN_ERR_OS);
     }
-    // Lock out updates
-    theNet.RXlogLock.Lock();
-    theNet.TXlogLock.Lock();
-    // Send the header
-    theHeader.type = DUMP_TYPE_NUM;
-    //02-06-2012 DS Not sure why this is off by one?
-    theHeader.numOfNodes = SysInventory[cNum].InventoryLast.NumOfNodes - 1;
-    theHeader.nextRXrecord = (Uint32)theNet.rxTraceIndx;
-    theHeader.nextTXrecord = (Uint32)theNet.txTraceIndx;
-    theHeader.version = infcVersion();
-    theHeader.kernVersion = 0;
-    theHeader.traceLen = SEND_DEPTH;
-    theHeader.hdrLen = sizeof(theHeader);
-    infcFileNameA(theHeader.filename, TRACE_FILEPATH_LEN);
-#if (defined(_WIN32)||defined(_WIN64))
-    _ftime(&theHeader.timestamp);
-#else
-    // Convert to 64 bit time buffer
-    struct timeb lclTime;
-    ftime(&lclTime);
-    theHeader.timestamp.time = lclTime.time;
-    theHeader.timestamp.millitm = lclTime.millitm;
-    theHeader.timestamp.timezone = lclTime.timezone;
-    theHeader.timestamp.dstflag = lclTime.dstflag;
-#endif
-    if (theNet.respSerNum < SEND_DEPTH) {
-        len = theNet.respSerNum;
-    }
-    else {
-        len = SEND_DEPTH;
-    }
-    theHeader.nRXrecords = len;
-    if (theNet.sendSerNum < SEND_DEPTH) {
-        len = theNet.sendSerNum;
-    }
-    else {
-        len = SEND_DEPTH;
+    // Expand the trace rings into file records. Writers keep running, so
+    // take the serial numbers first and copy each slot untorn. A slot that
+    // cannot be read untorn is left as an all zero record, which the trace
+    // tools skip as an empty slot.
+    Uint32 rxSerNum = theNet.respSerNum;
+    Uint32 txSerNum = theNet.sendSerNum;
+    rxTraceBuf *rxRecs = new rxTraceBuf[RECV_DEPTH]();
+    txTraceBuf *txRecs = new txTraceBuf[SEND_DEPTH]();
+    Uint32 nRX = rxSerNum < RECV_DEPTH ? rxSerNum : RECV_DEPTH;
+    Uint32 nTX = txSerNum < SEND_DEPTH ? txSerNum : SEND_DEPTH;
+    for (serNum = rxSerNum - nRX; serNum != rxSerNum; serNum++) {
+        rxTraceSlot slot;
+        if (traceSlotRead(theNet.rxTraces[serNum % RECV_DEPTH], slot)) {
+            infcTraceRxExpand(slot, rxRecs[serNum % RECV_DEPTH]);
+        }
     }
-    theHeader.nTXrecords = len;
-    theHeader.diags = NetDiags[cNum];
-    for (len = 0; len < MN_API_MAX_NODES; len++) {
-        theHeader.nodeTypes[len] =
-            SysInventory[cNum].InventoryNow.LastIDs[len];
+    for (serNum = txSerNum - nTX; serNum != txSerNum; serNum++) {
+        txTraceSlot slot;
+        if (traceSlotRead(theNet.txTraces[serNum % SEND_DEPTH], slot)) {
+            infcTraceTxExpand(slot, txRecs[serNum % SEND_DEPTH]);
+        }
     }
+    // Send the header
+    infcTraceHeaderFill(cNum, theHeader);
+    nextSerNum = rxSerNum ? rxSerNum - 1 : 0;
+    theHeader.nextRXrecord = nextSerNum % RECV_DEPTH;
+    nextSerNum = txSerNum ? txSerNum - 1 : 0;
+    theHeader.nextTXrecord = nextSerNum % SEND_DEPTH;
+    theHeader.traceLen = SEND_DEPTH;
+    theHeader.nRXrecords = nRX;
+    theHeader.nTXrecords = nTX;
     if (!outStream.write((char *)&theHeader.type,
                          sizeof(theHeader) - sizeof(len))) {
         theErr = MN_ERR_OS;
     }
     // Store the receive information
     if (theErr == MN_OK
-        && !outStream.write((char *)&theNet.rxTraces[0],
+        && !outStream.write((char *)&rxRecs[0],
                             sizeof(rxTraceBuf)*theHeader.nRXrecords)) {
         theErr = MN_ERR_OS;
     }
 
     // Store the transmit information
     if (theErr == MN_OK
-        && !outStream.write((char *)&theNet.txTraces[0],
+        && !outStream.write((char *)&txRecs[0],
                             sizeof(txTraceBuf)*theHeader.nTXrecords)) {
         theErr = MN_ERR_OS;
     }
-    // Release the lock on the trace updates
-    theNet.RXlogLock.Unlock();
-    theNet.TXlogLock.Unlock();
+    delete[] rxRecs;
+    delete[] txRecs;
     // Got the file open, write out the buffer
     outStream.close();
     return (theErr);
@@ -7078,6 +8978,9 @@ int netPollerThread::Run(void *context) {
     netaddr cNum = pNCS->cNum;
     multiaddr theNodeAddr = MULTI_ADDR(cNum, 0);
     mnNetInvRecords &theNet = SysInventory[pNCS->cNum];
+    // The keep-alive only matters when the port is idle, never hold
+    // application commands up for it
+    infcCmdClassSet(CMD_CLASS_POLL);
 
 #if TRACE_POLL_THRD||TRACE_THREAD
     _RPT3(_CRT_WARN,
@@ -8083,6 +9986,7 @@ mnNetInvRecords::mnNetInvRecords() {
     clearNodes(false);
     Initializing = 0;
     NumCmdsInRing = N_CMDS_IN_RING;
+    SingleHopRx = false;
     AutoDiscoveryEnable = true;
     KeepAlivePollEnable = true;
     KeepAlivePollRestoreState = true;
@@ -8100,10 +10004,14 @@ mnNetInvRecords::mnNetInvRecords() {
     TraceCount = 0;                         // No traces yet
     sendSerNum = 0;                         // Start counting from 0
     respSerNum = 0;
-    txTraceIndx = 0;
-    rxTraceIndx = 0;
     txTraces = NULL;
     rxTraces = NULL;
+    pTraceStream = NULL;
+    pLatency = NULL;
+    pCyclic = NULL;
+    memset(&StartupProfile, 0, sizeof(StartupProfile));
+    StartupCmds0 = 0;
+    pParamFlights = NULL;
 }
 //                                                                             *
 //******************************************************************************
@@ -8118,6 +10026,12 @@ mnNetInvRecords::mnNetInvRecords() {
     Construct the network inventory records
 */
 mnNetInvRecords::~mnNetInvRecords() {
+    // Stop refreshing before the port goes
+    delete pCyclic;
+    pCyclic = NULL;
+    // Stop streaming before the rings go
+    delete pTraceStream;
+    pTraceStream = NULL;
     if (txTraces) {
         delete[] txTraces;
     }
@@ -8126,6 +10040,8 @@ mnNetInvRecords::~mnNetInvRecords() {
     }
     txTraces = NULL;
     rxTraces = NULL;
+    delete pLatency;
+    pLatency = NULL;
     clearNodes(true);
     delete pPortCls;
     pPortCls = NULL;
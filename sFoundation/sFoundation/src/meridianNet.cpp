@@ -160,6 +160,7 @@ cnErrCode MN_DECL mnInitializeProc(
 
     infcFireNetEvent(cNum, NODES_RESETTING);
     infcSetInitializeMode(cNum, TRUE, MN_OK);
+    startupTimer::Begin(cNum);
 
     // Halt the offline recovery tickler if running
     infcHaltAutoNetDiscovery(cNum);
@@ -185,10 +186,12 @@ cnErrCode MN_DECL mnInitializeProc(
     // definitively set this.
     theNet.clearNodes(false);
     int16 stackIn = theNet.Initializing;
+    startupTimer portTime(cNum, STARTUP_START_PORT);
     startErr = infcStopController(cNum);
     if (startErr == MN_OK) {
         startErr = infcStartController(cNum);
     }
+    portTime.End();
     // We are always one away from here
     theNet.Initializing = stackIn;
 
@@ -208,7 +211,9 @@ cnErrCode MN_DECL mnInitializeProc(
         // Reset all the nodes once if desired
         if (resetNodes && initErr == MN_OK) {
             // Start error will reflect reset failure
+            startupTimer resetTime(cNum, STARTUP_RESET);
             resetErr = netReset(addr, singleNode ? FALSE : TRUE);
+            resetTime.End();
             if (resetErr != MN_OK) {
                 infcErrInfo errInfo;
                 _RPT3(_CRT_WARN,
@@ -224,20 +229,26 @@ cnErrCode MN_DECL mnInitializeProc(
                 infcFireErrCallback(&errInfo, true);
             }
             // Insure failed reset gets net @ same rate
+            startupTimer rateTime(cNum, STARTUP_RESET_RATE);
             lastErr = infcResetNetRate(cNum);
         }
-        // Let stuff settle out
-        infcSleep(100);
-        // Kill any data that trickled in
+        startupTimer settleTime(cNum, STARTUP_SETTLE);
+        // Kill any data that trickled in, the flush waits for the line
+        // to settle out
         infcFlush(cNum);
+        settleTime.End();
         // Fire up the nodes and note the inventory count
         theNet.InventoryNow.NumOfNodes = 0;         // Start net @ 0
+        startupTimer addrTime(cNum, STARTUP_SET_ADDRESS);
         initErr = netSetAddress(cNum, &theNet.InventoryNow.NumOfNodes);
+        addrTime.End();
         // Set boolean to reflect the basic presence of nodes
         if (initErr == MN_OK) {
             foundNetworkNodes = theNet.InventoryNow.NumOfNodes >= 1;
             // Set the network rate to requested rate
+            startupTimer rateTime(cNum, STARTUP_SET_RATE);
             initErr = infcSetNetRate(cNum, pPortSpec->PortRate);
+            rateTime.End();
             if (initErr != MN_OK) {
                 // Unwind init stack and report error, too serious to run
                 infcErrInfo errInfo;
@@ -247,6 +258,7 @@ cnErrCode MN_DECL mnInitializeProc(
                 infcSetInitializeMode(cNum, FALSE, initErr);
                 // Force a message back to UI or application
                 infcFireErrCallback(&errInfo, true);
+                startupTimer::Finish(cNum, initErr);
                 return (initErr);
             }
         }
@@ -261,6 +273,7 @@ cnErrCode MN_DECL mnInitializeProc(
         // we can determine the problem.
         if (!diagsOff && initErr != MN_OK)  {
             // Run the network diagnostics to detect broken ring
+            startupTimer diagTime(cNum, STARTUP_RING_DIAG);
             initErr = netBreakErr
                       = infcBrokenRingDiag(cNum, foundNetworkNodes,
                                            theNet.InventoryNow.NumOfNodes);
@@ -275,6 +288,7 @@ cnErrCode MN_DECL mnInitializeProc(
             infcTraceDumpNext(cNum);
             infcSetInitializeMode(cNum, FALSE, netBreakErr);
             //infcFireNetEvent(cNum, NODES_ONLINE_NO_TEST);
+            startupTimer::Finish(cNum, netBreakErr);
             return (netBreakErr);
         }
         // ---- END - Diagnostics: Run if node initialize not successful ----
@@ -282,6 +296,7 @@ cnErrCode MN_DECL mnInitializeProc(
 
         // We got some nodes, enumerate them
         if (initErr == MN_OK && foundNetworkNodes) {
+            startupTimer enumTime(cNum, STARTUP_ENUMERATE);
             startErr = netEnumerate(cNum);
         }
         else {
@@ -304,6 +319,7 @@ cnErrCode MN_DECL mnInitializeProc(
                     lastErr = resetErr;
                 }
                 infcFlushProc(cNum);
+                theNet.pNCS->completeCanceled();
                 // If problems, start the search to wait for it repair
                 infcSetInitializeMode(cNum, FALSE, lastErr);
                 if (lastErr != MN_OK)
@@ -322,6 +338,7 @@ cnErrCode MN_DECL mnInitializeProc(
                 infcSetInitializeMode(cNum, FALSE, lastErr);
                 // Start looking for network to re-appear
                 infcStartAutoNetDiscovery(cNum, lastErr);
+                startupTimer::Finish(cNum, lastErr);
                 return (lastErr);
             default:
                 _RPT1(_CRT_WARN,
@@ -362,11 +379,53 @@ cnErrCode MN_DECL mnInitializeProc(
         infcTraceDumpNext(cNum);
     }
 
+    startupTimer::Finish(cNum, lastErr);
     return (lastErr);
 }
 //                                                                             *
 //******************************************************************************
 
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      portInitThread class
+//
+//  DESCRIPTION
+/**
+    Runs mnInitializeProc for one port so the ports of a system come up
+    together. Each port's bring-up only touches that port's records, the
+    longest port sets the startup time instead of the sum of them.
+**/
+//  SYNOPSIS:
+class portInitThread : public CThread
+{
+private:
+    nodebool m_resetNodes;          // Reset the nodes first
+    netaddr m_cNum;                 // Port to initialize
+    const portSpec *m_pPortSpec;    // Its port information
+
+public:
+    cnErrCode Result;               // mnInitializeProc outcome
+
+    portInitThread(nodebool resetNodes, netaddr cNum,
+                   const portSpec *pPortSpec) :
+        m_resetNodes(resetNodes),
+        m_cNum(cNum),
+        m_pPortSpec(pPortSpec),
+        Result(MN_ERR_FAIL) {
+    }
+
+protected:
+    int Run(void *context) {
+        Result = mnInitializeProc(m_resetNodes, false, MULTI_ADDR(m_cNum, 0),
+                                  m_pPortSpec, NULL);
+        return (0);
+    }
+};
+//                                                                             *
+//******************************************************************************
+
 /// \endcond
 
 
@@ -434,6 +493,10 @@ MN_EXPORT cnErrCode MN_DECL mnInitializeNets(
     nodes. The function arguments describe the serial ports to utilize, the
     type of nodes attached and the desired communications speed.
 
+    The ports are brought up concurrently, each on its own thread, so the
+    startup time is that of the slowest port. Error callbacks fired during
+    the bring-up may therefore arrive from these threads.
+
     \param[in] resetNodes
         - True = Reset all individual nodes before establishing channel
         - False = Just establish communication
@@ -461,6 +524,7 @@ MN_EXPORT cnErrCode MN_DECL mnInitializeSystem(
     extern int InitializingGlobal;
     unsigned cNum, initFailures, portFailures, baudFailures;
     cnErrCode initErr[NET_CONTROLLER_MAX], theErr;
+    portInitThread *pInit[NET_CONTROLLER_MAX];
 
     //DBG_LOG("mnInitializeSystem\n");
     // Bounds check the table
@@ -487,15 +551,32 @@ MN_EXPORT cnErrCode MN_DECL mnInitializeSystem(
     // Start with no ports
     SysPortCount = 0;
     baudFailures = initFailures = portFailures = 0;
-    // Initialize them in turn
     for (netaddr i = 0 ; i < netCount ; i++) {
         // Defer "online/offline/error" events until completed
         infcSetInitializeMode(i, TRUE, MN_OK);
         // Save our port and speed information for later
         infcSetPortSpecifier(i, &controllers[i]);
-        // Perform net enumeration and node class initialization if possible
-        initErr[i] = mnInitializeProc(resetNodes, false, MULTI_ADDR(i, 0),
-                                      &controllers[i], NULL);
+    }
+    // Perform net enumeration and node class initialization if possible,
+    // all ports at once when there is more than one.
+    if (netCount == 1) {
+        initErr[0] = mnInitializeProc(resetNodes, false, MULTI_ADDR(0, 0),
+                                      &controllers[0], NULL);
+    }
+    else {
+        for (netaddr i = 0 ; i < netCount ; i++) {
+            pInit[i] = new portInitThread(resetNodes, i, &controllers[i]);
+            pInit[i]->LaunchThread(pInit[i]);
+        }
+        for (netaddr i = 0 ; i < netCount ; i++) {
+            // Joins the thread, its Run ends when the port is done
+            pInit[i]->TerminateAndWait();
+            initErr[i] = pInit[i]->Result;
+            delete pInit[i];
+        }
+    }
+    // Merge the outcomes in port order
+    for (netaddr i = 0 ; i < netCount ; i++) {
         // How did this initialization go?
         switch (initErr[i]) {
             case MN_OK:
@@ -990,6 +1071,8 @@ MN_EXPORT cnErrCode MN_DECL mnShutdown(void) {
     cnErrCode theErr, compositeErr = MN_OK;
 
     for (netaddr i = 0; i < NET_CONTROLLER_MAX; i++) {
+        // Background reads end before the port does
+        netCyclicStop(i);
         if (infcOnline(i))
             // Tell everyone to stop using us
         {
@@ -1002,6 +1085,8 @@ MN_EXPORT cnErrCode MN_DECL mnShutdown(void) {
         }
     }
     SysPortCount = 0;
+    // Save what the closed nodes learned for the next start
+    coreParamCacheFlush();
     return (compositeErr);
 }
 //                                                                             *
@@ -220,6 +220,25 @@ const char *const unitStrs[] = {
 // it's not exposed publicly
 const int CPM_P_USER_DESCR_BASE = 540;
 
+// Cached values the ClearPath-SC node refresh reads during enumeration.
+// They are read for every node in one burst first, so the refreshes find
+// them in the parameter database.
+static const nodeparam CPM_ENUM_PRELOAD[] = {
+    MN_P_OPTION_REG,
+    CPM_P_FW_VERS,
+    CPM_P_CMD_CNTS_PER_REV,
+    CPM_P_DRV_ADC_MAX,
+    CPM_P_DRV_I_MAX,
+    CPM_P_DRV_RMS_LIM,
+    CPM_P_USER_DESCR_BASE,
+    CPM_P_USER_DESCR_BASE + 1,
+    CPM_P_USER_DESCR_BASE + 2,
+    CPM_P_USER_DESCR_BASE + 3,
+    CPM_P_USER_DESCR_BASE + 4
+};
+#define CPM_ENUM_PRELOAD_CNT \
+    (sizeof(CPM_ENUM_PRELOAD) / sizeof(CPM_ENUM_PRELOAD[0]))
+
 // Cracker for long form version strings
 typedef union _lvers {
     nodeulong   bits;
@@ -242,6 +261,11 @@ typedef union _lvers {
 //  netCore.c function prototypes
 //
 // Local Function Prototype
+// Format the node access level query
+static void netGetNodeAccessLvlFmt(
+    packetbuf *pCmd,            // Command to fill in
+    nodeaddr theNode);          // Node address
+
 // Convert a buffer area to a double based on the parameter information
 //cnErrCode coreBufToValue(
 //      const paramInfoLcl *info,   // Parameter information
@@ -387,11 +411,29 @@ netaddr coreController(multiaddr theMultiAddr) {
 MN_EXPORT cnErrCode MN_DECL netEnumerate(
     netaddr cNum) {             // Controller number
     cnErrCode theErr = MN_OK, lastErr = MN_OK;
-    nodeulong i;
+    nodeulong i, j;
     nodeulong maxNode;
-    packetbuf theResp;
     mnClassInfo *pClassInfo;
     mnNetInvRecords &netInv = SysInventory[cNum];
+    // Identification burst
+    multiaddr idAddrs[MN_API_MAX_NODES];
+    nodeparam idParams[MN_API_MAX_NODES];
+    packetbuf ids[MN_API_MAX_NODES];
+    packetbuf accessCmds[MN_API_MAX_NODES], accessResps[MN_API_MAX_NODES];
+    cnErrCode idErrs[MN_API_MAX_NODES], accessErrs[MN_API_MAX_NODES];
+    // Nodes whose class object is refreshed after the preload
+    bool refreshNode[MN_API_MAX_NODES];
+    // Those of them filled from the parameter cache file
+    nodeaddr cpmNodes[MN_API_MAX_NODES];
+    bool cacheHits[MN_API_MAX_NODES];
+    nodeulong nCpm = 0;
+    std::vector<multiaddr> preAddrs;
+    std::vector<nodeparam> preParams;
+    std::vector<paramValue> preVals;
+    std::vector<cnErrCode> preErrs;
+#if defined(_DEBUG) && LCL_INIT_PR
+    double startMs = infcCoreTime();
+#endif
 
     // Get current controller
     infcSetInitializeMode(cNum, TRUE, MN_OK);
@@ -420,19 +462,37 @@ MN_EXPORT cnErrCode MN_DECL netEnumerate(
                 return theErr;
             }
         }
+        if (maxNode > MN_API_MAX_NODES) {
+            maxNode = MN_API_MAX_NODES;
+        }
+        // Identify all the nodes at once, the device IDs and access levels
+        // go out back to back instead of two round trips per node.
+        startupTimer idTime(cNum, STARTUP_IDENTIFY);
         for (i = 0; i < maxNode; i++) {
+            idAddrs[i] = MULTI_ADDR(cNum, i);
+            idParams[i] = MN_P_NODEID;
+            netGetNodeAccessLvlFmt(&accessCmds[i], nodeaddr(i));
+            refreshNode[i] = false;
+        }
+        netGetParameterRawList(cNum, maxNode, idAddrs, idParams, ids, idErrs);
+        netRunCommandBatch(cNum, accessCmds, accessResps, maxNode,
+                           accessErrs);
+        idTime.End();
+
+        for (i = 0; i < maxNode; i++) {
+            startupTimer setupTime(cNum, STARTUP_CLASS_SETUP, int(i));
             pClassInfo = NULL;
             // Get the device type from the
-            theErr = netGetParameter(MULTI_ADDR(cNum, i),
-                                     MN_P_NODEID, &theResp);
+            theErr = idErrs[i];
             // Correct packet and size?
-            if (theErr == MN_OK && theResp.Byte.BufferSize == 2) {
-                theErr = netGetNodeAccessLvl(MULTI_ADDR(cNum, i),
-                                             &netInv.AccessInfo[i]);
+            if (theErr == MN_OK && ids[i].Byte.BufferSize == 2) {
+                theErr = accessErrs[i];
+                netInv.AccessInfo[i].bits =
+                    *(nodeushort *)&accessResps[i].Byte.Buffer[RESP_LOC];
                 if (theErr == MN_OK) {
                     // Setup data for coreGetDevType
                     netInv.NodeInfo[i].theID =
-                        *((devID_t *)&theResp.Byte.Buffer[0]);
+                        *((devID_t *)&ids[i].Byte.Buffer[0]);
                     // Initialize the nodes and reverse ranking
                     switch (netInv.NodeInfo[i].theID.fld.devType) {
                         case NODEID_MD:
@@ -460,20 +520,9 @@ MN_EXPORT cnErrCode MN_DECL netEnumerate(
                             pClassInfo = &netInv.InventoryNow.mnCpScInfo;
                             lastErr = cpmInitializeEx(MULTI_ADDR(cNum, i),
                                                       TRUE);
-                            // If we have a port, setup nodes
-                            if (netInv.pPortCls) {
-                                try {
-                                    // sync up the node
-                                    netInv.pNodes[i]->Refresh();
-                                }
-                                catch (sFnd::mnErr theErr) {
-                                    // Something failed
-                                    lastErr = theErr.ErrorCode;
-                                }
-                                catch (...) {
-                                    return MN_ERR_FAIL;
-                                }
-                            }
+                            // If we have a port, setup nodes once all
+                            // are known
+                            refreshNode[i] = netInv.pPortCls != NULL;
                             // Adjust the cleanup masks
                             for (size_t j = 0; j < MN_API_MAX_NODES; j++) {
                                 netInv.attnCleanupMask[j] = 0xffffffff;
@@ -497,6 +546,68 @@ MN_EXPORT cnErrCode MN_DECL netEnumerate(
                 lastErr = theErr;
             }
         }
+
+        // Nodes known from an earlier start are filled from the cache. The
+        // device IDs read above are entered first so they are not read
+        // again.
+        startupTimer preTime(cNum, STARTUP_PRELOAD);
+        for (i = 0; i < maxNode; i++) {
+            if (refreshNode[i]) {
+                coreParamPrefill(MULTI_ADDR(cNum, i), MN_P_NODEID, &ids[i]);
+                cpmNodes[nCpm++] = nodeaddr(i);
+            }
+        }
+        coreParamCacheApply(cNum, nCpm, cpmNodes, cacheHits);
+
+        // Read what the node refreshes need in one burst, skipping what
+        // the identity reads and the cache already entered. The cache
+        // holds no settings, so nodes found in it still read those.
+        // Failures are left for the refreshes to read and report.
+        for (i = 0; i < maxNode; i++) {
+            if (!refreshNode[i]) {
+                continue;
+            }
+            for (j = 0; j < CPM_ENUM_PRELOAD_CNT; j++) {
+                if (coreParamCached(MULTI_ADDR(cNum, i),
+                                    CPM_ENUM_PRELOAD[j], NULL)) {
+                    continue;
+                }
+                preAddrs.push_back(MULTI_ADDR(cNum, i));
+                preParams.push_back(CPM_ENUM_PRELOAD[j]);
+            }
+        }
+        if (!preAddrs.empty()) {
+            preVals.resize(preAddrs.size());
+            preErrs.resize(preAddrs.size());
+            netGetParameterList(cNum, nodeulong(preAddrs.size()),
+                                &preAddrs[0], &preParams[0], &preVals[0],
+                                &preErrs[0]);
+        }
+        preTime.End();
+        for (i = 0; i < maxNode; i++) {
+            if (!refreshNode[i]) {
+                continue;
+            }
+            startupTimer setupTime(cNum, STARTUP_CLASS_SETUP, int(i));
+            try {
+                // sync up the node
+                netInv.pNodes[i]->Refresh();
+            }
+            catch (sFnd::mnErr theErr) {
+                // Something failed
+                lastErr = theErr.ErrorCode;
+            }
+            catch (...) {
+                return MN_ERR_FAIL;
+            }
+        }
+        // Add the nodes that were not in the cache
+        for (i = 0; i < nCpm; i++) {
+            if (!cacheHits[i]) {
+                coreParamCacheCapture(MULTI_ADDR(cNum, cpmNodes[i]));
+            }
+        }
+        coreParamCacheFlush();
     }
     // Initialize the remaining nodes to 'unknown'
     for (i = maxNode + 1 ; i < MN_API_MAX_NODES; i++) {
@@ -509,6 +620,10 @@ MN_EXPORT cnErrCode MN_DECL netEnumerate(
 
     // No more commands to protect
     infcSetInitializeMode(cNum, FALSE, lastErr);
+#if defined(_DEBUG) && LCL_INIT_PR
+    _RPT4(_CRT_WARN, "%.1f netEnumerate(%d): %d nodes in %.1f ms\n",
+          infcCoreTime(), cNum, int(maxNode), infcCoreTime() - startMs);
+#endif
 
     return lastErr;
 }
@@ -896,35 +1011,15 @@ MN_EXPORT cnErrCode MN_DECL netSetMotorFileName(
 
 //****************************************************************************
 //  NAME
-//      netRunCommand
+//      netRunCmdPrep
 //
 //  DESCRIPTION:
-//      This function will send the specified command on the <cNum>
-//      and wait for the response and stores its response in <pTheResp>.
-//
-//      If <pTheResp> is NULL, this command returns MN_OK if the network
-//      controller accepts the command.
-//
-//  RETURNS:
-//      cnErrCode
+//      Initialize the invariant command fields and frame length of
+//      <pTheCmd> from its packet length.
 //
 //  SYNOPSIS:
-MN_EXPORT cnErrCode MN_DECL netRunCommand(
-    netaddr cNum,               // Controller number
-    packetbuf *pTheCmd,     // pointer to filled in command
-    packetbuf *pTheResp) {
-#define RUN_CMD_ERR_DBG (_DEBUG&&1)         // Show err src
-    cnErrCode theErr = MN_OK;
-    infcErrInfo errInfo;                    // Error reporting buffer
-
-    if (pTheResp == NULL) {
-        return (MN_ERR_BADARG);
-    }
-
-    if (cNum > NET_CONTROLLER_MAX) {
-        return (MN_ERR_DEV_ADDR);
-    }
-
+static void netRunCmdPrep(
+    packetbuf *pTheCmd) {
     // Adjust the frame length to match command length information
     // Initialize the command invariant information
     pTheCmd->Fld.PktType = MN_PKT_TYPE_CMD;
@@ -932,9 +1027,32 @@ MN_EXPORT cnErrCode MN_DECL netRunCommand(
     pTheCmd->Fld.Mode = 0;
     pTheCmd->Fld.Zero1 = 0;
     pTheCmd->Byte.BufferSize = pTheCmd->Fld.PktLen + MN_API_PACKET_HDR_LEN;
+}
+/****************************************************************************/
 
-    // Run the command and check the response for acceptance.
-    if ((theErr = infcRunCommand(cNum, pTheCmd, pTheResp)) == MN_OK)  {
+
+//****************************************************************************
+//  NAME
+//      netRunCmdCheck
+//
+//  DESCRIPTION:
+//      Check the response to <pTheCmd> given the execution outcome <theErr>.
+//      Failures fire the error callback and clear <pTheResp>.
+//
+//  RETURNS:
+//      cnErrCode
+//
+//  SYNOPSIS:
+static cnErrCode netRunCmdCheck(
+    netaddr cNum,               // Controller number
+    packetbuf *pTheCmd,         // command that was run
+    packetbuf *pTheResp,        // its response
+    cnErrCode theErr) {         // execution outcome
+#define RUN_CMD_ERR_DBG (_DEBUG&&1)         // Show err src
+    infcErrInfo errInfo;                    // Error reporting buffer
+
+    // Check the response for acceptance.
+    if (theErr == MN_OK)  {
         // Make sure the packet is consistent with the length
         if (pTheResp->Byte.BufferSize
             && (pTheResp->Fld.PktLen + MN_API_PACKET_HDR_LEN)
@@ -980,6 +1098,109 @@ MN_EXPORT cnErrCode MN_DECL netRunCommand(
         _RPT4(_CRT_WARN, "%.1f netRunCommand(%d): response err 0x%x,"
               "thread=" THREAD_RADIX "\n",
               infcCoreTime(), cNum, errInfo.errCode, infcThreadID());
+    }
+    return (theErr);
+}
+/****************************************************************************/
+
+
+//****************************************************************************
+//  NAME
+//      netRunCommand
+//
+//  DESCRIPTION:
+//      This function will send the specified command on the <cNum>
+//      and wait for the response and stores its response in <pTheResp>.
+//
+//      If <pTheResp> is NULL, this command returns MN_OK if the network
+//      controller accepts the command.
+//
+//  RETURNS:
+//      cnErrCode
+//
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL netRunCommand(
+    netaddr cNum,               // Controller number
+    packetbuf *pTheCmd,     // pointer to filled in command
+    packetbuf *pTheResp) {
+    cnErrCode theErr = MN_OK;
+
+    if (pTheResp == NULL) {
+        return (MN_ERR_BADARG);
+    }
+
+    if (cNum > NET_CONTROLLER_MAX) {
+        return (MN_ERR_DEV_ADDR);
+    }
+
+    netRunCmdPrep(pTheCmd);
+
+    // Run the command and check the response for acceptance.
+    theErr = netRunCmdCheck(cNum, pTheCmd, pTheResp,
+                            infcRunCommand(cNum, pTheCmd, pTheResp));
+    if (theErr != MN_OK) {
+        // Create dump file on this error
+        infcTraceDumpNext(cNum);
+    }
+    return (theErr);
+}
+/****************************************************************************/
+
+
+//****************************************************************************
+//  NAME
+//      netRunCommandBatch
+//
+//  DESCRIPTION:
+//      This function will run the <nCmds> commands in <pTheCmds> on <cNum>
+//      and wait for all of their responses, storing each in the matching
+//      <pTheResps> entry. The commands are sent back to back with as few
+//      writes and command lock acquisitions as the ring's command limit
+//      allows. This suits issuing the same request to every node at once.
+//
+//      Responses of failed commands are cleared as netRunCommand does. The
+//      outcome of each command is stored in <pTheErrs> if it is not NULL.
+//
+//  RETURNS:
+//      MN_OK if all commands succeeded, else the first failure found.
+//
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL netRunCommandBatch(
+    netaddr cNum,               // Controller number
+    packetbuf pTheCmds[],       // filled in commands
+    packetbuf pTheResps[],      // response areas
+    nodeulong nCmds,            // number of commands
+    cnErrCode pTheErrs[]) {     // per command outcome or NULL
+    cnErrCode theErr = MN_OK, cmdErr;
+    cnErrCode *pErrs;
+    nodeulong i;
+
+    if (pTheCmds == NULL || pTheResps == NULL) {
+        return (MN_ERR_BADARG);
+    }
+
+    if (cNum > NET_CONTROLLER_MAX) {
+        return (MN_ERR_DEV_ADDR);
+    }
+
+    for (i = 0; i < nCmds; i++) {
+        netRunCmdPrep(&pTheCmds[i]);
+    }
+
+    pErrs = new cnErrCode[nCmds ? nCmds : 1];
+    infcRunCommandBatch(cNum, pTheCmds, pTheResps, pErrs, nCmds);
+    // Check each response for acceptance.
+    for (i = 0; i < nCmds; i++) {
+        cmdErr = netRunCmdCheck(cNum, &pTheCmds[i], &pTheResps[i], pErrs[i]);
+        if (cmdErr != MN_OK && theErr == MN_OK) {
+            theErr = cmdErr;
+        }
+        if (pTheErrs) {
+            pTheErrs[i] = cmdErr;
+        }
+    }
+    delete[] pErrs;
+    if (theErr != MN_OK) {
         // Create dump file on this error
         infcTraceDumpNext(cNum);
     }
@@ -1618,20 +1839,26 @@ cnErrCode MN_DECL netReset(
 //      MN_OK on success or cnErrCode reason.
 //
 //  SYNOPSIS:
+static void netGetNodeAccessLvlFmt(
+    packetbuf *pCmd,
+    nodeaddr theNode) {
+    // Build the command packet
+    pCmd->Fld.PktLen = 1;
+    pCmd->Fld.Addr = theNode;
+    pCmd->Fld.PktType = MN_PKT_TYPE_CMD;
+    pCmd->Fld.Mode = pCmd->Fld.Zero1 = 0; // Fill in unused with 0
+    pCmd->Fld.Src = MN_SRC_HOST;
+    pCmd->Byte.Buffer[CMD_LOC] = MN_CMD_NET_ACCESS;
+    pCmd->Byte.BufferSize = pCmd->Fld.PktLen + MN_API_PACKET_HDR_LEN;
+}
+
 cnErrCode MN_DECL netGetNodeAccessLvl(
     multiaddr theMultiAddr,                         // Destination node
     mnNetStatus *pAccessLevel) {
     packetbuf theCmd, theResp;
     cnErrCode theErr;
 
-    // Build the command packet
-    theCmd.Fld.PktLen = 1;
-    theCmd.Fld.Addr = NODE_ADDR(theMultiAddr);
-    theCmd.Fld.PktType = MN_PKT_TYPE_CMD;
-    theCmd.Fld.Mode = theCmd.Fld.Zero1 = 0; // Fill in unused with 0
-    theCmd.Fld.Src = MN_SRC_HOST;
-    theCmd.Byte.Buffer[CMD_LOC] = MN_CMD_NET_ACCESS;
-    theCmd.Byte.BufferSize = theCmd.Fld.PktLen + MN_API_PACKET_HDR_LEN;
+    netGetNodeAccessLvlFmt(&theCmd, NODE_ADDR(theMultiAddr));
 
     if ((theErr = infcRunCommand(NET_NUM(theMultiAddr),
                                  &theCmd, &theResp)) == MN_OK) {
@@ -2042,21 +2269,23 @@ cnErrCode coreUpdateParamInfo(
 
 /*****************************************************************************
  *  NAME
- *      netGetParameterInfo
+ *      netGetParameterInfoFrom
  *
  *  DESCRIPTION:
- *      This is a generic parameter read function that gets augmented
- *      parameter information.
+ *      Body of netGetParameterInfo. When <pRead> is given it holds the
+ *      parameter already read from the node and is used in place of a new
+ *      read.
  *
  *  RETURNS:
  *      cnErrCode, MN_OK if successful
  *
  *  SYNOPSIS:                                                               */
-MN_EXPORT cnErrCode MN_DECL netGetParameterInfo(
+static cnErrCode netGetParameterInfoFrom(
     multiaddr theMultiAddr,         // Node address
     nodeparam theParam,             // Parameter number
     paramInfo *pRetValInfo,         // Ptr to returning value info or NULL
-    paramValue *pRetVal) {          // Ptr to returning value or NULL
+    paramValue *pRetVal,            // Ptr to returning value or NULL
+    const packetbuf *pRead) {       // Value read or NULL to read it
     appNodeParam coreParam;         // The core parameter number
     cnErrCode theErr = MN_OK;
     double initialVal;              // Initial value for this parameter
@@ -2122,7 +2351,13 @@ MN_EXPORT cnErrCode MN_DECL netGetParameterInfo(
             || (pFixedInfoDB->info.paramType == PT_NONE)) {
 
             // Read from the node directly, real-time, EEPROM type or first time
-            theErr = netGetParameter(theMultiAddr, theParam, &pValueDB->raw);
+            if (pRead) {
+                pValueDB->raw = *pRead;
+            }
+            else {
+                theErr = netGetParameter(theMultiAddr, theParam,
+                                         &pValueDB->raw);
+            }
             // Kill the command execute bit for all opstates
             // If we got value OK, convert to value
             if (theErr == MN_OK)  {
@@ -2186,7 +2421,12 @@ MN_EXPORT cnErrCode MN_DECL netGetParameterInfo(
         dummyInfo.converter = NULL;
 
         // Get value in real-time from node into local area and return
-        theErr = netGetParameter(theMultiAddr, theParam, &pRetVal->raw);
+        if (pRead) {
+            pRetVal->raw = *pRead;
+        }
+        else {
+            theErr = netGetParameter(theMultiAddr, theParam, &pRetVal->raw);
+        }
         if (theErr == MN_OK)  {
             // Dummy up the size from the received data
             dummyInfo.info.paramSize = pRetVal->raw.Byte.BufferSize;
@@ -2212,6 +2452,294 @@ MN_EXPORT cnErrCode MN_DECL netGetParameterInfo(
 /*                                                               !end!      */
 /****************************************************************************/
 
+
+/*****************************************************************************
+ *  NAME
+ *      netGetParameterInfo
+ *
+ *  DESCRIPTION:
+ *      This is a generic parameter read function that gets augmented
+ *      parameter information.
+ *
+ *  RETURNS:
+ *      cnErrCode, MN_OK if successful
+ *
+ *  SYNOPSIS:                                                               */
+MN_EXPORT cnErrCode MN_DECL netGetParameterInfo(
+    multiaddr theMultiAddr,         // Node address
+    nodeparam theParam,             // Parameter number
+    paramInfo *pRetValInfo,         // Ptr to returning value info or NULL
+    paramValue *pRetVal) {          // Ptr to returning value or NULL
+    return netGetParameterInfoFrom(theMultiAddr, theParam, pRetValInfo,
+                                   pRetVal, NULL);
+}
+/*                                                               !end!      */
+/****************************************************************************/
+
+
+/*****************************************************************************
+ *  NAME
+ *      coreParamPrefill
+ *
+ *  DESCRIPTION:
+ *      Enter <pRaw> into the value database as if it had just been read
+ *      from the node. Entries that already hold a cached value keep it.
+ *
+ *  RETURNS:
+ *      cnErrCode, MN_OK if successful
+ *
+ *  SYNOPSIS:                                                               */
+cnErrCode coreParamPrefill(
+    multiaddr theMultiAddr,         // Node address
+    nodeparam theParam,             // Parameter number
+    const packetbuf *pRaw) {        // Raw value
+    paramValue theVal;
+
+    return netGetParameterInfoFrom(theMultiAddr, theParam, NULL, &theVal,
+                                   pRaw);
+}
+/*                                                               !end!      */
+/****************************************************************************/
+
+
+/*****************************************************************************
+ *  NAME
+ *      coreParamCached
+ *
+ *  DESCRIPTION:
+ *      Test if the value database holds a value of <theParam> that a read
+ *      would return without going to the node, and copy its raw contents
+ *      to <pRaw> if not NULL.
+ *
+ *  RETURNS:
+ *      true if the value is cached
+ *
+ *  SYNOPSIS:                                                               */
+bool coreParamCached(
+    multiaddr theMultiAddr,         // Node address
+    nodeparam theParam,             // Parameter number
+    packetbuf *pRaw) {              // Raw value or NULL
+    appNodeParam coreParam;         // The core parameter number
+    byNodeDB *pNodeInfo;            // Node information
+    paramBank *pParamBank;          // Parameter bank
+    netaddr cNum = coreController(theMultiAddr);
+
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return (false);
+    }
+    pNodeInfo = &SysInventory[cNum].NodeInfo[NODE_ADDR(theMultiAddr)];
+    coreParam.bits = theParam;
+    if (!pNodeInfo->paramBankList || coreParam.fld.option
+        || coreParam.fld.bank >= pNodeInfo->bankCount) {
+        return (false);
+    }
+    pParamBank = &pNodeInfo->paramBankList[coreParam.fld.bank];
+    if (coreParam.fld.param >= pParamBank->nParams) {
+        return (false);
+    }
+    unsigned theType =
+        pParamBank->fixedInfoDB[coreParam.fld.param].info.paramType;
+    const paramValue &theVal = pParamBank->valueDB[coreParam.fld.param];
+    if (theType == PT_NONE || (theType & PT_RT) || !theVal.exists) {
+        return (false);
+    }
+    if (pRaw) {
+        *pRaw = theVal.raw;
+    }
+    return (true);
+}
+/*                                                               !end!      */
+/****************************************************************************/
+
+
+/*****************************************************************************
+ *  NAME
+ *      netGetParameterRawList
+ *
+ *  DESCRIPTION:
+ *      Read the <nParams> parameters of <theParams> from the nodes of
+ *      <theAddrs> on port <cNum> with the reads sent back to back, so the
+ *      nodes sample them within one pass of the ring and the wait is close
+ *      to a single round trip. The raw contents are returned in <theBufs>
+ *      as netGetParameter does, without the parameter database, so this
+ *      works before a node's class is set up. The outcome of each read is
+ *      stored in <theErrs>.
+ *
+ *  RETURNS:
+ *      cnErrCode, MN_OK if every parameter was read, else the first failure
+ *
+ *  SYNOPSIS:                                                               */
+cnErrCode MN_DECL netGetParameterRawList(
+    netaddr cNum,                   // Port
+    nodeulong nParams,              // Number of parameters
+    const multiaddr theAddrs[],     // Node addresses
+    const nodeparam theParams[],    // Parameter numbers
+    packetbuf theBufs[],            // Returned contents
+    cnErrCode theErrs[]) {          // Per parameter outcome
+    packetbuf *pCmds, *pResps;
+    cnErrCode theErr = MN_OK;
+    nodeulong i;
+
+    if (nParams == 0) {
+        return (MN_OK);
+    }
+    if (!theAddrs || !theParams || !theBufs || !theErrs) {
+        return (MN_ERR_BADARG);
+    }
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return (MN_ERR_DEV_ADDR);
+    }
+
+    pCmds = new packetbuf[nParams];
+    pResps = new packetbuf[nParams];
+    for (i = 0; i < nParams && theErr == MN_OK; i++) {
+        theErr = netGetParameterFmt(&pCmds[i], NODE_ADDR(theAddrs[i]),
+                                    theParams[i]);
+    }
+    if (theErr == MN_OK) {
+        netRunCommandBatch(cNum, pCmds, pResps, nParams, theErrs);
+    }
+    for (i = 0; i < nParams; i++) {
+        // Nothing was sent if a command could not be formatted
+        if (theErr != MN_OK) {
+            theErrs[i] = theErr;
+        }
+        else if (theErrs[i] == MN_OK) {
+            theErrs[i] = netGetParameterExtract(&pResps[i], &theBufs[i]);
+        }
+        if (theErrs[i] != MN_OK) {
+            theBufs[i].Fld.PktLen = 0;
+            theBufs[i].Byte.BufferSize = 0;
+        }
+    }
+    for (i = 0; i < nParams && theErr == MN_OK; i++) {
+        theErr = theErrs[i];
+    }
+    delete[] pCmds;
+    delete[] pResps;
+    return (theErr);
+}
+/*                                                               !end!      */
+/****************************************************************************/
+
+
+/*****************************************************************************
+ *  NAME
+ *      netGetParameterList
+ *
+ *  DESCRIPTION:
+ *      Read parameters of any nodes on port <cNum> back to back as
+ *      netGetParameterRawList does. Each value read is then converted and
+ *      cached as netGetParameterInfo does and its outcome stored in
+ *      <theErrs>.
+ *
+ *  RETURNS:
+ *      cnErrCode, MN_OK if every parameter was read, else the first failure
+ *
+ *  SYNOPSIS:                                                               */
+MN_EXPORT cnErrCode MN_DECL netGetParameterList(
+    netaddr cNum,                   // Port
+    nodeulong nParams,              // Number of parameters
+    const multiaddr theAddrs[],     // Node addresses
+    const nodeparam theParams[],    // Parameter numbers
+    paramValue theRetVals[],        // Returned values
+    cnErrCode theErrs[]) {          // Per parameter outcome
+    packetbuf *pReads;
+    cnErrCode theErr = MN_OK;
+    nodeulong i;
+
+    if (nParams == 0) {
+        return (MN_OK);
+    }
+    if (!theAddrs || !theParams || !theRetVals || !theErrs) {
+        return (MN_ERR_BADARG);
+    }
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return (MN_ERR_DEV_ADDR);
+    }
+
+    pReads = new packetbuf[nParams];
+    netGetParameterRawList(cNum, nParams, theAddrs, theParams, pReads,
+                           theErrs);
+    for (i = 0; i < nParams; i++) {
+        if (theErrs[i] == MN_OK) {
+            theErrs[i] = netGetParameterInfoFrom(theAddrs[i], theParams[i],
+                                                 NULL, &theRetVals[i],
+                                                 &pReads[i]);
+        }
+        if (theErrs[i] != MN_OK && theErr == MN_OK) {
+            theErr = theErrs[i];
+        }
+    }
+    delete[] pReads;
+    return (theErr);
+}
+/*                                                               !end!      */
+/****************************************************************************/
+
+
+/*****************************************************************************
+ *  NAME
+ *      netGetParameterSet
+ *
+ *  DESCRIPTION:
+ *      Read the <nParams> parameters of <theParams> from one node with the
+ *      reads sent back to back, as netGetParameterList does. The set is
+ *      taken as a whole: every response is checked before any value is
+ *      converted, so a failed read leaves the parameter database and the
+ *      change callbacks untouched.
+ *
+ *  RETURNS:
+ *      cnErrCode, MN_OK if every parameter was read, else the first failure
+ *
+ *  SYNOPSIS:                                                               */
+MN_EXPORT cnErrCode MN_DECL netGetParameterSet(
+    multiaddr theMultiAddr,         // Node address
+    nodeulong nParams,              // Number of parameters
+    const nodeparam theParams[],    // Parameter numbers
+    paramValue theRetVals[]) {      // Returned values
+    netaddr cNum = coreController(theMultiAddr);
+    cnErrCode theErr = MN_OK;
+    appNodeParam coreParam;
+    byNodeDB *pNodeInfo;
+    nodeulong i;
+
+    if (nParams == 0) {
+        return (MN_OK);
+    }
+    if (!theParams || !theRetVals) {
+        return (MN_ERR_BADARG);
+    }
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return (MN_ERR_DEV_ADDR);
+    }
+    // Refuse up front what netGetParameterInfoFrom would refuse part way
+    pNodeInfo = &SysInventory[cNum].NodeInfo[NODE_ADDR(theMultiAddr)];
+    if (pNodeInfo->paramBankList == NULL) {
+        return (MN_ERR_PARAM_NOT_INIT);
+    }
+    for (i = 0; i < nParams; i++) {
+        coreParam.bits = theParams[i];
+        if (coreParam.fld.bank >= pNodeInfo->bankCount) {
+            return (MN_ERR_PARAM_RANGE);
+        }
+    }
+
+    std::vector<multiaddr> addrs(nParams, theMultiAddr);
+    std::vector<cnErrCode> errs(nParams);
+    std::vector<packetbuf> reads(nParams);
+    theErr = netGetParameterRawList(cNum, nParams, &addrs[0], theParams,
+                                    &reads[0], &errs[0]);
+    // Convert and commit only once every read is in
+    for (i = 0; i < nParams && theErr == MN_OK; i++) {
+        theErr = netGetParameterInfoFrom(theMultiAddr, theParams[i], NULL,
+                                         &theRetVals[i], &reads[i]);
+    }
+    return (theErr);
+}
+/*                                                               !end!      */
+/****************************************************************************/
+
 
 /*****************************************************************************
  *  NAME
@@ -3257,6 +3785,114 @@ MN_EXPORT cnErrCode MN_DECL netAlertLogEpoch(
 //                                                                            *
 //*****************************************************************************
 
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netGetParameterRun / paramFlightJoinable / paramFlightRelease
+//
+//  DESCRIPTION:
+//      Parameter read on the wire, and the helpers that let identical
+//      reads in flight share one. Clear-on-read and unknown parameters are
+//      never shared, each reader must see its own read of those.
+//
+//  SYNOPSIS:
+static cnErrCode netGetParameterRun(
+    multiaddr theMultiAddr,
+    nodeparam theParamNum,
+    packetbuf *pParamBuf) {
+    packetbuf cmd, resp;            // Input and output buffers
+    cnErrCode theErr;
+    netaddr cNum;
+
+    cNum = coreController(theMultiAddr);
+
+    if ((theErr = netGetParameterFmt(&cmd, NODE_ADDR(theMultiAddr),
+                                     theParamNum)) == MN_OK)  {
+        if ((theErr = netRunCommand(cNum, &cmd, &resp)) == MN_OK)  {
+            theErr = netGetParameterExtract(&resp, pParamBuf);
+        }
+        else {
+            pParamBuf->Fld.PktLen = 0;
+            pParamBuf->Byte.BufferSize = 0;
+        }
+    }
+#if _DEBUG
+    if (theErr != MN_OK) {
+        _RPT3(_CRT_WARN,
+              "netGetParameter(multiaddr=%d,param=%d failed: 0x%X\n",
+              theMultiAddr, theParamNum, theErr);
+        DUMP_PKT(cNum, "...the cmd", &cmd);
+    }
+#endif
+    return theErr;
+}
+
+static bool paramFlightJoinable(
+    multiaddr theMultiAddr,
+    nodeparam theParamNum) {
+    mnNetInvRecords &theNet = SysInventory[coreController(theMultiAddr)];
+    byNodeDB &nodeInfo = theNet.NodeInfo[NODE_ADDR(theMultiAddr)];
+    appNodeParam coreParam;
+
+    // The read thread must never wait on a read it has to complete
+    if (!theNet.pNCS || theNet.pNCS->isReadThread()) {
+        return false;
+    }
+    coreParam.bits = theParamNum;
+    if (nodeInfo.paramBankList == NULL
+            || coreParam.fld.bank >= nodeInfo.bankCount) {
+        return false;
+    }
+    paramBank &bank = nodeInfo.paramBankList[coreParam.fld.bank];
+    if (coreParam.fld.param >= bank.nParams) {
+        return false;
+    }
+    return (bank.fixedInfoDB[coreParam.fld.param].info.paramType
+            & PT_CLR) == 0;
+}
+
+static void paramFlightRelease(
+    mnNetInvRecords &theNet,
+    paramFlight *pFlight) {
+    bool last;
+
+    theNet.paramFlightLock.Lock();
+    last = --pFlight->refs == 0;
+    theNet.paramFlightLock.Unlock();
+    if (last) {
+        delete pFlight;
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      cmdClassScope
+//
+//  DESCRIPTION:
+//      Send the commands of the enclosing function in a less urgent class,
+//      putting the thread's class back on the way out. A thread already in
+//      a less urgent class keeps it.
+//
+//  SYNOPSIS:
+class cmdClassScope {
+    cmdClasses m_prev;
+public:
+    cmdClassScope(cmdClasses cls) {
+        m_prev = infcCmdClassSet(cls);
+        if (m_prev > cls) {
+            infcCmdClassSet(m_prev);
+        }
+    }
+    ~cmdClassScope() {
+        infcCmdClassSet(m_prev);
+    }
+};
+//                                                                             *
+//******************************************************************************
+
 /// \endcond
 
 // =============================================================================
@@ -3285,6 +3921,13 @@ MN_EXPORT cnErrCode MN_DECL netAlertLogEpoch(
 
     \return MN_OK if the parameter was retrieved and the \p pParamBuf
 
+    A thread asking for a parameter that another thread is already reading
+    from the same node waits for that read and gets its result, so many
+    threads polling one value do not multiply the ring traffic. A read is
+    only shared until another command, such as a parameter write, is sent
+    to the node, so a read that follows a write sees its effect.
+    Clear-on-read parameters are always read separately.
+
     \see mnSysInventoryRecord function
     \see MULTI_ADDR macro
 **/
@@ -3295,30 +3938,52 @@ MN_EXPORT cnErrCode MN_DECL netGetParameter(
     packetbuf *pParamBuf)       // ptr for returned param
 
 {
-    packetbuf cmd, resp;            // Input and output buffers
+    paramFlight *pFlight;
     cnErrCode theErr;
-    netaddr cNum;
 
-    cNum = coreController(theMultiAddr);
+    if (!paramFlightJoinable(theMultiAddr, theParamNum)) {
+        return netGetParameterRun(theMultiAddr, theParamNum, pParamBuf);
+    }
+    mnNetInvRecords &theNet = SysInventory[coreController(theMultiAddr)];
 
-    if ((theErr = netGetParameterFmt(&cmd, NODE_ADDR(theMultiAddr),
-                                     theParamNum)) == MN_OK)  {
-        if ((theErr = netRunCommand(cNum, &cmd, &resp)) == MN_OK)  {
-            theErr = netGetParameterExtract(&resp, pParamBuf);
-        }
-        else {
-            pParamBuf->Fld.PktLen = 0;
-            pParamBuf->Byte.BufferSize = 0;
+    // Join an identical read already on the wire
+    theNet.paramFlightLock.Lock();
+    for (pFlight = theNet.pParamFlights; pFlight; pFlight = pFlight->next) {
+        if (pFlight->addr == theMultiAddr && pFlight->param == theParamNum) {
+            break;
         }
     }
-#if _DEBUG
-    if (theErr != MN_OK) {
-        _RPT3(_CRT_WARN,
-              "netGetParameter(multiaddr=%d,param=%d failed: 0x%X\n",
-              theMultiAddr, theParamNum, theErr);
-        DUMP_PKT(cNum, "...the cmd", &cmd);
+    if (pFlight) {
+        pFlight->refs++;
+        theNet.paramFlightLock.Unlock();
+        pFlight->done.WaitFor();
+        theErr = pFlight->result;
+        *pParamBuf = pFlight->value;
+        paramFlightRelease(theNet, pFlight);
+        return theErr;
     }
-#endif
+    // Lead a new one
+    pFlight = new paramFlight(theMultiAddr, theParamNum);
+    pFlight->next = theNet.pParamFlights;
+    theNet.pParamFlights = pFlight;
+    theNet.paramFlightLock.Unlock();
+
+    theErr = netGetParameterRun(theMultiAddr, theParamNum, pParamBuf);
+
+    // Late arrivals start their own read from here on
+    theNet.paramFlightLock.Lock();
+    for (paramFlight **ppLink = &theNet.pParamFlights; *ppLink;
+            ppLink = &(*ppLink)->next) {
+        if (*ppLink == pFlight) {
+            *ppLink = pFlight->next;
+            break;
+        }
+    }
+    theNet.paramFlightLock.Unlock();
+    pFlight->result = theErr;
+    pFlight->value = *pParamBuf;
+    pFlight->done.SetEvent();
+    paramFlightRelease(theNet, pFlight);
     return theErr;
 }
 //                                                                             *
@@ -3996,6 +4661,7 @@ MN_EXPORT cnErrCode MN_DECL netGetDataCollected(
     nodeaddr addr;
     cnErrCode theErr = MN_OK;
     paramValue sampleTimeMicroseconds;
+    cmdClassScope bulk(CMD_CLASS_BULK);
 
 
     if (!pReturnData) {
@@ -5157,6 +5823,8 @@ MN_EXPORT cnErrCode MN_DECL netConfigLoad(
     // multi-address is OK.
     netaddr cNum = NET_NUM(theMultiAddr);
     nodeaddr theNode = NODE_ADDR(theMultiAddr);
+    // Stay out of the way of the application's commands
+    cmdClassScope bulk(CMD_CLASS_BULK);
 
     // TODO: add other formats
     if (loadFmt != CLASSIC && loadFmt != CLASSIC_NO_RESET) {
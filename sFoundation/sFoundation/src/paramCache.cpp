@@ -0,0 +1,572 @@
+//******************************************************************************
+// $Workfile: paramCache.cpp $
+//
+// DESCRIPTION:
+/**
+    \file
+    \brief Persistent parameter cache for warm starts
+
+    The read only values of each node, its identity and capabilities, are
+    kept in a file keyed by the node's serial number, firmware version and
+    device ID. When a node with the same key is found again its value
+    database is filled from the file instead of being read back one
+    parameter at a time. Settings are never kept, another program may have
+    written them since the file was saved.
+
+    The file is a header followed by fixed size node and value records with
+    offsets instead of pointers, so it can be read in one piece or mapped.
+**/
+// CREATION DATE:
+//  10/16/2026
+//
+// COPYRIGHT NOTICE:
+//  (C)Copyright 2026  Teknic, Inc.  All rights reserved.
+//
+//  This copyright notice must be reproduced in any copy, modification,
+//  or portion thereof merged into another program. A copy of the
+//  copyright notice must be included in the object library of a user
+//  program.
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  paramCache.cpp headers
+//
+// Our driver headers
+#include "lnkAccessCommon.h"
+#include "netCmdAPI.h"
+#include "netCmdPrivate.h"
+#include "mnErrors.h"
+
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  paramCache.cpp constants
+//
+// File signature "SFPC" and layout version
+#define PCACHE_MAGIC            0x43504653
+#define PCACHE_VERSION          2
+// Largest raw value kept
+#define PCACHE_RAW_MAX          28
+// Most nodes remembered, the least recently seen are dropped
+#define PCACHE_NODES_MAX        256
+// Most values of a node, every parameter of every bank
+#define PCACHE_NODE_VALUES_MAX  (4 * 128)
+// Parameter types never cached: changing, clear on read or lost at reset.
+// Only PT_RO values are kept, anything the host can write is read again.
+#define PCACHE_TYPE_SKIP        (PT_RT | PT_CLR | PT_VOL | PT_RAM)
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  paramCache.cpp file records
+//
+#if defined(_MSC_VER)||defined(__GNUC__)
+#pragma pack(push, 1)
+#endif
+typedef struct _pcacheHdr {
+    Uint32 magic;                       // PCACHE_MAGIC
+    Uint32 version;                     // PCACHE_VERSION
+    Uint32 nNodes;                      // Node records following
+    Uint32 nValues;                     // Value records after the nodes
+} pcacheHdr;
+
+typedef struct _pcacheKey {
+    Uint32 serNum;                      // MN_P_SER_NUM
+    Uint16 devCode;                     // MN_P_NODEID
+    Uint16 fwVers;                      // MN_P_FW_VERSION
+} pcacheKey;
+
+typedef struct _pcacheNode {
+    pcacheKey key;                      // Node identity
+    Uint32 firstValue;                  // Index of its first value record
+    Uint32 nValues;                     // Number of value records
+} pcacheNode;
+
+typedef struct _pcacheValue {
+    Uint16 param;                       // Parameter number
+    Uint16 size;                        // Bytes in raw
+    nodechar raw[PCACHE_RAW_MAX];       // Raw value
+} pcacheValue;
+#if defined(_MSC_VER)||defined(__GNUC__)
+#pragma pack(pop)
+#endif
+
+// A node and its values while in memory
+typedef struct _pcacheRecord {
+    pcacheKey key;
+    std::vector<pcacheValue> values;
+} pcacheRecord;
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  paramCache.cpp imported references
+//
+extern mnNetInvRecords SysInventory[NET_CONTROLLER_MAX];
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  paramCache.cpp static variables
+//
+// Serializes the records and the file
+static CCCriticalSection pcacheLock;
+// File path, empty when caching is off
+static std::string pcachePath;
+// Records, least recently seen first
+static std::vector<pcacheRecord> pcacheRecords;
+// Records changed since the file was written
+static bool pcacheDirty = false;
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      pcacheKeyFrom
+//
+//  DESCRIPTION:
+/**
+    Build a key from the raw node ID, firmware version and serial number.
+**/
+//  SYNOPSIS:
+static pcacheKey pcacheKeyFrom(const packetbuf &id, const packetbuf &fw,
+                               const packetbuf &ser) {
+    pcacheKey key;
+
+    memset(&key, 0, sizeof(key));
+    memcpy(&key.devCode, id.Byte.Buffer,
+           id.Byte.BufferSize < sizeof(key.devCode)
+           ? id.Byte.BufferSize : sizeof(key.devCode));
+    memcpy(&key.fwVers, fw.Byte.Buffer,
+           fw.Byte.BufferSize < sizeof(key.fwVers)
+           ? fw.Byte.BufferSize : sizeof(key.fwVers));
+    memcpy(&key.serNum, ser.Byte.Buffer,
+           ser.Byte.BufferSize < sizeof(key.serNum)
+           ? ser.Byte.BufferSize : sizeof(key.serNum));
+    return key;
+}
+
+static bool pcacheKeyEqual(const pcacheKey &a, const pcacheKey &b) {
+    return a.serNum == b.serNum && a.devCode == b.devCode
+           && a.fwVers == b.fwVers;
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      pcacheFind
+//
+//  DESCRIPTION:
+/**
+    Index of the record for \a key or -1. Must hold pcacheLock.
+**/
+//  SYNOPSIS:
+static int pcacheFind(const pcacheKey &key) {
+    for (size_t i = 0; i < pcacheRecords.size(); i++) {
+        if (pcacheKeyEqual(pcacheRecords[i].key, key)) {
+            return int(i);
+        }
+    }
+    return -1;
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      pcacheLoad
+//
+//  DESCRIPTION:
+/**
+    Replace the records with the contents of \a path. A missing, damaged or
+    older file leaves no records. The counts in the header are checked
+    against the file size before anything is allocated from them. Must hold
+    pcacheLock.
+**/
+//  SYNOPSIS:
+static void pcacheLoad(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    pcacheHdr hdr;
+    long fileSize;
+    std::vector<pcacheNode> nodes;
+    std::vector<pcacheValue> values;
+
+    pcacheRecords.clear();
+    if (!fp) {
+        return;
+    }
+    if (fseek(fp, 0, SEEK_END) != 0 || (fileSize = ftell(fp)) < 0
+            || fseek(fp, 0, SEEK_SET) != 0) {
+        fclose(fp);
+        return;
+    }
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1
+            || hdr.magic != PCACHE_MAGIC || hdr.version != PCACHE_VERSION
+            || hdr.nNodes > PCACHE_NODES_MAX
+            || hdr.nValues > Uint64(hdr.nNodes) * PCACHE_NODE_VALUES_MAX
+            || Uint64(fileSize) != sizeof(hdr)
+                                   + Uint64(hdr.nNodes) * sizeof(pcacheNode)
+                                   + Uint64(hdr.nValues) * sizeof(pcacheValue)) {
+        fclose(fp);
+        return;
+    }
+    nodes.resize(hdr.nNodes);
+    values.resize(hdr.nValues);
+    if ((hdr.nNodes
+            && fread(&nodes[0], sizeof(pcacheNode), hdr.nNodes, fp)
+               != hdr.nNodes)
+            || (hdr.nValues
+                && fread(&values[0], sizeof(pcacheValue), hdr.nValues, fp)
+                   != hdr.nValues)) {
+        fclose(fp);
+        return;
+    }
+    fclose(fp);
+    for (size_t i = 0; i < values.size(); i++) {
+        if (values[i].size > PCACHE_RAW_MAX) {
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const pcacheNode &node = nodes[i];
+        if (node.firstValue > hdr.nValues
+                || node.nValues > hdr.nValues - node.firstValue
+                || node.nValues > PCACHE_NODE_VALUES_MAX) {
+            pcacheRecords.clear();
+            return;
+        }
+        pcacheRecord rec;
+        rec.key = node.key;
+        rec.values.assign(values.begin() + node.firstValue,
+                          values.begin() + node.firstValue + node.nValues);
+        pcacheRecords.push_back(rec);
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      netParamCacheFile
+//
+//  DESCRIPTION:
+/**
+    Use \a pPath as the parameter cache file and load what it holds. The
+    file is written as nodes are closed and after enumerations that found
+    nodes not in it.
+
+    \param[in] pPath Cache file path, NULL or empty to stop caching.
+    \return #cnErrCode; MN_OK
+**/
+//  SYNOPSIS:
+MN_EXPORT cnErrCode MN_DECL netParamCacheFile(
+    const char *pPath) {
+    pcacheLock.Lock();
+    pcachePath = pPath ? pPath : "";
+    pcacheDirty = false;
+    if (pcachePath.empty()) {
+        pcacheRecords.clear();
+    }
+    else {
+        pcacheLoad(pcachePath.c_str());
+    }
+    pcacheLock.Unlock();
+    return (MN_OK);
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      coreParamCacheApply
+//
+//  DESCRIPTION:
+/**
+    Check the identity of each node in \a theNodes with reads sent back to
+    back, then fill the value database of those found in the cache. Identity
+    values the database already holds are not read again. The identity
+    reads are entered for every node, so they are not read later and a node
+    new to the cache can be captured.
+
+    \param[in] cNum Port of the nodes.
+    \param[in] nNodes Number of nodes in \a theNodes.
+    \param[in] theNodes Node addresses, their class databases set up.
+    \param[out] theHits Set for the nodes that were prefilled.
+**/
+//  SYNOPSIS:
+void coreParamCacheApply(
+    netaddr cNum,
+    nodeulong nNodes,
+    const nodeaddr theNodes[],
+    bool theHits[]) {
+    static const nodeparam idParams[] = {
+        MN_P_NODEID, MN_P_FW_VERSION, MN_P_SER_NUM
+    };
+    const nodeulong idCnt = sizeof(idParams) / sizeof(idParams[0]);
+    std::vector<packetbuf> ids(nNodes * idCnt);
+    std::vector<cnErrCode> idErrs(nNodes * idCnt, MN_OK);
+    std::vector<multiaddr> addrs;
+    std::vector<nodeparam> params;
+    std::vector<nodeulong> readAt;
+    std::vector<packetbuf> bufs;
+    std::vector<cnErrCode> errs;
+    std::vector<pcacheValue> values;
+    nodeulong i, j;
+    packetbuf raw;
+
+    for (i = 0; i < nNodes; i++) {
+        theHits[i] = false;
+    }
+    pcacheLock.Lock();
+    bool enabled = !pcachePath.empty();
+    pcacheLock.Unlock();
+    if (!enabled || !nNodes) {
+        return;
+    }
+
+    for (i = 0; i < nNodes; i++) {
+        for (j = 0; j < idCnt; j++) {
+            multiaddr theAddr = MULTI_ADDR(cNum, theNodes[i]);
+            if (coreParamCached(theAddr, idParams[j], &ids[i * idCnt + j])) {
+                continue;
+            }
+            addrs.push_back(theAddr);
+            params.push_back(idParams[j]);
+            readAt.push_back(i * idCnt + j);
+        }
+    }
+    if (!addrs.empty()) {
+        bufs.resize(addrs.size());
+        errs.resize(addrs.size());
+        netGetParameterRawList(cNum, nodeulong(addrs.size()), &addrs[0],
+                               &params[0], &bufs[0], &errs[0]);
+        for (j = 0; j < addrs.size(); j++) {
+            ids[readAt[j]] = bufs[j];
+            idErrs[readAt[j]] = errs[j];
+            if (errs[j] == MN_OK) {
+                coreParamPrefill(addrs[j], params[j], &bufs[j]);
+            }
+        }
+    }
+
+    for (i = 0; i < nNodes; i++) {
+        const nodeulong at = i * idCnt;
+        if (idErrs[at] != MN_OK || idErrs[at + 1] != MN_OK
+                || idErrs[at + 2] != MN_OK) {
+            continue;
+        }
+        pcacheKey key = pcacheKeyFrom(ids[at], ids[at + 1], ids[at + 2]);
+        // Copy the values out so the prefill runs without the lock
+        pcacheLock.Lock();
+        int found = pcacheFind(key);
+        if (found >= 0) {
+            values = pcacheRecords[found].values;
+        }
+        pcacheLock.Unlock();
+        if (found < 0) {
+            continue;
+        }
+        for (j = 0; j < values.size(); j++) {
+            raw.Byte.BufferSize = values[j].size;
+            memcpy(raw.Byte.Buffer, values[j].raw, values[j].size);
+            coreParamPrefill(MULTI_ADDR(cNum, theNodes[i]), values[j].param,
+                             &raw);
+        }
+        theHits[i] = true;
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      coreParamCacheCapture
+//
+//  DESCRIPTION:
+/**
+    Record the read only values the node's database holds, replacing the
+    node's earlier record. Nodes whose identity was never read are skipped.
+
+    \param[in] theMultiAddr Node whose database is about to be freed.
+**/
+//  SYNOPSIS:
+void coreParamCacheCapture(
+    multiaddr theMultiAddr) {
+    netaddr cNum = coreController(theMultiAddr);
+    byNodeDB *pNodeDB;
+    pcacheRecord rec;
+    pcacheValue val;
+    appNodeParam coreParam;
+    unsigned bank, pNum;
+
+    if (cNum >= NET_CONTROLLER_MAX) {
+        return;
+    }
+    pNodeDB = &SysInventory[cNum].NodeInfo[NODE_ADDR(theMultiAddr)];
+    if (!pNodeDB->paramBankList || !pNodeDB->bankCount) {
+        return;
+    }
+    pcacheLock.Lock();
+    if (pcachePath.empty()) {
+        pcacheLock.Unlock();
+        return;
+    }
+    pcacheLock.Unlock();
+
+    // The key comes from the node's own cached identity
+    const paramBank &bank0 = pNodeDB->paramBankList[0];
+    if (bank0.nParams <= MN_P_SER_NUM
+            || !bank0.valueDB[MN_P_NODEID].exists
+            || !bank0.valueDB[MN_P_FW_VERSION].exists
+            || !bank0.valueDB[MN_P_SER_NUM].exists) {
+        return;
+    }
+    rec.key = pcacheKeyFrom(bank0.valueDB[MN_P_NODEID].raw,
+                            bank0.valueDB[MN_P_FW_VERSION].raw,
+                            bank0.valueDB[MN_P_SER_NUM].raw);
+
+    for (bank = 0; bank < pNodeDB->bankCount; bank++) {
+        const paramBank &theBank = pNodeDB->paramBankList[bank];
+        for (pNum = 0; pNum < theBank.nParams; pNum++) {
+            const paramValue &theVal = theBank.valueDB[pNum];
+            unsigned theType = theBank.fixedInfoDB[pNum].info.paramType;
+            if (!(theType & PT_RO) || (theType & PCACHE_TYPE_SKIP)
+                    || !theVal.exists
+                    || theVal.raw.Byte.BufferSize > PCACHE_RAW_MAX) {
+                continue;
+            }
+            coreParam.bits = 0;
+            coreParam.fld.bank = bank;
+            coreParam.fld.param = pNum;
+            memset(&val, 0, sizeof(val));
+            val.param = Uint16(coreParam.bits);
+            val.size = Uint16(theVal.raw.Byte.BufferSize);
+            memcpy(val.raw, theVal.raw.Byte.Buffer, val.size);
+            rec.values.push_back(val);
+        }
+    }
+
+    pcacheLock.Lock();
+    int found = pcacheFind(rec.key);
+    if (found >= 0) {
+        pcacheRecords.erase(pcacheRecords.begin() + found);
+    }
+    else if (pcacheRecords.size() >= PCACHE_NODES_MAX) {
+        pcacheRecords.erase(pcacheRecords.begin());
+    }
+    // Most recently seen go last
+    pcacheRecords.push_back(rec);
+    pcacheDirty = true;
+    pcacheLock.Unlock();
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      coreParamCacheFlush
+//
+//  DESCRIPTION:
+/**
+    Write the records to the cache file if they changed. The file is
+    written under a temporary name and renamed, so a reader never sees it
+    half written.
+**/
+//  SYNOPSIS:
+void coreParamCacheFlush() {
+    pcacheHdr hdr;
+    pcacheNode node;
+    std::string tmpPath;
+    FILE *fp;
+    bool ok;
+
+    pcacheLock.Lock();
+    if (pcachePath.empty() || !pcacheDirty) {
+        pcacheLock.Unlock();
+        return;
+    }
+    tmpPath = pcachePath + ".tmp";
+    fp = fopen(tmpPath.c_str(), "wb");
+    if (!fp) {
+        pcacheLock.Unlock();
+        return;
+    }
+    hdr.magic = PCACHE_MAGIC;
+    hdr.version = PCACHE_VERSION;
+    hdr.nNodes = Uint32(pcacheRecords.size());
+    hdr.nValues = 0;
+    for (size_t i = 0; i < pcacheRecords.size(); i++) {
+        hdr.nValues += Uint32(pcacheRecords[i].values.size());
+    }
+    ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1;
+    node.firstValue = 0;
+    for (size_t i = 0; ok && i < pcacheRecords.size(); i++) {
+        node.key = pcacheRecords[i].key;
+        node.nValues = Uint32(pcacheRecords[i].values.size());
+        ok = fwrite(&node, sizeof(node), 1, fp) == 1;
+        node.firstValue += node.nValues;
+    }
+    for (size_t i = 0; ok && i < pcacheRecords.size(); i++) {
+        const std::vector<pcacheValue> &values = pcacheRecords[i].values;
+        ok = values.empty()
+             || fwrite(&values[0], sizeof(pcacheValue), values.size(), fp)
+                == values.size();
+    }
+    ok = fclose(fp) == 0 && ok;
+#if (defined(_WIN32)||defined(_WIN64))
+    // Windows will not rename over an existing file
+    if (ok) {
+        remove(pcachePath.c_str());
+    }
+#endif
+    if (ok && rename(tmpPath.c_str(), pcachePath.c_str()) == 0) {
+        pcacheDirty = false;
+    }
+    else {
+        remove(tmpPath.c_str());
+    }
+    pcacheLock.Unlock();
+}
+//                                                                             *
+//******************************************************************************
+
+//==============================================================================
+//  END OF FILE paramCache.cpp
+//==============================================================================
@@ -42,6 +42,9 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <math.h>
+#if !(defined(_WIN32)||defined(_WIN64))
+#include <sys/mman.h>
+#endif
 
 // Disable windows warning about 'this' in constructor.
 #ifdef _MSC_VER
@@ -455,6 +458,13 @@ Open port(s) specified by the earlier setup SysManager::PortSetup
 //  SYNOPSIS:
 
 void SysManager::PortsOpen(int portCount) {
+#if !(defined(_WIN32)||defined(_WIN64))
+    // Keep the pages resident before the threads start
+    if (m_memLockAtOpen && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        _RPT1(_CRT_WARN, "PortsOpen: mlockall failed err=%d, continuing "
+              "without locked memory\n", errno);
+    }
+#endif
     cnErrCode theErr = mnInitializeSystem(false, portCount, m_ports);
     if (theErr != MN_OK) {
         mnErr eInfo;
@@ -469,6 +479,140 @@ void SysManager::PortsOpen(int portCount) {
 //*****************************************************************************
 
 
+//*****************************************************************************
+//  NAME                                                                      *
+//      SysManager::ThreadRealtime
+//
+//  DESCRIPTION:
+/**
+    Set the scheduling used by the library threads of a role.
+
+    \param[in] role Threads to configure.
+    \param[in] spec Policy, real-time priority and CPU mask.
+**/
+//  SYNOPSIS:
+void SysManager::ThreadRealtime(threadRoles role, const threadRtSpec &spec) {
+    threadSchedSpec sched;
+    sched.policy = spec.Policy;
+    sched.priority = spec.Priority;
+    sched.cpuMask = spec.CpuMask;
+    if (role >= THREAD_ROLE_CNT || !CThread::SetRoleSched(role, sched)) {
+        mnErr eInfo;
+        fillInErrs(eInfo, MN_ERR_BADARG, _TEK_FUNC_SIG_,
+                   "Invalid scheduling for thread role %d", role);
+        throwSystemError(eInfo);
+    }
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//*****************************************************************************
+//  NAME                                                                      *
+//      SysManager::MemoryLockAtOpen
+//
+//  DESCRIPTION:
+/**
+    Select locking the process memory at PortsOpen.
+
+    \param[in] lockAtOpen True to lock current and future pages.
+**/
+//  SYNOPSIS:
+void SysManager::MemoryLockAtOpen(bool lockAtOpen) {
+    m_memLockAtOpen = lockAtOpen;
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//*****************************************************************************
+//  NAME                                                                      *
+//      SysManager::ResponseTimeouts
+//
+//  DESCRIPTION:
+/**
+    Set the adaptive response time-out floor and the fixed time-out.
+
+    \param[in] floorMs Shortest adaptive time-out, 0 to disable adapting.
+    \param[in] ceilingMs Fixed time-out.
+**/
+//  SYNOPSIS:
+void SysManager::ResponseTimeouts(size_t floorMs, size_t ceilingMs) {
+    cnErrCode theErr = infcSetRespTimeouts(nodeulong(floorMs),
+                                           nodeulong(ceilingMs));
+    if (theErr != MN_OK) {
+        mnErr eInfo;
+        fillInErrs(eInfo, theErr, _TEK_FUNC_SIG_,
+                   "Invalid response time-outs %d..%d ms", floorMs,
+                   ceilingMs);
+        throwSystemError(eInfo);
+    }
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//*****************************************************************************
+//  NAME                                                                      *
+//      SysManager::CommandClass
+//
+//  DESCRIPTION:
+/**
+    Set the scheduling class of the commands sent by the calling thread.
+
+    \param[in] newClass Class for the thread's commands.
+    \return The previous class of the thread.
+**/
+//  SYNOPSIS:
+cmdClasses SysManager::CommandClass(cmdClasses newClass) {
+    if (unsigned(newClass) >= CMD_CLASS_CNT) {
+        mnErr eInfo;
+        fillInErrs(eInfo, MN_ERR_BADARG, _TEK_FUNC_SIG_,
+                   "Invalid command class %d", newClass);
+        throwSystemError(eInfo);
+    }
+    return infcCmdClassSet(newClass);
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//*****************************************************************************
+//  NAME                                                                      *
+//      SysManager::ParameterCacheFile
+//
+//  DESCRIPTION:
+/**
+    Set the file that keeps node parameters between starts.
+
+    \param[in] path Cache file path, NULL or empty to stop caching.
+**/
+//  SYNOPSIS:
+void SysManager::ParameterCacheFile(const char *path) {
+    netParamCacheFile(path);
+}
+//                                                                            *
+//*****************************************************************************
+
+
+//*****************************************************************************
+//  NAME                                                                      *
+//      SysManager::StartupProfileTrace
+//
+//  DESCRIPTION:
+/**
+    Write the startup phases of every port to its command trace.
+
+    \param[in] enable Set to write the marks.
+**/
+//  SYNOPSIS:
+void SysManager::StartupProfileTrace(bool enable) {
+    infcStartupProfileTrace(enable);
+}
+//                                                                            *
+//*****************************************************************************
+
+
 //*****************************************************************************
 //  NAME                                                                      *
 //      SysManager::Ports
@@ -718,6 +862,7 @@ bool SysManager::UserSettingsXmlLoaded() {
 **/
 SysManager::SysManager() {
     m_portOpenCount = 0;
+    m_memLockAtOpen = false;
     for (int iPort = 0; iPort < NET_CONTROLLER_MAX; iPort++) {
         SysInventory[iPort].pPortCls = new sFnd::SysCPMport(iPort);
         for (int iNode = 0; iNode < MN_API_MAX_NODES; iNode++) {
@@ -1495,6 +1640,82 @@ ValueBase::ValueBase(INode &node, nodeparam pNum, bool autoRefresh)
     m_scaleToUser = 1.0;
     m_refreshOnAccess = autoRefresh;
     m_isVolatile = false;
+    m_pCyclic = NULL;
+}
+
+ValueBase::ValueBase(const ValueBase &other)
+    : IObjWithNode(other),
+      m_scaleToUser(other.m_scaleToUser),
+      m_paramNum(other.m_paramNum),
+      m_valid(other.m_valid),
+      m_exists(other.m_exists),
+      m_isVolatile(other.m_isVolatile),
+      m_refreshOnAccess(other.m_refreshOnAccess),
+      m_pCyclic(NULL) {
+}
+
+ValueBase &ValueBase::operator=(const ValueBase &other) {
+    // Our subscription, if any, stays ours
+    IObjWithNode::operator=(other);
+    m_scaleToUser = other.m_scaleToUser;
+    m_paramNum = other.m_paramNum;
+    m_valid = other.m_valid;
+    m_exists = other.m_exists;
+    m_isVolatile = other.m_isVolatile;
+    m_refreshOnAccess = other.m_refreshOnAccess;
+    return *this;
+}
+
+ValueBase::~ValueBase() {
+    netCyclicUnsubscribe(m_pCyclic);
+}
+
+void ValueBase::CyclicRefresh(bool subscribe) {
+    cnErrCode theErr;
+
+    if (!subscribe) {
+        netCyclicUnsubscribe(m_pCyclic);
+        m_pCyclic = NULL;
+        return;
+    }
+    if (m_pCyclic) {
+        return;
+    }
+    theErr = IsParam() ? netCyclicSubscribe(Node().Info.Ex.Addr(), m_paramNum,
+                                            &m_pCyclic)
+                       : MN_ERR_BADARG;
+    if (theErr != MN_OK) {
+        mnErr eInfo;
+        fillInErrs(eInfo, &Node(), theErr, _TEK_FUNC_SIG_,
+                   "Parameter %d cannot be refreshed cyclically",
+                   int(m_paramNum));
+        throwSystemError(eInfo);
+    }
+}
+
+double ValueBase::CyclicAgeMs() {
+    double ageMs;
+    cnErrCode theErr;
+
+    if (!m_pCyclic) {
+        return -1;
+    }
+    // Stale values still report their age
+    theErr = netCyclicRead(m_pCyclic, NULL, &ageMs);
+    if (theErr != MN_OK && theErr != MN_ERR_TIMEOUT) {
+        return -1;
+    }
+    return ageMs;
+}
+
+bool ValueBase::CyclicLatest() {
+    paramValue val;
+
+    if (!m_pCyclic || netCyclicRead(m_pCyclic, &val, NULL) != MN_OK) {
+        return false;
+    }
+    RefreshFrom(val);
+    return true;
 }
 
 
@@ -1588,12 +1809,21 @@ ValueDouble::operator uint32_t() {
 
 
 void ValueDouble::Refresh() {
+    if (CyclicLatest()) {
+        return;
+    }
     double rdVal = Node().Info.Ex.Parameter(ParamNum());
     m_lastValue = m_currentValue;
     m_currentValue = rdVal * m_scaleToUser;
     m_valid = true;
 }
 
+void ValueDouble::RefreshFrom(const paramValue &val) {
+    m_lastValue = m_currentValue;
+    m_currentValue = val.value * m_scaleToUser;
+    m_valid = true;
+}
+
 
 
 //= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
@@ -1655,12 +1885,21 @@ ValueSigned::operator uint32_t() {
 
 
 void ValueSigned::Refresh() {
+    if (CyclicLatest()) {
+        return;
+    }
     int32_t rdVal = int32_t(Node().Info.Ex.Parameter(ParamNum()));
     m_lastValue = m_currentValue;
     m_currentValue = rdVal;
     m_valid = true;
 }
 
+void ValueSigned::RefreshFrom(const paramValue &val) {
+    m_lastValue = m_currentValue;
+    m_currentValue = int32_t(val.value);
+    m_valid = true;
+}
+
 
 //= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
 // ParamUnsigned Class Implementations
@@ -1714,12 +1953,21 @@ ValueUnsigned::operator uint32_t() {
 
 
 void ValueUnsigned::Refresh() {
+    if (CyclicLatest()) {
+        return;
+    }
     uint32_t rdVal = CAST_UINT32_T(Node().Info.Ex.Parameter(ParamNum()));
     m_lastValue = m_currentValue;
     m_currentValue = rdVal;
     m_valid = true;
 }
 
+void ValueUnsigned::RefreshFrom(const paramValue &val) {
+    m_lastValue = m_currentValue;
+    m_currentValue = CAST_UINT32_T(val.value);
+    m_valid = true;
+}
+
 
 //= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
 // ValueString Class Implementations
@@ -1819,6 +2067,9 @@ ValueOutReg::operator uint32_t() {
 void ValueOutReg::Refresh() {
     cnErrCode theErr;
     paramValue val;
+    if (CyclicLatest()) {
+        return;
+    }
     // Take the mutex
     INode::UseMutex myLock(Node());
     // Get current bits
@@ -1826,13 +2077,7 @@ void ValueOutReg::Refresh() {
                                  mnParams(ParamNum()), NULL, &val);
     m_valid = theErr == MN_OK;
     if (m_valid) {
-        m_lastValue = m_currentValue;
-        // Convert to integer equivalent
-        m_currentValue.bits = CAST_UINT16(val.value);
-        // If clear-on-read type, OR accumulate reading
-        if (m_clearOnRead) {
-            m_currentValue.bits |= m_lastValue.bits;
-        }
+        RefreshFrom(val);
         return;
     }
     mnErr eInfo;
@@ -1841,6 +2086,17 @@ void ValueOutReg::Refresh() {
     //throw eInfo;
     throwSystemError(eInfo);
 }
+
+void ValueOutReg::RefreshFrom(const paramValue &val) {
+    m_lastValue = m_currentValue;
+    // Convert to integer equivalent
+    m_currentValue.bits = CAST_UINT16(val.value);
+    // If clear-on-read type, OR accumulate reading
+    if (m_clearOnRead) {
+        m_currentValue.bits |= m_lastValue.bits;
+    }
+    m_valid = true;
+}
 /**
     Set bits in thread safe way.
 **/
@@ -1923,21 +2179,18 @@ mnPowerReg ValuePowerReg::Value() {
 **/
 void ValuePowerReg::Refresh() {
     cnErrCode theErr;
-    double val;
+    paramValue val;
+    if (CyclicLatest()) {
+        return;
+    }
     // Take the lock
     INode::UseMutex myLock(Node());
     // Get current bits
-    theErr = netGetParameterDbl(Node().Info.Ex.Addr(),
-                                mnParams(ParamNum()), &val);
+    theErr = netGetParameterInfo(Node().Info.Ex.Addr(),
+                                 mnParams(ParamNum()), NULL, &val);
     m_valid = theErr == MN_OK;
     if (m_valid) {
-        m_lastValue = m_currentValue;
-        // Convert to integer equivalent
-        m_currentValue.bits = CAST_UINT32(val);
-        // If clear-on-read type, OR accumulate reading
-        if (m_clearOnRead) {
-            m_currentValue.bits |= m_lastValue.bits;
-        }
+        RefreshFrom(val);
         return;
     }
     mnErr eInfo;
@@ -1946,6 +2199,17 @@ void ValuePowerReg::Refresh() {
     //throw eInfo;
     throwSystemError(eInfo);
 }
+
+void ValuePowerReg::RefreshFrom(const paramValue &val) {
+    m_lastValue = m_currentValue;
+    // Convert to integer equivalent
+    m_currentValue.bits = CAST_UINT32(val.value);
+    // If clear-on-read type, OR accumulate reading
+    if (m_clearOnRead) {
+        m_currentValue.bits |= m_lastValue.bits;
+    }
+    m_valid = true;
+}
 /**
     Clear accumulated status
 **/
@@ -2050,6 +2314,9 @@ any new bits.
 void ValueAppConfigReg::Refresh() {
     cnErrCode theErr;
     paramValue val;
+    if (CyclicLatest()) {
+        return;
+    }
     // Take the mutex
     INode::UseMutex myLock(Node());
     // Get current bits
@@ -2057,11 +2324,7 @@ void ValueAppConfigReg::Refresh() {
                                  mnParams(ParamNum()), NULL, &val);
     m_valid = theErr == MN_OK;
     if (m_valid) {
-        m_lastValue = m_currentValue;
-        // Convert to integer equivalent
-        m_currentValue.bits = CAST_UINT32(val.value);
-        // If clear-on-read type, OR accumulate reading
-        m_currentValue.bits |= m_lastValue.bits;
+        RefreshFrom(val);
         return;
     }
     mnErr eInfo;
@@ -2070,6 +2333,15 @@ void ValueAppConfigReg::Refresh() {
     //throw eInfo;
     throwSystemError(eInfo);
 }
+
+void ValueAppConfigReg::RefreshFrom(const paramValue &val) {
+    m_lastValue = m_currentValue;
+    // Convert to integer equivalent
+    m_currentValue.bits = CAST_UINT32(val.value);
+    // If clear-on-read type, OR accumulate reading
+    m_currentValue.bits |= m_lastValue.bits;
+    m_valid = true;
+}
 /**
 Set bits in thread safe way.
 **/
@@ -2170,6 +2442,9 @@ any new bits.
 void ValueHwConfigReg::Refresh() {
     cnErrCode theErr;
     paramValue val;
+    if (CyclicLatest()) {
+        return;
+    }
     // Take the mutex
     INode::UseMutex myLock(Node());
     // Get current bits
@@ -2177,11 +2452,7 @@ void ValueHwConfigReg::Refresh() {
                                  mnParams(ParamNum()), NULL, &val);
     m_valid = theErr == MN_OK;
     if (m_valid) {
-        m_lastValue = m_currentValue;
-        // Convert to integer equivalent
-        m_currentValue.bits = CAST_UINT32(val.value);
-        // If clear-on-read type, OR accumulate reading
-        m_currentValue.bits |= m_lastValue.bits;
+        RefreshFrom(val);
         return;
     }
     mnErr eInfo;
@@ -2190,6 +2461,15 @@ void ValueHwConfigReg::Refresh() {
     //throw eInfo;
     throwSystemError(eInfo);
 }
+
+void ValueHwConfigReg::RefreshFrom(const paramValue &val) {
+    m_lastValue = m_currentValue;
+    // Convert to integer equivalent
+    m_currentValue.bits = CAST_UINT32(val.value);
+    // If clear-on-read type, OR accumulate reading
+    m_currentValue.bits |= m_lastValue.bits;
+    m_valid = true;
+}
 /**
 Set bits in thread safe way.
 **/
@@ -2287,6 +2567,9 @@ mnStatusReg ValueStatus::Last() {
 void ValueStatus::Refresh() {
     cnErrCode theErr;
     paramValue val;
+    if (CyclicLatest()) {
+        return;
+    }
     // Take the mutex
     INode::UseMutex myLock(Node());
     // Get current bits
@@ -2294,15 +2577,7 @@ void ValueStatus::Refresh() {
                                  mnParams(ParamNum()), NULL, &val);
     m_valid = theErr == MN_OK;
     if (m_valid) {
-        m_lastValue = m_currentValue;
-        // Convert to integer equivalent
-        memcpy(&m_currentValue, val.raw.Byte.Buffer, sizeof(mnStatusReg));
-        // If clear-on-read type, OR accumulate reading
-        if (m_clearOnRead) {
-            for (size_t i = 0; i < mnStatusReg::N_BITS; i++) {
-                m_currentValue.bits[i] |= m_lastValue.bits[i];
-            }
-        }
+        RefreshFrom(val);
         return;
     }
     mnErr eInfo;
@@ -2312,6 +2587,19 @@ void ValueStatus::Refresh() {
     throwSystemError(eInfo);
 
 }
+
+void ValueStatus::RefreshFrom(const paramValue &val) {
+    m_lastValue = m_currentValue;
+    // Convert to integer equivalent
+    memcpy(&m_currentValue, val.raw.Byte.Buffer, sizeof(mnStatusReg));
+    // If clear-on-read type, OR accumulate reading
+    if (m_clearOnRead) {
+        for (size_t i = 0; i < mnStatusReg::N_BITS; i++) {
+            m_currentValue.bits[i] |= m_lastValue.bits[i];
+        }
+    }
+    m_valid = true;
+}
 /**
     Clear accumulated status
 **/
@@ -2413,6 +2701,9 @@ any new bits.
 void ValueAlert::Refresh() {
     cnErrCode theErr;
     paramValue val;
+    if (CyclicLatest()) {
+        return;
+    }
     // Take the lock
     INode::UseMutex myLock(Node());
     // Get current bits
@@ -2420,15 +2711,7 @@ void ValueAlert::Refresh() {
                                  mnParams(ParamNum()), NULL, &val);
     m_valid = theErr == MN_OK;
     if (m_valid) {
-        m_lastValue = m_currentValue;
-        // Convert to integer equivalent
-        memcpy(&m_currentValue, val.raw.Byte.Buffer, sizeof(alertReg));
-        // If clear-on-read type, OR accumulate reading
-        if (m_clearOnRead) {
-            for (size_t i = 0; i < alertReg::N_BITS; i++) {
-                m_currentValue.bits[i] |= m_lastValue.bits[i];
-            }
-        }
+        RefreshFrom(val);
         return;
     }
     mnErr eInfo;
@@ -2437,6 +2720,19 @@ void ValueAlert::Refresh() {
     //throw eInfo;
     throwSystemError(eInfo);
 }
+
+void ValueAlert::RefreshFrom(const paramValue &val) {
+    m_lastValue = m_currentValue;
+    // Convert to integer equivalent
+    memcpy(&m_currentValue, val.raw.Byte.Buffer, sizeof(alertReg));
+    // If clear-on-read type, OR accumulate reading
+    if (m_clearOnRead) {
+        for (size_t i = 0; i < alertReg::N_BITS; i++) {
+            m_currentValue.bits[i] |= m_lastValue.bits[i];
+        }
+    }
+    m_valid = true;
+}
 /**
 Clear accumulated status
 **/
@@ -2479,6 +2775,64 @@ INode::UseMutex::~UseMutex() {
 }
 
 
+//= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
+// INode Snapshot Implementation
+//= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
+double INode::Snapshot(ValueBase *const values[], size_t count) {
+    std::vector<nodeparam> params;
+    std::vector<ValueBase *> paramObjs, others;
+    std::vector<paramValue> vals;
+    cnErrCode theErr = MN_OK;
+    double startMs, sampleMs;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (!values[i] || &values[i]->Node() != this) {
+            mnErr eInfo;
+            fillInErrs(eInfo, this, MN_ERR_BADARG, _TEK_FUNC_SIG_,
+                       "Snapshot value %d is not of this node", int(i));
+            throwSystemError(eInfo);
+        }
+        if (values[i]->IsParam()) {
+            params.push_back(values[i]->ParamNum());
+            paramObjs.push_back(values[i]);
+        }
+        else {
+            others.push_back(values[i]);
+        }
+    }
+    vals.resize(params.size());
+    {
+        // Keep other threads' read-modify-writes out of the sample
+        UseMutex myLock(*this);
+        startMs = infcCoreTime();
+        if (!params.empty()) {
+            theErr = netGetParameterSet(Info.Ex.Addr(),
+                                        nodeulong(params.size()),
+                                        &params[0], &vals[0]);
+        }
+        // The node answers the reads in one pass, stamp the middle of it
+        sampleMs = (startMs + infcCoreTime()) / 2;
+        // All or nothing, the set converts only once every read is in
+        if (theErr == MN_OK) {
+            for (i = 0; i < paramObjs.size(); i++) {
+                paramObjs[i]->RefreshFrom(vals[i]);
+            }
+        }
+    }
+    if (theErr != MN_OK) {
+        mnErr eInfo;
+        fillInErrs(eInfo, this, theErr, _TEK_FUNC_SIG_,
+                   "Snapshot of %d values failed", int(count));
+        throwSystemError(eInfo);
+    }
+    for (i = 0; i < others.size(); i++) {
+        others[i]->Refresh();
+    }
+    return sampleMs;
+}
+
+
 //= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
 // MyEvent Class Implementations
 //= = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
@@ -0,0 +1,238 @@
+//******************************************************************************
+// $Workfile: codecTest.cpp $
+//
+// DESCRIPTION:
+/**
+    \file
+    \brief Channel codec check
+
+    Checks CSerialEx::convert8to7 and CSerialEx::convert7to8 against the
+    octet at a time codec they replaced. Every payload length up to
+    MN_API_PAYLOAD_MAX is run with every octet value at every position
+    and random fill elsewhere. The outputs must match the reference octet
+    for octet, and a payload sent through both must come back unchanged.
+**/
+// CREATION DATE:
+//  10/16/2026
+//
+// COPYRIGHT NOTICE:
+//  (C)Copyright 2026  Teknic, Inc.  All rights reserved.
+//
+//  This copyright notice must be reproduced in any copy, modification,
+//  or portion thereof merged into another program. A copy of the
+//  copyright notice must be included in the object library of a user
+//  program.
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  codecTest.cpp headers
+//
+#include "SerialEx.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Convert8to7Ref / Convert7to8Ref
+//
+//  DESCRIPTION:
+//      The octet at a time codec, as it was before the word codec.
+//
+static void Convert8to7Ref(packetbuf &inBuf, packetbuf &outBuf) {
+    // we copy the first 2 bytes without translation
+    outBuf.Byte.Buffer[0] = inBuf.Byte.Buffer[0];
+    outBuf.Byte.Buffer[1] = inBuf.Byte.Buffer[1];
+
+    nodechar *s = &inBuf.Byte.Buffer[2];
+    nodechar *d = &outBuf.Byte.Buffer[2];
+    nodechar *origD = d;
+    unsigned long chksum = 0;
+
+    // Allow caller to lie about length to create frag or stray data
+    int num8 = inBuf.Fld.PktLen;
+    int consumeBytes;
+    int outBytes;
+
+    while (num8 > 0) {
+        consumeBytes = num8 >= 7 ? 7 : num8;
+        outBytes = consumeBytes + 1;
+        switch (outBytes) {
+            case 8:
+                d[7] = 0x7f & ((unsigned char)s[6] >> 1);
+            // no break OK (special line for Code Analyzer to suppress warning)
+            case 7:
+                d[6] = 0x7f & ((s[6] << 6) | ((unsigned char)s[5] >> 2));
+            // no break OK (special line for Code Analyzer to suppress warning)
+            case 6:
+                d[5] = 0x7f & ((s[5] << 5) | ((unsigned char)s[4] >> 3));
+            // no break OK (special line for Code Analyzer to suppress warning)
+            case 5:
+                d[4] = 0x7f & ((s[4] << 4) | ((unsigned char)s[3] >> 4));
+            // no break OK (special line for Code Analyzer to suppress warning)
+            case 4:
+                d[3] = 0x7f & ((s[3] << 3) | ((unsigned char)s[2] >> 5));
+            // no break OK (special line for Code Analyzer to suppress warning)
+            case 3:
+                d[2] = 0x7f & ((s[2] << 2) | ((unsigned char)s[1] >> 6));
+            // no break OK (special line for Code Analyzer to suppress warning)
+            case 2:
+                d[1] = 0x7f & ((s[1] << 1) | ((unsigned char)s[0] >> 7));
+            // no break OK (special line for Code Analyzer to suppress warning)
+            case 1:
+                d[0] = 0x7f &   s[0];
+                // no break OK (special line for Code Analyzer to suppress warning)
+        }
+        d += outBytes;
+        s += consumeBytes;
+        num8 -= consumeBytes;
+    }
+    // Adjusts output header for expansion due to 8->7
+    outBuf.Fld.PktLen = (d - origD);
+    // Adjust packet buffer size for expansion due to 8->7 + checksum append
+    // 64-bit OK, buffer small always
+    outBuf.Byte.BufferSize = (nodeulong)(inBuf.Byte.BufferSize
+                                         + (d - origD) - inBuf.Fld.PktLen
+                                         + MN_API_PACKET_TAIL_LEN);
+    for (unsigned i = 0; i < (outBuf.Fld.PktLen + 2U); i++) {
+        chksum += outBuf.Byte.Buffer[i];
+    }
+    chksum = (-1 * chksum) & 0x7f;
+    outBuf.Byte.Buffer[outBuf.Fld.PktLen + 2] = (nodechar) chksum;
+}
+
+static void Convert7to8Ref(packetbuf &inBuf, packetbuf &outBuf) {
+    // we copy the header without translation
+    outBuf.Byte.Buffer[0] = inBuf.Byte.Buffer[0];
+    outBuf.Byte.Buffer[1] = inBuf.Byte.Buffer[1];
+
+
+    int num7 = inBuf.Fld.PktLen;
+
+    nodechar *buf7 = &inBuf.Byte.Buffer[RESP_LOC];
+    nodechar *d = &outBuf.Byte.Buffer[RESP_LOC];
+    nodechar *origD = d;
+
+    int i, mod8;
+    for (i = 0; i < num7; ++i) {
+        mod8 = 0x07 & i;
+        *d |= 0xff & (buf7[i] << (8 - mod8));
+        d += mod8 != 0;         // inc. d 7 out of 8 times
+        *d = buf7[i] >> mod8;
+    }
+
+    outBuf.Fld.PktLen = (num7 == 1) ? 1 : d - origD;
+    outBuf.Byte.BufferSize = outBuf.Fld.PktLen + MN_API_PACKET_HDR_LEN;
+
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Checks
+//
+static int nFails = 0;
+
+static void fail(const char *what, unsigned len, unsigned pos, unsigned val) {
+    if (nFails++ < 10) {
+        printf("FAIL: %s, length %u, octet %u = 0x%02x\n", what, len, pos, val);
+    }
+}
+
+static bool samePkt(const packetbuf &a, const packetbuf &b) {
+    return a.Byte.BufferSize == b.Byte.BufferSize
+           && !memcmp(a.Byte.Buffer, b.Byte.Buffer, a.Byte.BufferSize);
+}
+
+// Random application packet of <len> payload octets, <val> at <pos>
+static void fillApp(packetbuf &pkt, unsigned len, unsigned pos, unsigned val) {
+    for (size_t i = 0; i < sizeof(pkt.Byte.Buffer); i++) {
+        pkt.Byte.Buffer[i] = nodechar(rand());
+    }
+    pkt.Fld.StartOfPacket = 1;
+    pkt.Fld.PktLen = len;
+    if (pos < len) {
+        pkt.Byte.Buffer[RESP_LOC + pos] = nodechar(val);
+    }
+    pkt.Byte.BufferSize = len + MN_API_PACKET_HDR_LEN;
+}
+
+static void check8to7(CSerialEx &port, unsigned len, unsigned pos,
+                      unsigned val) {
+    packetbuf app, chan, ref, back;
+    fillApp(app, len, pos, val);
+    port.convert8to7(app, chan);
+    Convert8to7Ref(app, ref);
+    if (!samePkt(chan, ref)) {
+        fail("convert8to7 differs from reference", len, pos, val);
+    }
+    port.convert7to8(chan, back);
+    if (back.Fld.PktLen != len
+        || back.Byte.BufferSize != app.Byte.BufferSize
+        || memcmp(back.Byte.Buffer, app.Byte.Buffer, app.Byte.BufferSize)) {
+        fail("round trip changed the packet", len, pos, val);
+    }
+}
+
+static void check7to8(CSerialEx &port, unsigned len, unsigned pos,
+                      unsigned val) {
+    packetbuf chan, app, ref;
+    for (size_t i = 0; i < sizeof(chan.Byte.Buffer); i++) {
+        chan.Byte.Buffer[i] = nodechar(rand() & 0x7f);
+    }
+    chan.Fld.StartOfPacket = 1;
+    chan.Fld.PktLen = len;
+    if (pos < len) {
+        chan.Byte.Buffer[RESP_LOC + pos] = nodechar(val);
+    }
+    chan.Byte.BufferSize = len + MN_API_PACKET_HDR_LEN + MN_API_PACKET_TAIL_LEN;
+    port.convert7to8(chan, app);
+    // The reference merges into its output
+    memset(&ref, 0, sizeof(ref));
+    Convert7to8Ref(chan, ref);
+    if (!samePkt(app, ref)) {
+        fail("convert7to8 differs from reference", len, pos, val);
+    }
+}
+
+int main() {
+    CSerialEx port;
+    unsigned nCases = 0;
+    srand(1);
+    // Application payloads, every octet value at every position
+    for (unsigned len = 0; len <= MN_API_PAYLOAD_MAX; len++) {
+        for (unsigned pos = 0; pos < (len ? len : 1); pos++) {
+            for (unsigned val = 0; val < 256; val++, nCases++) {
+                check8to7(port, len, pos, val);
+            }
+        }
+    }
+    // Channel payloads, including lengths no encoder produces
+    for (unsigned len = 0; len <= MN_HDR_LEN_MASK; len++) {
+        for (unsigned pos = 0; pos < (len ? len : 1); pos++) {
+            for (unsigned val = 0; val < 128; val++, nCases++) {
+                check7to8(port, len, pos, val);
+            }
+        }
+    }
+    if (nFails) {
+        printf("%d of %u codec cases failed\n", nFails, nCases);
+        return 1;
+    }
+    printf("codec matches reference in %u cases\n", nCases);
+    return 0;
+}
+//                                                                             *
+//******************************************************************************
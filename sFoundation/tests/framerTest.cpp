@@ -0,0 +1,277 @@
+//******************************************************************************
+// $Workfile: framerTest.cpp $
+//
+// DESCRIPTION:
+/**
+    \file
+    \brief Receive framer check and benchmark
+
+    Feeds the same byte streams through the octet at a time framer,
+    CSerialEx::ProcessNextChar, and through the block framer,
+    CSerialEx::ProcessChunk, which sees them split into reads of random
+    size. The streams mix interleaved high priority packets, corruption,
+    truncation and stray octets. Both framers must deliver the same
+    packets and errors in the same order.
+
+    The benchmark then times both framers over a stream of clean status
+    sized responses, as the read thread sees them at high link rates.
+**/
+// CREATION DATE:
+//  10/16/2026
+//
+// COPYRIGHT NOTICE:
+//  (C)Copyright 2026  Teknic, Inc.  All rights reserved.
+//
+//  This copyright notice must be reproduced in any copy, modification,
+//  or portion thereof merged into another program. A copy of the
+//  copyright notice must be included in the object library of a user
+//  program.
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  framerTest.cpp headers
+//
+#include "SerialEx.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  framerTest.cpp constants
+//
+// Randomized streams compared and packets generated in each
+#define CHECK_STREAMS       2000
+#define CHECK_ITEMS         200
+// Benchmark stream size and passes over it
+#define BENCH_STREAM_LEN    (4 << 20)
+#define BENCH_PASSES        8
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      CSerialExTest class
+//
+//  DESCRIPTION:
+//      Reaches the private framer entry points of a port that was never
+//      opened. Framed packets are taken by a hook instead of the ring.
+//
+class CSerialExTest {
+public:
+    std::vector<packetbuf> m_pkts;          // Packets and errors framed
+    bool m_keep;                            // Record packets, else count
+    size_t m_nPkts;                         // Packets and errors framed
+
+    CSerialExTest(CSerialEx &port, bool keep)
+        : m_keep(keep), m_nPkts(0), m_port(port) {
+        m_port.RegisterUserPktCommEvent(&m_pktEvt);
+        m_port.RegisterPktHook(Hook, this);
+        m_port.AutoFlush(false);
+        m_port.PacketParseReset();
+    }
+
+    // The framer before block framing, one call per octet
+    void FeedChars(const char *pChars, size_t nChars) {
+        for (size_t i = 0; i < nChars; i++) {
+            m_port.ProcessNextChar(pChars[i]);
+        }
+    }
+
+    // The block framer, as the read thread calls it for each read
+    void FeedChunk(const char *pChars, size_t nChars) {
+        m_port.ProcessChunk(pChars, nChars);
+    }
+
+private:
+    CSerialEx &m_port;
+    CCEvent m_pktEvt;
+
+    static bool Hook(void *context, packetbuf &thePacket) {
+        CSerialExTest *pTest = (CSerialExTest *)context;
+        pTest->m_nPkts++;
+        if (pTest->m_keep) {
+            pTest->m_pkts.push_back(thePacket);
+        }
+        return true;
+    }
+};
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Stream generation
+//
+//  DESCRIPTION:
+//      Packets are built as application packets and put in channel format
+//      by the library's own encoder.
+//
+static unsigned rnd(unsigned limit) {
+    return unsigned(rand()) % limit;
+}
+
+static void makePacket(CSerialEx &port, bool hiPrio, unsigned payloadLen,
+                       std::string &chars) {
+    packetbuf appPkt, chanPkt;
+    memset(&appPkt, 0, sizeof(appPkt));
+    appPkt.Fld.SetupHdr(mnPktType(hiPrio ? 4 + rnd(4) : rnd(4)), rnd(16));
+    appPkt.Fld.PktLen = payloadLen;
+    for (unsigned i = 0; i < payloadLen; i++) {
+        appPkt.Byte.Buffer[RESP_LOC + i] = nodechar(rnd(256));
+    }
+    appPkt.Byte.BufferSize = payloadLen + MN_API_PACKET_HDR_LEN;
+    port.convert8to7(appPkt, chanPkt);
+    chars.append((const char *)chanPkt.Byte.Buffer, chanPkt.Byte.BufferSize);
+}
+
+// A stream of packets with the faults the framers must agree on
+static void makeFaultyStream(CSerialEx &port, std::string &stream) {
+    stream.clear();
+    for (int item = 0; item < CHECK_ITEMS; item++) {
+        std::string pkt;
+        unsigned kind = rnd(100);
+        makePacket(port, rnd(5) == 0, rnd(MN_API_PAYLOAD_MAX + 1), pkt);
+        if (kind < 15 && pkt.size() > 2) {
+            // High priority packet inside this one
+            std::string hiPkt;
+            makePacket(port, true, rnd(MN_API_PAYLOAD_MAX + 1), hiPkt);
+            pkt.insert(1 + rnd(unsigned(pkt.size()) - 1), hiPkt);
+        }
+        else if (kind < 25) {
+            // Stray octets ahead of it
+            for (unsigned n = 1 + rnd(8); n; n--) {
+                stream += char(rnd(0x80));
+            }
+        }
+        else if (kind < 30) {
+            // Truncated
+            pkt.resize(rnd(unsigned(pkt.size())));
+        }
+        else if (kind < 35 && pkt.size() > 2) {
+            // Corrupted payload or checksum
+            pkt[2 + rnd(unsigned(pkt.size()) - 2)] ^= char(1 + rnd(0x7f));
+        }
+        else if (kind < 38 && pkt.size() > 2) {
+            // A stray start of packet in the payload
+            pkt[2 + rnd(unsigned(pkt.size()) - 2)] |= char(0x80);
+        }
+        stream += pkt;
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Check and benchmark
+//
+static bool samePackets(const std::vector<packetbuf> &a,
+                        const std::vector<packetbuf> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].Byte.BufferSize != b[i].Byte.BufferSize
+            || memcmp(a[i].Byte.Buffer, b[i].Byte.Buffer,
+                      a[i].Byte.BufferSize)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int checkFramers() {
+    CSerialEx charPort, chunkPort;
+    std::string stream;
+    size_t nPkts = 0;
+    for (int s = 0; s < CHECK_STREAMS; s++) {
+        CSerialExTest byChar(charPort, true), byChunk(chunkPort, true);
+        makeFaultyStream(charPort, stream);
+        byChar.FeedChars(stream.data(), stream.size());
+        for (size_t at = 0; at < stream.size(); ) {
+            size_t n = 1 + rnd(64);
+            if (n > stream.size() - at) {
+                n = stream.size() - at;
+            }
+            byChunk.FeedChunk(stream.data() + at, n);
+            at += n;
+        }
+        if (!samePackets(byChar.m_pkts, byChunk.m_pkts)) {
+            printf("FAIL: stream %d, octet framer %d packets, "
+                   "block framer %d packets\n", s,
+                   int(byChar.m_pkts.size()), int(byChunk.m_pkts.size()));
+            return 1;
+        }
+        nPkts += byChar.m_pkts.size();
+    }
+    printf("framers agree on %d streams, %d packets and errors\n",
+           CHECK_STREAMS, int(nPkts));
+    return 0;
+}
+
+static double nowSec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void benchFramers() {
+    CSerialEx port;
+    std::string stream;
+    // Status responses are a few octets of payload
+    while (stream.size() < BENCH_STREAM_LEN) {
+        makePacket(port, false, 2 + rnd(11), stream);
+    }
+    for (int mode = 0; mode < 2; mode++) {
+        CSerialExTest bench(port, false);
+        double start = nowSec();
+        for (int pass = 0; pass < BENCH_PASSES; pass++) {
+            for (size_t at = 0; at < stream.size(); at += READ_BUF_LEN) {
+                size_t n = stream.size() - at;
+                n = (n < READ_BUF_LEN) ? n : READ_BUF_LEN;
+                if (mode) {
+                    bench.FeedChunk(stream.data() + at, n);
+                }
+                else {
+                    bench.FeedChars(stream.data() + at, n);
+                }
+            }
+        }
+        double secs = nowSec() - start;
+        double nChars = double(stream.size()) * BENCH_PASSES;
+        printf("%-14s %7.2f ns/octet %8.1f MB/s %9.0f packets/s\n",
+               mode ? "block framer" : "octet framer",
+               secs * 1e9 / nChars, nChars / secs / 1e6,
+               bench.m_nPkts / secs);
+    }
+}
+
+int main() {
+    srand(1);
+    if (checkFramers()) {
+        return 1;
+    }
+    benchFramers();
+    return 0;
+}
+//                                                                             *
+//******************************************************************************
@@ -0,0 +1,184 @@
+//******************************************************************************
+// $Workfile: quietTest.cpp $
+//
+// DESCRIPTION:
+/**
+    \file
+    \brief Quiet line and reply wait check
+
+    Opens a port on a pseudo terminal and times CSerialEx::WaitForQuiet and
+    CSerialEx::WaitForReply against characters written to the other end:
+    an idle line, a request that is never answered, a reply slower than
+    the quiet period and a line that never goes quiet. The waits must end
+    on the condition they wait for and never pass their bound.
+**/
+// CREATION DATE:
+//  10/16/2026
+//
+// COPYRIGHT NOTICE:
+//  (C)Copyright 2026  Teknic, Inc.  All rights reserved.
+//
+//  This copyright notice must be reproduced in any copy, modification,
+//  or portion thereof merged into another program. A copy of the
+//  copyright notice must be included in the object library of a user
+//  program.
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  quietTest.cpp headers
+//
+#include "SerialEx.h"
+
+#include <pthread.h>
+#include <pty.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  quietTest.cpp constants
+//
+// Bound of the reply waits, as infcFlushProc uses
+#define REPLY_MAX_MS        50
+// Delay of the late reply, past the quiet period
+#define LATE_REPLY_MS       35
+// Scheduling slack allowed on every time checked
+#define SLACK_MS            15
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Far end of the line
+//
+//  DESCRIPTION:
+//      Writes a burst to the terminal master after a delay, or a character
+//      every few milliseconds for a while.
+//
+struct farEnd {
+    int fd;                                 // Terminal master
+    unsigned delayMs;                       // Before the first write
+    unsigned writes;                        // Writes to make
+    unsigned everyMs;                       // Between writes
+};
+
+static void *farEndRun(void *context) {
+    farEnd &end = *(farEnd *)context;
+    static const char burst[] = "\x81\x02\x03\x7c";
+    usleep(end.delayMs * 1000);
+    for (unsigned i = 0; i < end.writes; i++) {
+        if (write(end.fd, burst, sizeof(burst) - 1) < 0) {
+            break;
+        }
+        usleep(end.everyMs * 1000);
+    }
+    return NULL;
+}
+
+static double nowMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Checks
+//
+#define CHECK(cond) \
+    if (!(cond)) { printf("FAIL line %d: %s\n", __LINE__, #cond); return 1; }
+
+static int checkWaits(CSerialEx &port, int master) {
+    pthread_t endThread;
+    farEnd end;
+    double start, tookMs;
+    bool quiet;
+    Uint32 seenFrom;
+
+    // An idle line is quiet after the quiet period
+    start = nowMs();
+    quiet = port.WaitForQuiet(SERIAL_QUIET_MS, 100);
+    tookMs = nowMs() - start;
+    CHECK(quiet && tookMs >= SERIAL_QUIET_MS
+          && tookMs < SERIAL_QUIET_MS + SLACK_MS);
+    printf("idle line quiet after %.1f ms\n", tookMs);
+
+    // An unanswered request waits out the bound
+    start = nowMs();
+    quiet = port.WaitForReply(port.CharsSeen(), SERIAL_QUIET_MS,
+                              REPLY_MAX_MS);
+    tookMs = nowMs() - start;
+    CHECK(!quiet && tookMs >= REPLY_MAX_MS
+          && tookMs < REPLY_MAX_MS + SLACK_MS);
+    printf("unanswered request gave up after %.1f ms\n", tookMs);
+
+    // A reply slower than the quiet period is waited for
+    seenFrom = port.CharsSeen();
+    end.fd = master;
+    end.delayMs = LATE_REPLY_MS;
+    end.writes = 1;
+    end.everyMs = 0;
+    start = nowMs();
+    pthread_create(&endThread, NULL, farEndRun, &end);
+    quiet = port.WaitForReply(seenFrom, SERIAL_QUIET_MS, 2 * REPLY_MAX_MS);
+    tookMs = nowMs() - start;
+    pthread_join(endThread, NULL);
+    CHECK(quiet && port.CharsSeen() != seenFrom
+          && tookMs >= LATE_REPLY_MS + SERIAL_QUIET_MS
+          && tookMs < LATE_REPLY_MS + SERIAL_QUIET_MS + SLACK_MS);
+    printf("reply at %d ms, quiet after %.1f ms\n", LATE_REPLY_MS, tookMs);
+
+    // A line that never goes quiet ends at the bound
+    end.delayMs = 0;
+    end.writes = 40;
+    end.everyMs = 5;
+    seenFrom = port.CharsSeen();
+    start = nowMs();
+    pthread_create(&endThread, NULL, farEndRun, &end);
+    quiet = port.WaitForReply(seenFrom, SERIAL_QUIET_MS, REPLY_MAX_MS);
+    tookMs = nowMs() - start;
+    pthread_join(endThread, NULL);
+    CHECK(!quiet && tookMs >= REPLY_MAX_MS
+          && tookMs < REPLY_MAX_MS + SLACK_MS);
+    printf("busy line gave up after %.1f ms\n", tookMs);
+    return 0;
+}
+
+int main() {
+    int master, slave;
+    char name[100];
+    if (openpty(&master, &slave, name, NULL, NULL) != 0) {
+        printf("FAIL: no pseudo terminal\n");
+        return 1;
+    }
+    CSerialEx *pPort = new CSerialEx();
+    if (pPort->OpenComPort(name) != CSerial::API_ERROR_SUCCESS) {
+        printf("FAIL: cannot open %s\n", name);
+        return 1;
+    }
+    int result = checkWaits(*pPort, master);
+    delete pPort;
+    close(slave);
+    close(master);
+    if (!result) {
+        printf("quiet line and reply waits passed\n");
+    }
+    return result;
+}
+//                                                                             *
+//******************************************************************************
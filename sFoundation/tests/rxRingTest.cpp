@@ -0,0 +1,244 @@
+//******************************************************************************
+// $Workfile: rxRingTest.cpp $
+//
+// DESCRIPTION:
+/**
+    \file
+    \brief Received packet ring check and benchmark
+
+    Checks rxPktRing in one thread across many wraps of its slot index:
+    order, the full and empty edges and discards at every offset, also of
+    a full ring whose consumer does not run. Then a producer and a
+    consumer thread run packets through it the way the serial reader and
+    the packet reader do, checking that every packet arrives once and in
+    order, and report the rate they reach.
+**/
+// CREATION DATE:
+//  10/16/2026
+//
+// COPYRIGHT NOTICE:
+//  (C)Copyright 2026  Teknic, Inc.  All rights reserved.
+//
+//  This copyright notice must be reproduced in any copy, modification,
+//  or portion thereof merged into another program. A copy of the
+//  copyright notice must be included in the object library of a user
+//  program.
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  rxRingTest.cpp headers
+//
+#include "SerialEx.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  rxRingTest.cpp constants
+//
+// Wraps of the slot index in the single thread checks
+#define CHECK_WRAPS         8
+// Packets sent through the ring by the threaded check
+#define THREAD_PKTS         (4 << 20)
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Packet stamping
+//
+//  DESCRIPTION:
+//      A packet carries its sequence number in its payload and length.
+//
+static void stamp(packetbuf &pkt, Uint32 seq) {
+    pkt.Byte.BufferSize = MN_API_PACKET_HDR_LEN + 4 + seq % 8;
+    memcpy(&pkt.Byte.Buffer[RESP_LOC], &seq, sizeof(seq));
+}
+
+static bool stamped(const packetbuf &pkt, Uint32 seq) {
+    Uint32 got;
+    memcpy(&got, &pkt.Byte.Buffer[RESP_LOC], sizeof(got));
+    return got == seq && pkt.Byte.BufferSize == MN_API_PACKET_HDR_LEN + 4 + seq % 8;
+}
+
+static bool push(rxPktRing &ring, Uint32 seq) {
+    packetbuf *pSlot = ring.claim();
+    if (!pSlot) {
+        return false;
+    }
+    stamp(*pSlot, seq);
+    ring.publish();
+    return true;
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Single thread checks
+//
+#define CHECK(cond) \
+    if (!(cond)) { printf("FAIL line %d: %s\n", __LINE__, #cond); return 1; }
+
+static int checkOrderAndEdges(rxPktRing &ring) {
+    Uint32 sent = 0, rcvd = 0;
+    packetbuf pkt;
+    // Fill and drain in steps that land on every offset of the slots
+    for (Uint32 step = 1; sent < CHECK_WRAPS * RX_PKT_RING_DEPTH; step += 7) {
+        Uint32 n = step % (RX_PKT_RING_DEPTH + 1);
+        for (Uint32 i = 0; i < n; i++) {
+            CHECK(push(ring, sent));
+            sent++;
+        }
+        CHECK(ring.depth() == n);
+        for (Uint32 i = 0; i < n; i++) {
+            CHECK(ring.pop(pkt));
+            CHECK(stamped(pkt, rcvd));
+            rcvd++;
+        }
+        CHECK(ring.empty());
+        CHECK(!ring.pop(pkt));
+    }
+    // Full is exactly the depth, wherever the indices are
+    for (Uint32 i = 0; i < RX_PKT_RING_DEPTH; i++) {
+        CHECK(push(ring, sent + i));
+    }
+    CHECK(ring.claim() == NULL);
+    CHECK(ring.pop(pkt) && stamped(pkt, sent));
+    CHECK(push(ring, sent + RX_PKT_RING_DEPTH));
+    CHECK(ring.claim() == NULL);
+    for (Uint32 i = 1; i <= RX_PKT_RING_DEPTH; i++) {
+        CHECK(ring.pop(pkt) && stamped(pkt, sent + i));
+    }
+    CHECK(ring.empty());
+    return 0;
+}
+
+static int checkDiscard(rxPktRing &ring) {
+    packetbuf pkt;
+    Uint32 seq = 0;
+    for (Uint32 n = 0; n <= RX_PKT_RING_DEPTH; n += 13) {
+        // Abandon <n> queued packets, some partly drained
+        for (Uint32 i = 0; i < n; i++) {
+            CHECK(push(ring, seq++));
+        }
+        if (n > 1) {
+            CHECK(ring.pop(pkt) && stamped(pkt, seq - n));
+        }
+        ring.discard();
+        CHECK(ring.empty());
+        CHECK(!ring.pop(pkt));
+        // Packets queued after the discard survive it
+        for (Uint32 i = 0; i < 5; i++) {
+            CHECK(push(ring, seq + i));
+        }
+        for (Uint32 i = 0; i < 5; i++) {
+            CHECK(ring.pop(pkt) && stamped(pkt, seq + i));
+        }
+        seq += 5;
+        CHECK(ring.empty());
+    }
+    return 0;
+}
+
+static int checkDiscardFull(rxPktRing &ring) {
+    packetbuf pkt;
+    Uint32 seq = 0;
+    // A flush of a full ring must make room without the consumer running
+    for (int pass = 0; pass < 3; pass++) {
+        for (Uint32 i = 0; i < RX_PKT_RING_DEPTH; i++) {
+            CHECK(push(ring, seq++));
+        }
+        CHECK(ring.claim() == NULL);
+        ring.discard();
+        CHECK(ring.empty());
+    }
+    for (Uint32 i = 0; i < RX_PKT_RING_DEPTH; i++) {
+        CHECK(push(ring, seq + i));
+    }
+    CHECK(ring.claim() == NULL);
+    for (Uint32 i = 0; i < RX_PKT_RING_DEPTH; i++) {
+        CHECK(ring.pop(pkt) && stamped(pkt, seq + i));
+    }
+    CHECK(ring.empty());
+    return 0;
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Threaded check and benchmark
+//
+static void *producer(void *context) {
+    rxPktRing &ring = *(rxPktRing *)context;
+    for (Uint32 seq = 0; seq < THREAD_PKTS; ) {
+        if (push(ring, seq)) {
+            seq++;
+        }
+        else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static double nowSec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int checkThreaded(rxPktRing &ring) {
+    pthread_t prodThread;
+    packetbuf pkt;
+    double start = nowSec();
+    pthread_create(&prodThread, NULL, producer, &ring);
+    for (Uint32 seq = 0; seq < THREAD_PKTS; ) {
+        if (!ring.pop(pkt)) {
+            sched_yield();
+            continue;
+        }
+        if (!stamped(pkt, seq)) {
+            printf("FAIL: packet %u out of order\n", seq);
+            pthread_join(prodThread, NULL);
+            return 1;
+        }
+        seq++;
+    }
+    pthread_join(prodThread, NULL);
+    double secs = nowSec() - start;
+    printf("%d packets across threads in order, %.1f M packets/s\n",
+           THREAD_PKTS, THREAD_PKTS / secs / 1e6);
+    return 0;
+}
+
+int main() {
+    static rxPktRing ring;
+    if (checkOrderAndEdges(ring) || checkDiscard(ring)
+        || checkDiscardFull(ring) || checkThreaded(ring)) {
+        return 1;
+    }
+    printf("ring order, full, empty and discard checks passed\n");
+    return 0;
+}
+//                                                                             *
+//******************************************************************************
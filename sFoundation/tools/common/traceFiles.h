@@ -0,0 +1,230 @@
+//*****************************************************************************
+// NAME
+//		traceFiles.h
+//
+// DESCRIPTION:
+//		Reading of command trace files written by infcTraceDump and
+//		infcTraceStreamStart for the offline trace tools.
+//
+// CREATION DATE:
+//		10/16/2026
+//
+// COPYRIGHT NOTICE:
+//		(C)Copyright 2026  Teknic, Inc.  All rights reserved.
+//
+//		This copyright notice must be reproduced in any copy, modification,
+//		or portion thereof merged into another program. A copy of the
+//		copyright notice must be included in the object library of a user
+//		program.
+//
+//																			  *
+//*****************************************************************************
+#ifndef __TRACEFILES_H__
+#define __TRACEFILES_H__
+
+
+//*****************************************************************************
+// NAME																          *
+// 	traceFiles.h headers
+//
+	#include "lnkAccessCommon.h"
+	#include <algorithm>
+	#include <string>
+	#include <vector>
+	#include <stdio.h>
+	#include <string.h>
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	traceFiles.h constants
+//
+// Records read from a file at a time
+#define TRACE_READ_CHUNK		1024
+// Node addresses in a packet
+#define TRACE_NODE_CNT			16
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	traceFile
+//
+// DESCRIPTION
+//	An input file and its header.
+//
+typedef struct _traceFile {
+	std::string path;
+	traceHeader hdr;
+} traceFile;
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	traceFileOpen
+//
+// DESCRIPTION
+//	Read and check the header of <path>. Returns false, after reporting to
+//	stderr, if it is not a V3 trace file.
+//
+inline bool traceFileOpen(const char *path, traceFile &file) {
+	FILE *fp = fopen(path, "rb");
+	Uint32 hdrLen;
+	bool ok = false;
+
+	if (!fp) {
+		fprintf(stderr, "%s: cannot open\n", path);
+		return false;
+	}
+	file.path = path;
+	file.hdr = traceHeader();
+	if (fread(&hdrLen, sizeof(hdrLen), 1, fp) == 1
+			&& hdrLen >= sizeof(file.hdr)) {
+		rewind(fp);
+		ok = fread(&file.hdr, sizeof(file.hdr), 1, fp) == 1
+			 && file.hdr.type >= DUMP_TYPE_NUM_V3_BASE
+			 && file.hdr.type < DUMP_TYPE_NUM_V3_BASE + DUMP_TYPE_RANGE_STEP;
+	}
+	if (!ok) {
+		fprintf(stderr, "%s: not a V3 trace file\n", path);
+	}
+	fclose(fp);
+	return ok;
+}
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	traceFilesSort
+//
+// DESCRIPTION
+//	Put files in the order they were created. Rotating stream files are
+//	only in order by their header time.
+//
+inline bool traceFileEarlier(const traceFile &a, const traceFile &b) {
+	if (a.hdr.timestamp.time != b.hdr.timestamp.time) {
+		return a.hdr.timestamp.time < b.hdr.timestamp.time;
+	}
+	return a.hdr.timestamp.millitm < b.hdr.timestamp.millitm;
+}
+
+inline void traceFilesSort(std::vector<traceFile> &files) {
+	std::stable_sort(files.begin(), files.end(), traceFileEarlier);
+}
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	traceFileRead
+//
+// DESCRIPTION
+//	Feed the commands of <file> to <addTx>, then its responses oldest first
+//	to <addRx>. A full dump ring starts after its nextRXrecord. Records are
+//	read in chunks so memory does not depend on the file size.
+//
+template<class recT, class addT>
+void traceRecordsRead(FILE *fp, off_t areaAt, Uint32 first, Uint32 count,
+					  addT &add) {
+	static recT chunk[TRACE_READ_CHUNK];
+
+	if (fseeko(fp, areaAt + off_t(first) * sizeof(recT), SEEK_SET) != 0) {
+		return;
+	}
+	while (count) {
+		size_t want = count < TRACE_READ_CHUNK ? count : TRACE_READ_CHUNK;
+		size_t got = fread(chunk, sizeof(recT), want, fp);
+		for (size_t i = 0; i < got; i++) {
+			add(chunk[i]);
+		}
+		if (got < want) {
+			return;
+		}
+		count -= Uint32(got);
+	}
+}
+
+template<class txT, class rxT>
+void traceFileRead(const traceFile &file, txT &addTx, rxT &addRx) {
+	const traceHeader &hdr = file.hdr;
+	FILE *fp = fopen(file.path.c_str(), "rb");
+	off_t rxAt, txAt, fileLen;
+	Uint32 nRX = hdr.nRXrecords, nTX = hdr.nTXrecords, start;
+
+	if (!fp) {
+		return;
+	}
+	fseeko(fp, 0, SEEK_END);
+	fileLen = ftello(fp);
+	rxAt = hdr.hdrLen;
+	txAt = rxAt + off_t(nRX) * off_t(sizeof(rxTraceBuf));
+	// A stream cut short may not hold all the records counted
+	if (txAt > fileLen) {
+		nRX = Uint32((fileLen - rxAt) / sizeof(rxTraceBuf));
+		nTX = 0;
+	}
+	else if (txAt + off_t(nTX) * off_t(sizeof(txTraceBuf)) > fileLen) {
+		nTX = Uint32((fileLen - txAt) / sizeof(txTraceBuf));
+	}
+	traceRecordsRead<txTraceBuf>(fp, txAt, 0, nTX, addTx);
+
+	start = 0;
+	if (nRX && nRX == hdr.traceLen) {
+		start = (hdr.nextRXrecord + 1) % nRX;
+	}
+	traceRecordsRead<rxTraceBuf>(fp, rxAt, start, nRX - start, addRx);
+	traceRecordsRead<rxTraceBuf>(fp, rxAt, 0, start, addRx);
+	fclose(fp);
+}
+//																			  *
+//*****************************************************************************
+
+
+//*****************************************************************************
+// NAME																          *
+// 	Record classification
+//
+// DESCRIPTION
+//	Never written slots of a dump, marker records and command keys.
+//
+inline bool traceTxEmpty(const txTraceBuf &rec) {
+	return rec.packet.Byte.BufferSize == 0 && rec.timeStamp == 0;
+}
+
+inline bool traceRxEmpty(const rxTraceBuf &rec) {
+	return rec.packet.Byte.BufferSize == 0 && rec.timeStamp == 0
+		   && rec.error == MN_OK;
+}
+
+inline bool traceRxMark(const rxTraceBuf &rec) {
+	return rec.sendSer == TRACE_MARK_SER;
+}
+
+// Key for a command packet: the command byte for command packets,
+// otherwise TRACE_CODE_TYPE_BASE plus the packet type.
+#define TRACE_CODE_TYPE_BASE	0x100
+inline unsigned traceCmdCode(const packetbuf &pkt) {
+	if (pkt.Byte.BufferSize <= CMD_LOC) {
+		return TRACE_CODE_TYPE_BASE + 8;
+	}
+	if (pkt.Fld.PktType == MN_PKT_TYPE_CMD) {
+		return pkt.Byte.Buffer[CMD_LOC];
+	}
+	return TRACE_CODE_TYPE_BASE + (unsigned(pkt.Fld.PktType) & 7);
+}
+//																			  *
+//*****************************************************************************
+
+#endif	// __TRACEFILES_H__
+
+//=============================================================================
+//	END OF FILE traceFiles.h
+//=============================================================================
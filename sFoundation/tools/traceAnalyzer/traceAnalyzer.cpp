@@ -0,0 +1,521 @@
+//******************************************************************************
+// $Workfile: traceAnalyzer.cpp $
+//
+// DESCRIPTION:
+/**
+    \file
+    \brief Offline command trace analyzer
+
+    Reads trace files written by infcTraceDump or infcTraceStreamStart,
+    pairs each response with its command through the response's send
+    serial number and reports:
+        - response latency percentiles by node and by command code
+        - response timeouts and error counts
+        - command ring depth, overall and optionally over time
+        - clusters of failed responses
+
+    Files are read once, in header time order. Memory is bounded by the
+    command pairing window and the statistics tables, not the trace size.
+**/
+// CREATION DATE:
+//  10/16/2026
+//
+// COPYRIGHT NOTICE:
+//  (C)Copyright 2026  Teknic, Inc.  All rights reserved.
+//
+//  This copyright notice must be reproduced in any copy, modification,
+//  or portion thereof merged into another program. A copy of the
+//  copyright notice must be included in the object library of a user
+//  program.
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  traceAnalyzer.cpp headers
+//
+#include "traceFiles.h"
+
+#include <map>
+#include <math.h>
+#include <stdlib.h>
+#include <unistd.h>
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  traceAnalyzer.cpp constants
+//
+// Commands remembered for pairing, power of 2. Responses further behind
+// their command than this in serial numbers are reported unpaired.
+#define TX_WINDOW           (1 << 18)
+// Histogram sub-buckets per power of two, ~3% resolution
+#define HIST_SUB_BITS       5
+#define HIST_SUB            (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS        (64 * HIST_SUB)
+// Deepest ring depth tracked individually
+#define DEPTH_MAX           256
+// Defaults for the options
+#define CLUSTER_GAP_DEF     100.0
+#define CLUSTER_SHOW_DEF    20
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      latencyHist class
+//
+//  DESCRIPTION:
+//      Log-linear histogram of microsecond values. Values below 2*HIST_SUB
+//      are exact, larger ones fall in one of HIST_SUB buckets per power of
+//      two.
+//
+class latencyHist {
+    Uint64 m_counts[HIST_BUCKETS];
+    Uint64 m_total;
+    double m_sumUs;
+    Uint64 m_maxUs;
+
+    static unsigned index(Uint64 us) {
+        if (us < 2 * HIST_SUB) {
+            return unsigned(us);
+        }
+        unsigned shift = 63 - __builtin_clzll(us) - HIST_SUB_BITS;
+        unsigned idx = shift * HIST_SUB + unsigned(us >> shift);
+        return idx < HIST_BUCKETS ? idx : HIST_BUCKETS - 1;
+    }
+
+    // Middle of bucket <idx>
+    static double value(unsigned idx) {
+        if (idx < 2 * HIST_SUB) {
+            return idx;
+        }
+        unsigned shift = idx / HIST_SUB - 1;
+        Uint64 low = Uint64(idx - shift * HIST_SUB) << shift;
+        return low + ((Uint64(1) << shift) - 1) / 2.0;
+    }
+
+public:
+    latencyHist() :
+        m_total(0), m_sumUs(0), m_maxUs(0) {
+        memset(m_counts, 0, sizeof(m_counts));
+    }
+
+    void Record(double ms) {
+        Uint64 us = ms > 0 ? Uint64(ms * 1000 + 0.5) : 0;
+        m_counts[index(us)]++;
+        m_total++;
+        m_sumUs += us;
+        if (us > m_maxUs) {
+            m_maxUs = us;
+        }
+    }
+
+    Uint64 Count() const {
+        return m_total;
+    }
+
+    double MeanMs() const {
+        return m_total ? m_sumUs / m_total / 1000 : 0;
+    }
+
+    double MaxMs() const {
+        return m_maxUs / 1000.0;
+    }
+
+    // Value in ms at or below which <pct> percent of samples fall
+    double PercentileMs(double pct) const {
+        if (!m_total) {
+            return 0;
+        }
+        Uint64 rank = Uint64(ceil(pct / 100 * m_total));
+        Uint64 seen = 0;
+        if (rank == 0) {
+            rank = 1;
+        }
+        for (unsigned idx = 0; idx < HIST_BUCKETS; idx++) {
+            seen += m_counts[idx];
+            if (seen >= rank) {
+                double us = value(idx);
+                return (us < m_maxUs ? us : m_maxUs) / 1000.0;
+            }
+        }
+        return MaxMs();
+    }
+};
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Analysis state
+//
+//  DESCRIPTION:
+//      Outcome tallies by node and by command code, the command pairing
+//      window, ring depth tallies and the error clusters.
+//
+// Outcomes for one node or command code
+typedef struct _keyStats {
+    latencyHist latency;                // Paired response times
+    Uint64 timeouts;                    // Responses never received
+    Uint64 errors;                      // Other failed responses
+    _keyStats() :
+        timeouts(0), errors(0) {
+    }
+} keyStats;
+
+// Command remembered for pairing
+typedef struct _txEntry {
+    Uint32 order;                       // Send serial number
+    bool valid;                         // Entry filled
+    double timeStamp;                   // Time sent
+    unsigned addr;                      // Node address
+    unsigned code;                      // Command code key
+} txEntry;
+
+// Ring depth over one time bin
+typedef struct _depthBin {
+    Uint32 maxDepth;
+    double sumDepth;
+    Uint64 nCmds;
+} depthBin;
+
+// Run of failed responses
+typedef struct _errCluster {
+    double start, last;                 // First and last failure time
+    Uint64 count;                       // Failures in the run
+    Uint32 nodeMask;                    // Nodes involved
+    Uint32 firstErr;                    // Error code of the first failure
+    Uint64 timeouts;                    // Failures that were timeouts
+} errCluster;
+
+static keyStats nodeStats[TRACE_NODE_CNT];
+static std::map<unsigned, keyStats> codeStats;
+static std::vector<txEntry> txWindow(TX_WINDOW);
+static Uint64 depthCounts[DEPTH_MAX + 1];
+static std::map<long, depthBin> depthSeries;
+static std::vector<errCluster> clusters;
+static errCluster curCluster;
+static bool inCluster = false;
+static Uint64 clusterCnt = 0;
+
+static Uint64 nTX = 0, nRX = 0, nPaired = 0, nUnpaired = 0;
+static Uint64 nUnsolicited = 0, nTimeouts = 0, nErrors = 0, nMarks = 0;
+
+// Options
+static double binMs = 0;                // Depth series bin, 0 for none
+static double gapMs = CLUSTER_GAP_DEF;  // Gap that ends an error cluster
+static unsigned clusterShow = CLUSTER_SHOW_DEF;
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      addTx / addRx
+//
+//  DESCRIPTION:
+//      Account for one command or response record.
+//
+//  SYNOPSIS:
+static void addTx(const txTraceBuf &rec) {
+    // Never written slots of a dump
+    if (traceTxEmpty(rec)) {
+        return;
+    }
+    nTX++;
+    txEntry &ent = txWindow[rec.order & (TX_WINDOW - 1)];
+    ent.order = rec.order;
+    ent.valid = true;
+    ent.timeStamp = rec.timeStamp;
+    ent.addr = rec.packet.Fld.Addr;
+    ent.code = traceCmdCode(rec.packet);
+
+    depthCounts[rec.depth < DEPTH_MAX ? rec.depth : DEPTH_MAX]++;
+    if (binMs > 0) {
+        depthBin &bin = depthSeries[long(floor(rec.timeStamp / binMs))];
+        if (rec.depth > bin.maxDepth) {
+            bin.maxDepth = rec.depth;
+        }
+        bin.sumDepth += rec.depth;
+        bin.nCmds++;
+    }
+}
+
+static void flushCluster() {
+    if (inCluster) {
+        clusterCnt++;
+        if (clusters.size() < clusterShow) {
+            clusters.push_back(curCluster);
+        }
+        inCluster = false;
+    }
+}
+
+static void addRx(const rxTraceBuf &rec) {
+    const txEntry *pTx = NULL;
+
+    if (traceRxEmpty(rec)) {
+        return;
+    }
+    // Net events and error callbacks
+    if (traceRxMark(rec)) {
+        nMarks++;
+        return;
+    }
+    nRX++;
+    if (rec.sendSer == Uint32(-1)) {
+        nUnsolicited++;
+    }
+    else {
+        const txEntry &ent = txWindow[rec.sendSer & (TX_WINDOW - 1)];
+        if (ent.valid && ent.order == rec.sendSer
+                && rec.timeStamp >= ent.timeStamp) {
+            pTx = &ent;
+        }
+    }
+    if (pTx) {
+        keyStats &node = nodeStats[pTx->addr];
+        keyStats &code = codeStats[pTx->code];
+        nPaired++;
+        if (rec.error == MN_ERR_RESP_TIMEOUT) {
+            node.timeouts++;
+            code.timeouts++;
+        }
+        else if (rec.error != MN_OK) {
+            node.errors++;
+            code.errors++;
+        }
+        else {
+            node.latency.Record(rec.timeStamp - pTx->timeStamp);
+            code.latency.Record(rec.timeStamp - pTx->timeStamp);
+        }
+    }
+    else if (rec.sendSer != Uint32(-1)) {
+        nUnpaired++;
+    }
+
+    if (rec.error == MN_OK) {
+        return;
+    }
+    // Group failures close in time
+    if (rec.error == MN_ERR_RESP_TIMEOUT) {
+        nTimeouts++;
+    }
+    else {
+        nErrors++;
+    }
+    if (inCluster && rec.timeStamp - curCluster.last > gapMs) {
+        flushCluster();
+    }
+    if (!inCluster) {
+        memset(&curCluster, 0, sizeof(curCluster));
+        curCluster.start = rec.timeStamp;
+        curCluster.firstErr = rec.error;
+        inCluster = true;
+    }
+    curCluster.last = rec.timeStamp;
+    curCluster.count++;
+    curCluster.nodeMask |= 1U << (pTx ? pTx->addr : rec.packet.Fld.Addr);
+    if (rec.error == MN_ERR_RESP_TIMEOUT) {
+        curCluster.timeouts++;
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Report
+//
+//  DESCRIPTION:
+//      Print the results.
+//
+//  SYNOPSIS:
+static void printLatencyHdr(const char *key) {
+    printf("%-8s %10s %9s %9s %9s %9s %9s %9s %8s %8s\n", key, "count",
+           "mean", "p50", "p90", "p99", "p99.9", "max", "timeout", "error");
+}
+
+static void printLatency(const char *key, const keyStats &stats) {
+    const latencyHist &lat = stats.latency;
+    printf("%-8s %10llu %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f %8llu %8llu\n",
+           key, (unsigned long long)lat.Count(), lat.MeanMs(),
+           lat.PercentileMs(50), lat.PercentileMs(90),
+           lat.PercentileMs(99), lat.PercentileMs(99.9), lat.MaxMs(),
+           (unsigned long long)stats.timeouts,
+           (unsigned long long)stats.errors);
+}
+
+static void report(size_t nFiles) {
+    char key[16];
+    unsigned i;
+    Uint64 nDepth = 0, sumDepth = 0, rank, seen;
+    unsigned maxDepth = 0, p99Depth = 0;
+
+    printf("Files %zu, commands %llu, responses %llu, events %llu\n",
+           nFiles, (unsigned long long)nTX, (unsigned long long)nRX,
+           (unsigned long long)nMarks);
+    printf("Paired %llu, unpaired %llu, unsolicited %llu, "
+           "timeouts %llu, errors %llu\n",
+           (unsigned long long)nPaired, (unsigned long long)nUnpaired,
+           (unsigned long long)nUnsolicited, (unsigned long long)nTimeouts,
+           (unsigned long long)nErrors);
+
+    printf("\nResponse latency by node (ms)\n");
+    printLatencyHdr("node");
+    for (i = 0; i < TRACE_NODE_CNT; i++) {
+        const keyStats &stats = nodeStats[i];
+        if (stats.latency.Count() || stats.timeouts || stats.errors) {
+            snprintf(key, sizeof(key), "%u", i);
+            printLatency(key, stats);
+        }
+    }
+
+    printf("\nResponse latency by command (ms)\n");
+    printLatencyHdr("command");
+    for (std::map<unsigned, keyStats>::const_iterator it = codeStats.begin();
+            it != codeStats.end(); ++it) {
+        if (it->first >= TRACE_CODE_TYPE_BASE) {
+            snprintf(key, sizeof(key), "type %u", it->first - TRACE_CODE_TYPE_BASE);
+        }
+        else {
+            snprintf(key, sizeof(key), "0x%02x", it->first);
+        }
+        printLatency(key, it->second);
+    }
+
+    for (i = 0; i <= DEPTH_MAX; i++) {
+        nDepth += depthCounts[i];
+        sumDepth += Uint64(depthCounts[i]) * i;
+        if (depthCounts[i]) {
+            maxDepth = i;
+        }
+    }
+    rank = Uint64(ceil(0.99 * nDepth));
+    for (i = 0, seen = 0; i <= DEPTH_MAX && nDepth; i++) {
+        seen += depthCounts[i];
+        if (seen >= rank) {
+            p99Depth = i;
+            break;
+        }
+    }
+    printf("\nRing depth at send: mean %.2f, p99 %u, max %u%s\n",
+           nDepth ? double(sumDepth) / nDepth : 0.0, p99Depth, maxDepth,
+           maxDepth == DEPTH_MAX ? "+" : "");
+    if (binMs > 0) {
+        printf("%12s %8s %8s %10s\n", "time(ms)", "max", "mean", "commands");
+        for (std::map<long, depthBin>::const_iterator it = depthSeries.begin();
+                it != depthSeries.end(); ++it) {
+            printf("%12.0f %8u %8.2f %10llu\n", it->first * binMs,
+                   it->second.maxDepth,
+                   it->second.sumDepth / it->second.nCmds,
+                   (unsigned long long)it->second.nCmds);
+        }
+    }
+
+    flushCluster();
+    printf("\nError clusters (gap %.0f ms): %llu", gapMs,
+           (unsigned long long)clusterCnt);
+    if (clusterCnt > clusters.size()) {
+        printf(", first %zu shown", clusters.size());
+    }
+    printf("\n");
+    if (!clusters.empty()) {
+        printf("%12s %10s %8s %8s %10s %s\n", "start(ms)", "dur(ms)",
+               "count", "timeout", "first err", "nodes");
+    }
+    for (i = 0; i < clusters.size(); i++) {
+        const errCluster &c = clusters[i];
+        printf("%12.1f %10.1f %8llu %8llu 0x%08x ", c.start, c.last - c.start,
+               (unsigned long long)c.count, (unsigned long long)c.timeouts,
+               c.firstErr);
+        for (unsigned node = 0; node < TRACE_NODE_CNT; node++) {
+            if (c.nodeMask & (1U << node)) {
+                printf(" %u", node);
+            }
+        }
+        printf("\n");
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      main
+//
+//  DESCRIPTION:
+//      traceAnalyzer [-b binMs] [-g gapMs] [-c clusters] file...
+//
+//  SYNOPSIS:
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-b binMs] [-g gapMs] [-c clusters] file...\n"
+            "  -b binMs     print ring depth per binMs of trace time\n"
+            "  -g gapMs     quiet time ending an error cluster (%.0f)\n"
+            "  -c clusters  error clusters to list (%d)\n",
+            prog, CLUSTER_GAP_DEF, CLUSTER_SHOW_DEF);
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<traceFile> files;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:g:c:h")) != -1) {
+        switch (opt) {
+        case 'b':
+            binMs = atof(optarg);
+            break;
+        case 'g':
+            gapMs = atof(optarg);
+            break;
+        case 'c':
+            clusterShow = unsigned(atoi(optarg));
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 2;
+    }
+    for (int i = optind; i < argc; i++) {
+        traceFile file;
+        if (traceFileOpen(argv[i], file)) {
+            files.push_back(file);
+        }
+    }
+    if (files.empty()) {
+        return 1;
+    }
+    traceFilesSort(files);
+    for (size_t i = 0; i < files.size(); i++) {
+        traceFileRead(files[i], addTx, addRx);
+    }
+    report(files.size());
+    return 0;
+}
+//                                                                             *
+//******************************************************************************
+
+
+//==============================================================================
+//  END OF FILE traceAnalyzer.cpp
+//==============================================================================
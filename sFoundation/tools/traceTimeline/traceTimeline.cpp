@@ -0,0 +1,425 @@
+//******************************************************************************
+// $Workfile: traceTimeline.cpp $
+//
+// DESCRIPTION:
+/**
+    \file
+    \brief Command trace timeline exporter
+
+    Converts trace files written by infcTraceDump or infcTraceStreamStart
+    into the Chrome trace event JSON format, loaded by chrome://tracing and
+    the Perfetto UI. The port is one process with a track per node:
+        - each command is a span from its send to its response
+        - timeouts are spans ending at the time the timeout was declared
+        - attentions and failed responses are instants on the node track
+        - net state changes and error callbacks are instants on the
+          port events track
+        - startup phases are spans on the startup track
+
+    Commands overlapping on a node are spread over extra lanes of the
+    node so no span hides another.
+**/
+// CREATION DATE:
+//  10/16/2026
+//
+// COPYRIGHT NOTICE:
+//  (C)Copyright 2026  Teknic, Inc.  All rights reserved.
+//
+//  This copyright notice must be reproduced in any copy, modification,
+//  or portion thereof merged into another program. A copy of the
+//  copyright notice must be included in the object library of a user
+//  program.
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  traceTimeline.cpp headers
+//
+#include "traceFiles.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+// NAME                                                                        *
+//  traceTimeline.cpp constants
+//
+// Commands remembered for pairing, power of 2
+#define TX_WINDOW           (1 << 18)
+// Lanes per node track, further overlaps share the lane freed first
+#define LANE_MAX            8
+// Trace event ids: the port process, node tracks are node * LANE_MAX + lane
+#define PORT_PID            1
+#define PORT_EVENTS_TID     (TRACE_NODE_CNT * LANE_MAX)
+#define PORT_STARTUP_TID    (PORT_EVENTS_TID + 1)
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Export state
+//
+//  DESCRIPTION:
+//      The command pairing window, the lanes in use and the output.
+//
+// Command remembered for pairing
+typedef struct _txEntry {
+    Uint32 order;                       // Send serial number
+    bool valid;                         // Entry filled
+    double timeStamp;                   // Time sent
+    unsigned addr;                      // Node address
+    unsigned code;                      // Command code key
+    Uint32 depth;                       // Ring depth at send
+} txEntry;
+
+// Lanes of one node track
+typedef struct _nodeLanes {
+    double laneEnd[LANE_MAX];           // End of the last span in each lane
+    unsigned nLanes;                    // Lanes named so far
+} nodeLanes;
+
+static std::vector<txEntry> txWindow(TX_WINDOW);
+static nodeLanes lanes[TRACE_NODE_CNT];
+static FILE *out = stdout;
+static bool firstEvent = true;
+static Uint64 nSpans = 0, nInstants = 0;
+
+// Options
+static double startMs = -1;             // Window start, < 0 for none
+static double endMs = -1;               // Window end, < 0 for none
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      Event output
+//
+//  DESCRIPTION:
+//      Write one trace event. Times are in trace ms and written in us.
+//
+//  SYNOPSIS:
+static void eventStart() {
+    fputs(firstEvent ? "\n" : ",\n", out);
+    firstEvent = false;
+}
+
+static void trackName(unsigned tid, const char *name) {
+    eventStart();
+    fprintf(out, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,"
+            "\"tid\":%u,\"args\":{\"name\":\"%s\"}}", PORT_PID, tid, name);
+    eventStart();
+    fprintf(out, "{\"ph\":\"M\",\"name\":\"thread_sort_index\",\"pid\":%d,"
+            "\"tid\":%u,\"args\":{\"sort_index\":%u}}", PORT_PID, tid, tid);
+}
+
+static bool inWindow(double fromMs, double toMs) {
+    return (startMs < 0 || toMs >= startMs) && (endMs < 0 || fromMs <= endMs);
+}
+
+static void codeName(unsigned code, char *name, size_t nameLen) {
+    if (code >= TRACE_CODE_TYPE_BASE) {
+        snprintf(name, nameLen, "type %u", code - TRACE_CODE_TYPE_BASE);
+    }
+    else {
+        snprintf(name, nameLen, "cmd 0x%02x", code);
+    }
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      laneFor
+//
+//  DESCRIPTION:
+//      Pick the lane of <node> for a span starting at <fromMs>: the first
+//      lane free by then, else a new lane, else the lane freed first.
+//
+//  SYNOPSIS:
+static unsigned laneFor(unsigned node, double fromMs, double toMs) {
+    nodeLanes &nl = lanes[node];
+    unsigned lane, best = 0;
+    char name[32];
+
+    for (lane = 0; lane < nl.nLanes; lane++) {
+        if (nl.laneEnd[lane] <= fromMs) {
+            break;
+        }
+        if (nl.laneEnd[lane] < nl.laneEnd[best]) {
+            best = lane;
+        }
+    }
+    if (lane == nl.nLanes) {
+        if (nl.nLanes < LANE_MAX) {
+            if (lane == 0) {
+                snprintf(name, sizeof(name), "node %u", node);
+            }
+            else {
+                snprintf(name, sizeof(name), "node %u (%u)", node, lane);
+            }
+            trackName(node * LANE_MAX + lane, name);
+            nl.nLanes++;
+        }
+        else {
+            lane = best;
+        }
+    }
+    if (toMs > nl.laneEnd[lane]) {
+        nl.laneEnd[lane] = toMs;
+    }
+    return lane;
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      addTx / addRx
+//
+//  DESCRIPTION:
+//      Remember a command, or emit the events for a response or marker.
+//      Responses come oldest first, so spans are emitted as they complete.
+//
+//  SYNOPSIS:
+static void addTx(const txTraceBuf &rec) {
+    if (traceTxEmpty(rec)) {
+        return;
+    }
+    txEntry &ent = txWindow[rec.order & (TX_WINDOW - 1)];
+    ent.order = rec.order;
+    ent.valid = true;
+    ent.timeStamp = rec.timeStamp;
+    ent.addr = rec.packet.Fld.Addr;
+    ent.code = traceCmdCode(rec.packet);
+    ent.depth = rec.depth;
+}
+
+// Names of the startupPhases
+static const char *startupNames[STARTUP_PHASE_CNT] = {
+    "start port", "reset", "reset rate", "settle", "set address",
+    "set rate", "ring diagnostics", "enumerate", "identify", "class setup",
+    "preload"
+};
+
+// A startup phase mark is written as the phase ends
+static void addStartupMark(const rxTraceBuf &rec) {
+    traceStartupMark mark;
+    char name[40];
+
+    if (rec.packet.Byte.BufferSize < sizeof(mark)) {
+        return;
+    }
+    memcpy(&mark, rec.packet.Byte.Buffer, sizeof(mark));
+    double durMs = mark.durationUs / 1000.0;
+    if (!inWindow(rec.timeStamp - durMs, rec.timeStamp)) {
+        return;
+    }
+    if (mark.phase < STARTUP_PHASE_CNT) {
+        snprintf(name, sizeof(name), "%s", startupNames[mark.phase]);
+    }
+    else {
+        snprintf(name, sizeof(name), "phase %u", unsigned(mark.phase));
+    }
+    if (mark.node != TRACE_MARK_PORT) {
+        size_t len = strlen(name);
+        snprintf(name + len, sizeof(name) - len, " node %u",
+                 unsigned(mark.node));
+    }
+    eventStart();
+    nSpans++;
+    fprintf(out, "{\"ph\":\"X\",\"name\":\"%s\",\"cat\":\"startup\","
+            "\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+            "\"args\":{\"commands\":%u}}",
+            name, PORT_PID, PORT_STARTUP_TID, (rec.timeStamp - durMs) * 1000,
+            durMs * 1000, unsigned(mark.commands));
+}
+
+static void addMark(const rxTraceBuf &rec) {
+    const char *name;
+
+    if (rec.sendCnt == TRACE_MARK_STARTUP) {
+        addStartupMark(rec);
+        return;
+    }
+    if (!inWindow(rec.timeStamp, rec.timeStamp)) {
+        return;
+    }
+    eventStart();
+    nInstants++;
+    if (rec.sendCnt == TRACE_MARK_NET_EVENT) {
+        name = "net event";
+        fprintf(out, "{\"ph\":\"i\",\"s\":\"p\",\"name\":\"%s\",\"pid\":%d,"
+                "\"tid\":%d,\"ts\":%.3f,\"args\":{\"state\":%d}}",
+                name, PORT_PID, PORT_EVENTS_TID, rec.timeStamp * 1000,
+                int(rec.packet.Byte.Buffer[0]));
+    }
+    else {
+        name = rec.sendCnt == TRACE_MARK_ERR_CALLBACK
+               ? "error callback" : "mark";
+        fprintf(out, "{\"ph\":\"i\",\"s\":\"p\",\"name\":\"%s\",\"pid\":%d,"
+                "\"tid\":%d,\"ts\":%.3f,\"args\":{\"node\":%u,"
+                "\"error\":\"0x%08x\"}}",
+                name, PORT_PID, PORT_EVENTS_TID, rec.timeStamp * 1000,
+                unsigned(Uint8(rec.packet.Byte.Buffer[0])),
+                unsigned(rec.error));
+    }
+}
+
+static void addRx(const rxTraceBuf &rec) {
+    const txEntry *pTx = NULL;
+    unsigned node, lane;
+    char name[32];
+
+    if (traceRxEmpty(rec)) {
+        return;
+    }
+    if (traceRxMark(rec)) {
+        addMark(rec);
+        return;
+    }
+    if (rec.sendSer != Uint32(-1)) {
+        const txEntry &ent = txWindow[rec.sendSer & (TX_WINDOW - 1)];
+        if (ent.valid && ent.order == rec.sendSer
+                && rec.timeStamp >= ent.timeStamp) {
+            pTx = &ent;
+        }
+    }
+
+    // Unsolicited packets and responses without their command
+    if (!pTx) {
+        if (!inWindow(rec.timeStamp, rec.timeStamp)) {
+            return;
+        }
+        node = rec.packet.Fld.Addr;
+        lane = laneFor(node, rec.timeStamp, rec.timeStamp);
+        eventStart();
+        nInstants++;
+        fprintf(out, "{\"ph\":\"i\",\"s\":\"t\",\"name\":\"%s\",\"pid\":%d,"
+                "\"tid\":%u,\"ts\":%.3f,\"args\":{\"order\":%u,"
+                "\"error\":\"0x%08x\"}}",
+                rec.sendSer == Uint32(-1) ? "attention"
+                : rec.error != MN_OK ? "error" : "unpaired",
+                PORT_PID, node * LANE_MAX + lane, rec.timeStamp * 1000,
+                rec.order, unsigned(rec.error));
+        return;
+    }
+
+    if (!inWindow(pTx->timeStamp, rec.timeStamp)) {
+        return;
+    }
+    node = pTx->addr;
+    lane = laneFor(node, pTx->timeStamp, rec.timeStamp);
+    codeName(pTx->code, name, sizeof(name));
+    eventStart();
+    nSpans++;
+    fprintf(out, "{\"ph\":\"X\",\"name\":\"%s%s\",\"cat\":\"%s\",\"pid\":%d,"
+            "\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"order\":%u,"
+            "\"depth\":%u,\"error\":\"0x%08x\"}}",
+            name, rec.error == MN_ERR_RESP_TIMEOUT ? " TIMEOUT" : "",
+            rec.error == MN_OK ? "cmd" : "failed", PORT_PID,
+            node * LANE_MAX + lane, pTx->timeStamp * 1000,
+            (rec.timeStamp - pTx->timeStamp) * 1000, rec.sendSer,
+            pTx->depth, unsigned(rec.error));
+}
+//                                                                             *
+//******************************************************************************
+
+
+
+//******************************************************************************
+//  NAME                                                                       *
+//      main
+//
+//  DESCRIPTION:
+//      traceTimeline [-o out.json] [-s startMs] [-e endMs] file...
+//
+//  SYNOPSIS:
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-o out.json] [-s startMs] [-e endMs] file...\n"
+            "  -o out.json  output file (stdout)\n"
+            "  -s startMs   drop events ending before startMs of trace time\n"
+            "  -e endMs     drop events starting after endMs of trace time\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<traceFile> files;
+    const char *outPath = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:s:e:h")) != -1) {
+        switch (opt) {
+        case 'o':
+            outPath = optarg;
+            break;
+        case 's':
+            startMs = atof(optarg);
+            break;
+        case 'e':
+            endMs = atof(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 2;
+    }
+    for (int i = optind; i < argc; i++) {
+        traceFile file;
+        if (traceFileOpen(argv[i], file)) {
+            files.push_back(file);
+        }
+    }
+    if (files.empty()) {
+        return 1;
+    }
+    if (outPath && !(out = fopen(outPath, "w"))) {
+        fprintf(stderr, "%s: cannot create\n", outPath);
+        return 1;
+    }
+    traceFilesSort(files);
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", out);
+    eventStart();
+    fprintf(out, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,"
+            "\"args\":{\"name\":\"port\"}}", PORT_PID);
+    trackName(PORT_EVENTS_TID, "port events");
+    trackName(PORT_STARTUP_TID, "startup");
+    for (size_t i = 0; i < files.size(); i++) {
+        traceFileRead(files[i], addTx, addRx);
+    }
+    fputs("\n]}\n", out);
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    fprintf(stderr, "%llu spans, %llu instants\n",
+            (unsigned long long)nSpans, (unsigned long long)nInstants);
+    return 0;
+}
+//                                                                             *
+//******************************************************************************
+
+
+//==============================================================================
+//  END OF FILE traceTimeline.cpp
+//==============================================================================